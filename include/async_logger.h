@@ -0,0 +1,185 @@
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+
+enum class LogLevel : uint8_t { Error, Warning, Info, Debug };
+
+// Subsistema de cada archivo (#define LOG_MODULE antes de los includes; por defecto General)
+enum class LogModule : uint8_t { General, Server, PAC, Poll, Write, Count };
+
+// Estado de límite de repeticiones de un punto de log (uno por expansión de LOG_ERROR/LOG_WARNING)
+struct LogSite {
+    std::atomic<int64_t> window_start_ns{0};
+    std::atomic<uint32_t> in_window{0};
+    std::atomic<uint32_t> suppressed{0};
+};
+
+/**
+ * Logger asíncrono: los hilos de sondeo, E/S y servidor nunca formatean ni escriben en stdout
+ * - Cada hilo tiene su anillo SPSC de bytes; el mensaje se codifica en binario (tipo + valor de
+ *   cada argumento de <<) y se copia al anillo sin locks ni reservas de memoria
+ * - Un hilo sumidero drena los anillos, ordena por instante, formatea y escribe por bloques
+ *   (un fflush por pasada, no por línea)
+ * - Nivel por subsistema ajustable en ejecución (un load relajado antes de evaluar los argumentos)
+ * - Errores y advertencias repetidos en el mismo punto se limitan a una ráfaga por ventana;
+ *   el siguiente mensaje que pasa informa cuántos se suprimieron
+ * - Anillo lleno: el mensaje se descarta y se cuenta (dropped()); el hilo nunca espera
+ */
+class AsyncLogger {
+public:
+    static AsyncLogger &instance();
+
+    static bool enabled(LogModule module, LogLevel level)
+    {
+        return static_cast<uint8_t>(level) <= levels[static_cast<size_t>(module)].load(std::memory_order_relaxed);
+    }
+
+    static void setLevel(LogModule module, LogLevel level);
+    static void setLevel(LogLevel level);   // Todos los subsistemas
+    static LogLevel level(LogModule module);
+
+    // "info,pac=debug,poll=warning": nivel general y luego por subsistema; false si algo no se reconoce
+    static bool applyLevelSpec(std::string_view spec);
+    static std::string levelSpec();
+
+    // Ráfaga permitida por punto de log y ventana (burst = 0 desactiva el límite)
+    static void setRateLimit(uint32_t burst, std::chrono::milliseconds window);
+    static bool admit(LogSite &site, uint32_t &suppressed);
+
+    static const char *moduleName(LogModule module);
+    static const char *levelName(LogLevel level);
+
+    // Espera a que el sumidero haya escrito lo publicado hasta ahora (cierre, pruebas)
+    void flush();
+
+    uint64_t dropped() const { return dropped_records.load(std::memory_order_relaxed); }
+
+    ~AsyncLogger();
+
+    struct Ring;
+    struct ThreadLog;
+
+private:
+    AsyncLogger();
+    AsyncLogger(const AsyncLogger &) = delete;
+    AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+    friend class LogLine;
+    std::shared_ptr<Ring> registerThread();
+    void publish(ThreadLog &log, const uint8_t *record, size_t size, LogLevel level);
+    void sinkLoop();
+    bool drainOnce();
+
+    static std::atomic<uint8_t> levels[static_cast<size_t>(LogModule::Count)];
+    static std::atomic<uint32_t> rate_burst;
+    static std::atomic<int64_t> rate_window_ns;
+
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    std::condition_variable drained_cv;
+    bool wake_requested = false;
+    uint64_t passes = 0;
+
+    std::atomic<bool> wake_pending{false};   // Ya se pidió una pasada por anillo a medio llenar
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> dropped_records{0};
+    uint64_t dropped_reported = 0;           // Sólo el sumidero
+    std::thread sink;
+};
+
+/**
+ * Un mensaje en construcción: LogLine(módulo, nivel) << "texto " << valor << ...
+ * - Literales y strings se copian; enteros, flotantes, punteros y bool van en binario
+ * - hex/dec/fixed..., setw, setfill y setprecision se guardan y se aplican al formatear
+ * - Cualquier otro tipo con operator<< se formatea en el llamador (caso raro)
+ * - El destructor publica el registro en el anillo del hilo
+ */
+class LogLine {
+public:
+    enum Tag : uint8_t { STR, CHAR, BOOL, I64, U64, F32, F64, PTR, IOS_MANIP, OS_MANIP, SETW, SETFILL, SETPRECISION };
+
+    LogLine(LogModule module, LogLevel level, uint32_t suppressed = 0);
+    ~LogLine();
+    LogLine(LogLine &&) = delete;
+    LogLine(const LogLine &) = delete;
+    LogLine &operator=(const LogLine &) = delete;
+
+    LogLine &operator<<(const char *text) { return text ? str(text, std::strlen(text)) : str("(null)", 6); }
+    LogLine &operator<<(char *text) { return *this << static_cast<const char *>(text); }
+    LogLine &operator<<(const std::string &text) { return str(text.data(), text.size()); }
+    LogLine &operator<<(std::string_view text) { return str(text.data(), text.size()); }
+    LogLine &operator<<(char c) { return put(CHAR, &c, 1); }
+    LogLine &operator<<(signed char c) { return *this << static_cast<char>(c); }    // ostream los trata como caracteres
+    LogLine &operator<<(unsigned char c) { return *this << static_cast<char>(c); }
+    LogLine &operator<<(bool b) { uint8_t v = b; return put(BOOL, &v, 1); }
+    LogLine &operator<<(float f) { return put(F32, &f, sizeof f); }
+    LogLine &operator<<(double d) { return put(F64, &d, sizeof d); }
+    LogLine &operator<<(long double d) { return *this << static_cast<double>(d); }
+    LogLine &operator<<(const void *p) { return put(PTR, &p, sizeof p); }
+    LogLine &operator<<(std::ios_base &(*manip)(std::ios_base &)) { return put(IOS_MANIP, &manip, sizeof manip); }
+    LogLine &operator<<(std::ostream &(*manip)(std::ostream &)) { return put(OS_MANIP, &manip, sizeof manip); }
+    LogLine &operator<<(decltype(std::setw(0)) m) { int32_t v = applied(m).width(); return put(SETW, &v, sizeof v); }
+    LogLine &operator<<(decltype(std::setfill('0')) m) { char c = applied(m).fill(); return put(SETFILL, &c, 1); }
+    LogLine &operator<<(decltype(std::setprecision(0)) m) { int32_t v = (int32_t)applied(m).precision(); return put(SETPRECISION, &v, sizeof v); }
+
+    template <typename T>
+    LogLine &operator<<(const T &value)
+    {
+        if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+        {
+            int64_t v = value;
+            return put(I64, &v, sizeof v);
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            uint64_t v = value;
+            return put(U64, &v, sizeof v);
+        }
+        else if constexpr (std::is_pointer_v<T>)
+        {
+            return *this << static_cast<const void *>(value);
+        }
+        else
+        {
+            std::ostringstream formatted;
+            formatted << value;
+            return *this << formatted.str();
+        }
+    }
+
+private:
+    LogLine &str(const char *text, size_t size);
+    LogLine &put(Tag tag, const void *value, size_t size);
+
+    template <typename M>
+    static std::ostream &applied(const M &manip)
+    {
+        static thread_local std::ostream probe(nullptr);
+        probe << manip;
+        return probe;
+    }
+
+    AsyncLogger::ThreadLog *log;
+    std::unique_ptr<AsyncLogger::ThreadLog> detached;   // Sin sumidero (cierre del proceso): se escribe directo
+    size_t start;
+    LogLevel level;
+};
+
+#endif // ASYNC_LOGGER_H
@@ -0,0 +1,36 @@
+#ifndef CHANGE_DETECTOR_H
+#define CHANGE_DETECTOR_H
+
+#include "common.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Detección de cambios por variable con banda muerta
+ * - Último valor publicado en un array denso indexado por id de variable (índice en config.variables)
+ * - FLOAT: ABSOLUTE compara |nuevo - último| > value, PERCENT compara contra value% de |último|
+ * - Banda 0 e INT32: cualquier cambio de bits cuenta (incluye transiciones a/desde NaN)
+ */
+class ChangeDetector {
+public:
+    // Dimensiona el almacén y olvida todos los valores (primer ciclo publica todo)
+    void reset(size_t variable_count);
+
+    // true si el valor debe publicarse; en ese caso queda registrado como último valor
+    bool acceptFloat(uint32_t id, float value, const Deadband &deadband);
+    bool acceptInt32(uint32_t id, int32_t value);
+
+    // Fuerza la publicación del próximo valor (p.ej. tras una escritura de cliente)
+    void invalidate(uint32_t id);
+
+    size_t size() const { return count; }
+
+private:
+    size_t count = 0;
+    std::vector<uint32_t> last_bits;                   // Bits del último valor publicado (float o int32)
+    std::unique_ptr<std::atomic<uint8_t>[]> valid;     // 0 = sin valor publicado (invalidate desde otros hilos)
+};
+
+#endif // CHANGE_DETECTOR_H
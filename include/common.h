@@ -4,11 +4,19 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <map>
 #include <atomic>
 #include <nlohmann/json.hpp>
+#include "async_logger.h"
 
 // ============== ESTRUCTURAS UNIFICADAS ==============
 
+// Banda muerta para detección de cambios (por clase de tag en tags.json)
+struct Deadband {
+    enum Mode { ABSOLUTE, PERCENT } mode = ABSOLUTE;
+    double value = 0.0;          // 0 = publicar cualquier cambio
+};
+
 // Variable unificada (para OPC-UA)
 struct Variable {
     // Nombres e identificadores
@@ -21,11 +29,14 @@ struct Variable {
     enum Type { FLOAT, INT32, SINGLE_FLOAT, SINGLE_INT32 } type = FLOAT;
     bool writable = false;       // Si se puede escribir
     bool has_node = false;       // Si ya se creó el nodo OPC-UA
-    int node_id = 0;            // NodeId numérico único
+    int node_id = 0;            // Índice denso en config.variables (asignado al procesar la config)
+    int controller = 0;          // Índice en config.controllers (PAC del que se lee)
     
     // Campos adicionales
     std::string description;     // Descripción opcional
     int table_index = -1;        // Índice en la tabla (0, 1, 2, 3)
+    int scan_ms = 0;             // Periodo de escaneo propio (0 = update_interval_ms)
+    Deadband deadband;           // Banda muerta resuelta desde "deadbands"
 
     // 🔧 AGREGAR SOPORTE PARA NODEID STRING
     std::string node_string_id;          // 🔧 NUEVO: NodeId STRING
@@ -38,44 +49,82 @@ struct Tag {
     std::string alarm_table;     // "TBL_TA_11001"
     std::vector<std::string> variables;  // ["PV", "SV", "HH", "LL"]
     std::vector<std::string> alarms;     // ["HI", "LO", "BAD"]
+    int scan_ms = 0;                     // Periodo de escaneo (0 = update_interval_ms)
+    int controller = 0;
 };
 
 struct APITag {
     std::string name;
     std::string value_table;  // ✅ Correcto
     std::vector<std::string> variables;
+    int scan_ms = 0;
+    int controller = 0;
 };
 
 struct BatchTag {
     std::string name;
     std::string value_table;  // ✅ Correcto  
     std::vector<std::string> variables;
+    int scan_ms = 0;
+    int controller = 0;
+};
+
+// Tabla PAC completa expuesta como una variable array (tbl_arrays), leída bajo demanda
+struct ArrayTag {
+    std::string name;            // "TREND_TT_11001"
+    std::string table;           // "TBL_TREND_TT_11001"
+    int size = 0;                // Elementos de la tabla
+    bool is_int32 = false;       // "type": "INT32" (por defecto FLOAT)
+    bool writable = false;
+    std::string description;
+    int controller = 0;
+};
+
+// Un PAC detrás del gateway ("controllers" en tags.json; sin esa lista, "pac_config" define uno solo)
+struct ControllerConfig {
+    std::string name;                // Carpeta OPC-UA y prefijo de NodeIds ("" = en la raíz, como siempre)
+    std::string ip = "192.168.1.30";
+    int port = 22001;
+    int pipeline_depth = 8;          // Comandos TRange. en vuelo por lote (1 = lockstep)
+    int sessions = 1;                // Sesiones TCP de lectura (+1 dedicada a escrituras)
 };
 
 // ============== CONFIGURACIÓN GLOBAL UNIFICADA ==============
 struct Config {
-    // Configuración de conexión PAC
-    std::string pac_ip = "192.168.1.30";
-    int pac_port = 22001;
+    // Controladores PAC (cada uno con sus sesiones, plan de sondeo y carpeta OPC-UA)
+    std::vector<ControllerConfig> controllers;
     
     // Configuración del servidor OPC-UA
     int opcua_port = 4840;
     int update_interval_ms = 2000;
     std::string server_name = "PAC Control SCADA Server";
+    bool poll_on_demand = false;       // Sondear a su ritmo sólo lo que tiene MonitoredItems
+    int background_refresh_ms = 30000; // Refresco de fondo del resto (con poll_on_demand)
+    int read_max_age_ms = 0;           // Lecturas OPC-UA más viejas que esto refrescan su fuente para los Read siguientes (0 = nunca)
+    int publish_interval_ms = 50;      // Volcado de valores del sondeo al espacio de direcciones
+    int metrics_port = 0;              // Endpoint Prometheus GET /metrics (0 = desactivado)
+    std::string metrics_bind = "127.0.0.1";
+    std::string packet_capture_file;   // Captura de tramas PAC en anillo ("" = desactivada)
+    int packet_capture_mb = 16;        // Tamaño del anillo de captura
     
     // Estructuras de datos de configuración (desde JSON)
     std::vector<Tag> tags;                    // TBL_tags tradicionales
     std::vector<APITag> api_tags;            // TBL_tags_api  
     std::vector<BatchTag> batch_tags;        // BATCH_tags
+    std::vector<ArrayTag> array_tags;        // tbl_arrays (sin sondeo)
+    std::map<std::string, Deadband> deadbands;  // Por clase ("TT", "API", "SimpleVars", ...) o "default"
     
     // Variables procesadas para OPC-UA (generadas desde las anteriores)
     std::vector<Variable> variables;         // Variables finales para OPC-UA
     
     // Métodos de utilidad
     void clear() {
+        controllers.clear();
         tags.clear();
         api_tags.clear(); 
         batch_tags.clear();
+        array_tags.clear();
+        deadbands.clear();
         variables.clear();
     }
     
@@ -96,10 +145,11 @@ struct Config {
 extern Config config;
 extern std::atomic<bool> running;
 extern std::atomic<bool> server_running;
-extern std::atomic<bool> updating_internally;
-extern std::atomic<bool> server_writing_internally;
 
 // ============== LOGGING UNIFICADO ==============
+// Asíncrono (async_logger.h): el hilo que loguea sólo codifica los argumentos en su anillo.
+// SILENT_MODE deja sólo los errores compilados; el resto de niveles se decide en ejecución
+// por subsistema ("logging" en tags.json, Gateway.LogLevels), VERBOSE_DEBUG arranca en debug
 #ifdef SILENT_MODE
     #define LOG_ENABLED 0
 #elif defined(VERBOSE_DEBUG)
@@ -108,42 +158,75 @@ extern std::atomic<bool> server_writing_internally;
     #define LOG_ENABLED 1
 #endif
 
-#define COLOR_RESET   "\033[0m"
-#define COLOR_RED     "\033[31m"
-#define COLOR_GREEN   "\033[32m"
-#define COLOR_YELLOW  "\033[33m"
-#define COLOR_BLUE    "\033[34m"
-#define COLOR_CYAN    "\033[36m"
+// Subsistema de los mensajes de un archivo: #define LOG_MODULE LogModule::PAC antes de los includes
+#ifndef LOG_MODULE
+    #define LOG_MODULE LogModule::General
+#endif
 
-#define LOG_ERROR(msg) \
-    std::cout << COLOR_RED << "❌ [ERROR] " << COLOR_RESET << msg << std::endl;
+#define LOG_ACTIVE(module, level) (LOG_ENABLED >= 1 && AsyncLogger::enabled(module, level))
 
-  #define   LOG_WARNING(msg) \
-    if (LOG_ENABLED >= 1) { \
-        std::cout << COLOR_YELLOW << "⚠️  [WARN]  " << COLOR_RESET << msg << std::endl; \
+#define LOG_AT(module, level, msg) \
+    if (LOG_ACTIVE(module, level)) { \
+        LogLine(module, level) << msg; \
     }
 
-#define LOG_INFO(msg) \
-    if (LOG_ENABLED >= 1) { \
-        std::cout << COLOR_CYAN << "ℹ️  [INFO]  " << COLOR_RESET << msg << std::endl; \
+// Errores y advertencias: ráfaga limitada por punto de log (un PAC caído no inunda la salida)
+#define LOG_LIMITED(module, level, msg) \
+    if (level == LogLevel::Error || LOG_ACTIVE(module, level)) { \
+        static LogSite log_site_; \
+        uint32_t log_suppressed_ = 0; \
+        if (AsyncLogger::admit(log_site_, log_suppressed_)) { \
+            LogLine(module, level, log_suppressed_) << msg; \
+        } \
     }
 
-#define LOG_DEBUG(msg) \
-    if (LOG_ENABLED >= 2) { \
-        std::cout << COLOR_BLUE << "🔧 [DEBUG] " << COLOR_RESET << msg << std::endl; \
-    }
+#define LOG_ERROR(msg) LOG_LIMITED(LOG_MODULE, LogLevel::Error, msg)
+#define LOG_WARNING(msg) LOG_LIMITED(LOG_MODULE, LogLevel::Warning, msg)
+#define LOG_INFO(msg) LOG_AT(LOG_MODULE, LogLevel::Info, msg)
+#define LOG_DEBUG(msg) LOG_AT(LOG_MODULE, LogLevel::Debug, msg)
+#define LOG_WRITE(msg) LOG_AT(LogModule::Write, LogLevel::Info, "📝 " << msg)
+#define LOG_PAC(msg) LOG_AT(LogModule::PAC, LogLevel::Info, "🔌 " << msg)
+
+// ¿Vale la pena construir un volcado de depuración del subsistema de este archivo?
+#define LOG_DEBUG_ACTIVE() LOG_ACTIVE(LOG_MODULE, LogLevel::Debug)
+
+// Compatibilidad con código existente: volcados de detalle, no información de operación
+#define DEBUG_INFO(msg) LOG_DEBUG(msg)
+
+// ============== PUNTOS DE TRAZA ==============
+// Volcados byte a byte de comandos y tramas: sólo existen compilando con PAC_TRACE_POINTS
+// (cmake -DPAC_TRACE_POINTS=ON); sin él no generan código ni evalúan sus argumentos.
+// Compilados, salen como debug del subsistema del archivo. Para tramas en producción
+// está la captura de paquetes (packet_capture.h), que no formatea nada en el hilo de E/S
+#ifdef PAC_TRACE_POINTS
+    #define PAC_TRACE_COMPILED true
+#else
+    #define PAC_TRACE_COMPILED false
+#endif
 
-#define LOG_WRITE(msg) \
-    if (LOG_ENABLED >= 1) { \
-        std::cout << COLOR_GREEN << "📝 [WRITE] " << COLOR_RESET << msg << std::endl; \
+#define PAC_TRACE(msg) \
+    if constexpr (PAC_TRACE_COMPILED) { \
+        LOG_AT(LOG_MODULE, LogLevel::Debug, "🔬 " << msg) \
     }
 
-#define LOG_PAC(msg) \
-    if (LOG_ENABLED >= 1) { \
-        std::cout << COLOR_YELLOW << "🔌 [PAC]   " << COLOR_RESET << msg << std::endl; \
+#define PAC_TRACE_BYTES(label, data, size) \
+    PAC_TRACE(label << " (" << (size) << " bytes): " << hexBytes(data, size))
+
+// "00 0a ff ..." (sólo lo usan las trazas)
+inline std::string hexBytes(const void *data, size_t size)
+{
+    static const char DIGITS[] = "0123456789abcdef";
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    std::string out;
+    out.reserve(size * 3);
+    for (size_t i = 0; i < size; i++)
+    {
+        if (i > 0)
+            out += ' ';
+        out += DIGITS[bytes[i] >> 4];
+        out += DIGITS[bytes[i] & 0x0f];
     }
-
-// Compatibilidad con código existente
-#define DEBUG_INFO(msg) LOG_INFO(msg)
+    return out;
+}
 
 #endif // COMMON_H
\ No newline at end of file
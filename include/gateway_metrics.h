@@ -0,0 +1,121 @@
+#ifndef GATEWAY_METRICS_H
+#define GATEWAY_METRICS_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <map>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Histograma de latencias estilo HDR (log-lineal) en microsegundos
+ * - 16 sub-cubetas por potencia de 2: error relativo < 6.25 % en cualquier percentil
+ * - record() es lock-free (fetch_add relajado): apto para el hilo del motor de E/S
+ * - Valores por encima de 2^32 µs (~71 min) caen en la última cubeta
+ */
+class LatencyHistogram {
+public:
+    void record(uint64_t micros);
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_us.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_us.load(std::memory_order_relaxed); }
+
+    // Cota superior de la cubeta que contiene el percentil q (0..1); 0 sin muestras
+    uint64_t percentile(double q) const;
+
+private:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int MAX_BITS = 32;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BITS;
+    static constexpr size_t BUCKETS = SUB_BUCKETS * (MAX_BITS - SUB_BITS + 1);
+
+    static size_t bucketOf(uint64_t micros);
+    static uint64_t bucketUpper(size_t bucket);
+
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum_us{0};
+    std::atomic<uint64_t> max_us{0};
+};
+
+// Contadores de una tabla PAC (etiqueta table="TBL_xxx")
+struct TableMetrics {
+    std::string name;
+    LatencyHistogram latency;              // Tiempo de servicio de su TRange. dentro del pipeline
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> errors{0};       // Sin trama completa (timeout, cierre o desincronización)
+    std::atomic<uint64_t> bytes_in{0};
+    std::atomic<uint64_t> changed_reads{0};    // Análisis de estabilidad: la trama cambió respecto a la anterior
+    std::atomic<uint64_t> unchanged_reads{0};
+};
+
+/**
+ * Métricas de un PAC (etiqueta pac="ip:port"): nivel de cable, sondeo y escrituras
+ * - Los contadores se incrementan sin locks desde cualquier hilo
+ * - table() crea la entrada la primera vez (mutex, fuera del camino caliente): el cliente
+ *   guarda el puntero por id de tabla y el ciclo sólo hace fetch_add
+ */
+struct PACMetrics {
+    std::string pac;
+
+    // Cable
+    std::atomic<uint64_t> bytes_out{0};
+    std::atomic<uint64_t> bytes_in{0};
+    std::atomic<uint64_t> timeouts{0};          // Respuestas que no llegaron antes del deadline
+    std::atomic<uint64_t> desyncs{0};           // Tramas inválidas o conexión cerrada con solicitudes en vuelo
+    std::atomic<uint64_t> connects{0};
+    std::atomic<uint64_t> reconnects{0};        // Conexiones tras la primera de cada sesión
+    std::atomic<uint64_t> connect_failures{0};
+    std::atomic<uint64_t> retries{0};           // Relecturas por validateDataIntegrity
+
+    // Escrituras
+    LatencyHistogram write_latency;             // Envío → confirmación 00 00
+    std::atomic<uint64_t> writes_ok{0};
+    std::atomic<uint64_t> writes_failed{0};
+
+    // Sondeo
+    LatencyHistogram cycle_time;                // Lectura + publicación de un lote en el ValueStore
+    std::atomic<uint64_t> cycles{0};
+    std::atomic<uint64_t> overruns{0};          // Deadlines perdidos
+    std::atomic<uint64_t> values_published{0};  // Cambios publicados en el ValueStore
+    std::atomic<uint64_t> values_suppressed{0}; // Lecturas dentro de la banda muerta
+
+    TableMetrics &table(std::string_view name);
+
+    // Instantánea de las tablas registradas (punteros estables mientras viva el proceso)
+    std::vector<const TableMetrics *> tableList() const;
+
+private:
+    mutable std::mutex tables_mutex;
+    std::deque<TableMetrics> tables;
+    std::map<std::string, TableMetrics *, std::less<>> by_name;
+};
+
+/**
+ * Registro global de métricas del gateway
+ * - Una entrada por PAC, creada al primer uso y nunca destruida (los punteros son estables)
+ * - renderPrometheus() produce el formato de texto 0.0.4 de Prometheus
+ */
+class GatewayMetrics {
+public:
+    static GatewayMetrics &instance();
+
+    PACMetrics &pac(const std::string &ip, int port);
+    std::vector<const PACMetrics *> pacList() const;
+
+    std::string renderPrometheus() const;
+
+private:
+    mutable std::mutex pacs_mutex;
+    std::deque<PACMetrics> pacs;
+};
+
+inline GatewayMetrics &gatewayMetrics() { return GatewayMetrics::instance(); }
+
+#endif // GATEWAY_METRICS_H
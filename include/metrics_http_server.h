@@ -0,0 +1,41 @@
+#ifndef METRICS_HTTP_SERVER_H
+#define METRICS_HTTP_SERVER_H
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+/**
+ * Endpoint HTTP mínimo para el scraper de Prometheus (GET /metrics)
+ * - Un hilo propio con accept/poll: nunca toca el hilo del servidor OPC-UA ni el de sondeo
+ * - Una conexión a la vez, "Connection: close"; cualquier otra ruta responde 404
+ * - Cada cliente tiene un plazo para pedir y recibir: uno lento o que no lee se descarta
+ * - Escucha en 127.0.0.1 por defecto: exponerlo a la red es decisión del despliegue
+ */
+class MetricsHttpServer {
+public:
+    using Renderer = std::function<std::string()>;
+
+    MetricsHttpServer(Renderer renderer, int port, const std::string &bind_address = "127.0.0.1");
+    ~MetricsHttpServer();
+
+    bool start();
+    void stop();
+
+    int getPort() const { return port; }   // Puerto real (útil con port = 0)
+
+private:
+    Renderer renderer;
+    int port;
+    std::string bind_address;
+    int listen_fd = -1;
+
+    std::thread server_thread;
+    std::atomic<bool> stopping{false};
+
+    void serveLoop();
+    void handleClient(int fd);
+};
+
+#endif // METRICS_HTTP_SERVER_H
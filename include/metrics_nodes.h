@@ -0,0 +1,58 @@
+#ifndef METRICS_NODES_H
+#define METRICS_NODES_H
+
+#include <open62541/server.h>
+#include "gateway_metrics.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Métricas de un PAC expuestas como variables de diagnóstico OPC-UA (carpeta "Diagnostics")
+ * - Nodos con data source: el valor se calcula del registro de métricas sólo al leerlos
+ * - Escalares (ciclo, cable, escrituras) y arrays por tabla (nombre, p99 y tiempo total)
+ * - Sólo lectura; no pasan por el plan de sondeo ni por el PAC
+ */
+class PACMetricsNodes {
+public:
+    // Qué devuelve cada nodo
+    enum Field {
+        CYCLE_P50_MS,
+        CYCLE_P99_MS,
+        CYCLE_MAX_MS,
+        POLL_CYCLES,
+        POLL_OVERRUNS,
+        VALUES_PUBLISHED,
+        BYTES_IN,
+        BYTES_OUT,
+        TIMEOUTS,
+        RECONNECTS,
+        INTEGRITY_RETRIES,
+        WRITE_CONFIRM_P99_MS,
+        TABLE_NAMES,
+        TABLE_READ_P99_MS,
+        TABLE_READ_TOTAL_MS
+    };
+
+    explicit PACMetricsNodes(const PACMetrics &metrics);
+
+    // Crea la carpeta "Diagnostics" bajo parent y sus variables (NodeIds con prefix)
+    size_t createNodes(UA_Server *server, const UA_NodeId &parent, const std::string &prefix = "");
+
+private:
+    struct MetricNode {
+        PACMetricsNodes *owner;
+        Field field;
+    };
+
+    const PACMetrics &metrics;
+    std::vector<std::unique_ptr<MetricNode>> nodes;
+
+    static UA_StatusCode readCallback(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+                                      const UA_NodeId *nodeId, void *nodeContext, UA_Boolean includeSourceTimeStamp,
+                                      const UA_NumericRange *range, UA_DataValue *value);
+
+    UA_StatusCode read(Field field, UA_Variant &out) const;
+};
+
+#endif // METRICS_NODES_H
@@ -4,10 +4,17 @@
 #include <open62541/server.h>
 #include "common.h"  // Contiene todas las estructuras
 #include <memory>
+#include <functional>
+
+struct PollCycleResult;
+
+// Observador por ciclo de sondeo (resultado crudo + duración en ms), usado por el benchmark
+using PollCycleObserver = std::function<void(const PollCycleResult &, double)>;
 
 // ============== FUNCIONES DEL SERVIDOR ==============
-bool ServerInit();
+bool ServerInit(const std::string &configFile = "tags.json");
 UA_StatusCode runServer();
+void requestServerStop();
 void shutdownServer();
 void cleanupServer();
 void cleanupAndExit();
@@ -28,8 +35,12 @@ bool isWritableVariable(const std::string &varName);
 void verifyAndFixNodeTypes();
 void enableWriteCallbacks();
 void enableWriteCallbacksOnce();
+void enableReadThroughCallbacks();
 void performImmediateDataUpdate();
 void writeDefaultValuesToWritableVariables();
+Variable* findVariableByNodeId(const UA_NodeId &nodeId);
+void publishWriteStatus(const std::string &lastResult);
+void setPollCycleObserver(PollCycleObserver observer);
 
 
 #endif // OPCUA_SERVER_H
\ No newline at end of file
@@ -0,0 +1,80 @@
+#ifndef PAC_ARRAY_SOURCE_H
+#define PAC_ARRAY_SOURCE_H
+
+#include <open62541/server.h>
+#include "common.h"
+#include "pac_connection_pool.h"
+#include "pac_write_queue.h"
+#include <memory>
+#include <vector>
+#include <future>
+#include <chrono>
+
+/**
+ * Tablas PAC completas expuestas como una variable OPC-UA de tipo array (tbl_arrays)
+ * - Cada ArrayTag es un nodo con data source: no entra en el plan de sondeo,
+ *   se lee del PAC sólo cuando un cliente lo pide
+ * - El Read nunca espera al PAC: se sirve el tramo pedido ("10:49") de la última lectura
+ *   completa de la tabla; si es más vieja que max_age se lanza otra por una sesión de sondeo
+ *   conectada y la ven los Read siguientes (el primero responde BadWaitingForInitialData)
+ * - Escrituras como tramo en la cola de escritura del controlador: el Write responde al
+ *   aceptarlas y el resultado llega a los nodos de estado de escritura
+ */
+class PACArraySource {
+private:
+    // Lectura completa de una tabla en vuelo: el motor escribe en results hasta que done esté listo
+    struct ArrayRefresh {
+        vector<TableReadRequest> requests;
+        vector<TableReadResult> results;
+        future<void> done;
+        chrono::steady_clock::time_point started;
+        int64_t read_at_ns = 0;               // system_clock, para sourceTimestamp
+    };
+
+    // Contexto de nodo: lo que necesitan los callbacks estáticos; el resto sólo lo toca el hilo del servidor
+    struct ArrayNode {
+        PACArraySource *owner;
+        const ArrayTag *tag;
+
+        TableReadResult data;                 // Última lectura completa (ok = hay datos)
+        chrono::steady_clock::time_point read_at;
+        int64_t read_at_ns = 0;
+        bool failed = false;                  // La última lectura no trajo la tabla entera
+        unique_ptr<ArrayRefresh> refresh;     // Lectura en vuelo (una por nodo)
+    };
+
+    PACConnectionPool &pool;
+    PACWriteQueue &writes;
+    int controller;               // Índice en config.controllers de las tablas que sirve
+    chrono::milliseconds max_age; // Edad a partir de la cual un Read relanza la lectura (0 = siempre)
+    vector<unique_ptr<ArrayNode>> nodes;
+
+    static UA_StatusCode readCallback(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+                                      const UA_NodeId *nodeId, void *nodeContext, UA_Boolean includeSourceTimeStamp,
+                                      const UA_NumericRange *range, UA_DataValue *value);
+    static UA_StatusCode writeCallback(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+                                       const UA_NodeId *nodeId, void *nodeContext,
+                                       const UA_NumericRange *range, const UA_DataValue *value);
+
+    UA_StatusCode readSlice(ArrayNode &node, const UA_NumericRange *range, UA_DataValue *value);
+    UA_StatusCode writeSlice(ArrayNode &node, const UA_NumericRange *range, const UA_Variant &data);
+
+    void startRefresh(ArrayNode &node);
+    void collectRefresh(ArrayNode &node, bool wait);
+
+public:
+    PACArraySource(PACConnectionPool &pool, PACWriteQueue &writes, int controller = 0,
+                   chrono::milliseconds max_age = chrono::milliseconds(0));
+    ~PACArraySource();   // Espera las lecturas en vuelo (escriben en los nodos)
+
+    // Crea la carpeta "Arrays" bajo parent y un nodo por tabla del controlador (NodeIds con prefix);
+    // tags debe vivir mientras exista el servidor
+    size_t createNodes(UA_Server *server, const vector<ArrayTag> &tags,
+                       const UA_NodeId &parent, const string &prefix = "");
+};
+
+// Tramo [start, end] (inclusivo) de un array de size elementos pedido por un NumericRange;
+// sin rango = array completo. Devuelve GOOD o el código OPC-UA que corresponde al rango
+UA_StatusCode resolveArrayRange(const UA_NumericRange *range, size_t size, int &start, int &end);
+
+#endif // PAC_ARRAY_SOURCE_H
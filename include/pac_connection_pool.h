@@ -0,0 +1,63 @@
+#ifndef PAC_CONNECTION_POOL_H
+#define PAC_CONNECTION_POOL_H
+
+#include "pac_control_client.h"
+#include <memory>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <atomic>
+
+// Resultado de un ciclo de lectura repartido entre sesiones
+struct PollCycleResult {
+    vector<TableReadResult> tables;              // Mismo orden que las solicitudes
+    map<string, ScalarReadResult> scalars;       // Por nombre PAC
+};
+
+/**
+ * Pool de sesiones TCP hacia el mismo PAC (puerto 22001 acepta varias)
+ * - N sesiones de lectura atendidas por el motor de E/S compartido: readCycle las
+ *   lanza todas a la vez y espera los futures, sin un hilo por sesión
+ * - 1 sesión dedicada a escrituras de operador (nunca espera a un ciclo de lectura)
+ */
+class PACConnectionPool {
+private:
+    string pac_ip;
+    int pac_port;
+
+    vector<unique_ptr<PACControlClient>> poll_sessions;
+    unique_ptr<PACControlClient> write_session;
+    atomic<size_t> next_reader{0};
+
+public:
+    PACConnectionPool(const string& ip, int port, size_t sessions = 1);
+    ~PACConnectionPool();
+
+    // Gestión de conexión
+    bool connect();                  // true si hay al menos una sesión de lectura conectada
+    void disconnect();
+    bool isConnected() const;
+    size_t connectedSessions() const;
+    size_t reconnectDeadSessions();  // Reabre sesiones caídas, devuelve cuántas se recuperaron
+
+    // Lecturas repartidas entre las sesiones conectadas (tablas en pipeline + escalares en lote)
+    PollCycleResult readCycle(const vector<TableReadRequest>& tables,
+                              const vector<pair<string, string>>& scalars,
+                              size_t pipeline_depth = 8);
+
+    // Sesión dedicada para escrituras (reconecta si hace falta: sólo desde el hilo escritor)
+    PACControlClient& writer();
+
+    // Sesión de lectura conectada para lecturas bajo demanda, por turnos; nunca reconecta
+    // (apta para el hilo del servidor OPC-UA). nullptr si no hay ninguna conectada
+    PACControlClient* reader();
+
+    // Registro de tablas internadas para la caché de todas las sesiones
+    void setTableRegistry(const TableRegistry* registry);
+
+    size_t sessionCount() const { return poll_sessions.size(); }
+    string getIP() const { return pac_ip; }
+};
+
+#endif // PAC_CONNECTION_POOL_H
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <span>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <unistd.h>
@@ -11,6 +12,10 @@
 #include <iostream>
 #include <mutex>
 #include <chrono>
+#include <future>
+#include "table_cache.h"
+#include "pac_io_engine.h"
+#include "gateway_metrics.h"
 
 
 using namespace std; 
@@ -86,6 +91,45 @@ struct TBL_ALARM_t {
     TBL_ALARM_t() { memset(TBL, 0, sizeof(TBL)); }
 };
 
+// Solicitud de lectura de tabla para el modo pipeline
+struct TableReadRequest {
+    string table_name;
+    int start_pos = 0;
+    int end_pos = 9;
+    bool is_int32 = false;   // true para tablas de alarmas (TBL_TA_, TBL_DA_, ...)
+    TableId table_id = NO_TABLE;  // Id internado (caché por id; NO_TABLE = sin caché)
+    string command;          // Comando precompilado (vacío = construir desde el rango)
+    // Destino opcional (almacén de valores del llamador): si no está vacío se decodifica
+    // directamente aquí y el resultado no asigna floats/ints
+    span<float> float_dest;
+    span<int32_t> int_dest;
+};
+
+// Resultado de una lectura pipeline (floats o ints según is_int32)
+struct TableReadResult {
+    bool ok = false;
+    vector<float> floats;
+    vector<int32_t> ints;
+    size_t count = 0;        // Elementos decodificados (en floats/ints o en el destino)
+    size_t non_finite = 0;   // Floats Inf/NaN en la trama (se publican tal cual)
+    uint32_t latency_us = 0; // Desde el envío del lote hasta la trama completa
+};
+
+// Escritura ya formateada (TABLE! o @!) para el envío en pipeline
+struct WriteCommand {
+    string command;
+    bool ok = false;         // Confirmada con 00 00
+    bool sent = false;       // El PAC respondió (00 00 o no): el comando salió seguro
+};
+
+// Valor escalar tipado de la lectura en lote de variables individuales
+struct ScalarReadResult {
+    bool ok = false;
+    bool is_int32 = false;
+    float float_value = 0.0f;
+    int32_t int_value = 0;
+};
+
 /**
  * Cliente PAC Control para comunicación con controlador Opto22
  * Implementa el protocolo reverse-engineered completamente
@@ -94,23 +138,46 @@ class PACControlClient {
 private:
     string pac_ip;
     int pac_port;
-    int sock;
-    bool connected;
+    // Conexión en el motor de E/S compartido (sockets no bloqueantes + epoll)
+    shared_ptr<PACIoEngine> io;
+    atomic<PACIoEngine::ConnectionId> io_conn{PACIoEngine::NO_CONNECTION};
+    atomic<bool> connected;
     bool cache_enabled; // Control del sistema de cache
-    mutex comm_mutex;
-    
-    // Cache para optimizar lecturas
-    struct CacheEntry {
-        vector<float> data;
-        chrono::steady_clock::time_point timestamp;
-        bool valid;
-    };
-    map<string, CacheEntry> table_cache;
-    const int CACHE_TIMEOUT_MS = 5000; // 5 segundos cache timeout para valores estables
-     // ...existing methods...
+    mutex comm_mutex;   // Serializa las operaciones síncronas de esta sesión
     
+    // Cache para optimizar lecturas: bloque contiguo por id de tabla internado
+    // (mutex propio: las lecturas asíncronas la actualizan desde el hilo del motor)
+    mutable mutex cache_mutex;
+    const TableRegistry* table_registry = nullptr;
+    TableCache table_cache;
+    const int CACHE_TIMEOUT_MS = 5000; // 5 segundos cache timeout para valores estables
+    static constexpr chrono::milliseconds IO_TIMEOUT{3000};            // Por respuesta
+    static constexpr chrono::milliseconds WRITE_CONFIRM_TIMEOUT{1000};  // Confirmación 00 00
+    static constexpr size_t MAX_ASCII_RESPONSE = 50;  // Protección contra respuestas muy largas
+
+    // Métricas del PAC (compartidas por todas las sesiones al mismo ip:port) y por id de tabla
+    PACMetrics* metrics;
+    vector<TableMetrics*> table_metrics;   // Con cache_mutex, dimensionado en setTableRegistry()
+    bool ever_connected = false;           // Las conexiones siguientes cuentan como reconexiones
+    TableMetrics* tableMetricsOf(const TableReadRequest& req);   // Con cache_mutex tomado
+    void countFailure(IoStatus status);
+
+    // Un comando y su respuesta a través del motor, esperando el resultado (con comm_mutex tomado)
+    IoStatus exchange(const string& command, IoFrame frame, vector<uint8_t>& response,
+                      chrono::milliseconds timeout = IO_TIMEOUT, bool desync_after = false);
+    // Tabla binaria: header 00 00 + expected_bytes; devuelve sólo los datos (vacío si falló)
+    vector<uint8_t> requestTableData(const string& command, size_t expected_bytes, bool desync_after = false);
+    // Respuesta ASCII terminada en espacio 0x20 (sin el terminador)
+    vector<uint8_t> requestASCIIResponse(const string& command);
+    // Escritura confirmada con 00 00
+    bool requestWriteConfirmation(const string& command);
+    // Respuesta sin trama conocida: lo que llegue primero (el resto se descarta)
+    string requestResponse(const string& command);
+    void cacheTableResult(const TableReadRequest& req, const TableReadResult& result);
+    size_t readTableInto(const string& table_name, int start_pos, int end_pos,
+                         span<float> float_out, span<int32_t> int_out);
+
     // NUEVAS FUNCIONES para manejo ASCII
-    vector<uint8_t> receiveASCIIResponse();
     string convertBytesToASCII(const vector<uint8_t>& bytes);
     string cleanASCIINumber(const string& ascii_str);
     // Historial para análisis de estabilidad
@@ -140,14 +207,38 @@ public:
     
     // Lectura de tablas completas
     vector<int32_t> readInt32Table(const string& table_name, int start_pos = 0, int end_pos = 9);
+
+    // Lectura pipeline: envía hasta max_in_flight comandos TRange. seguidos y
+    // demultiplexa las respuestas binarias en orden (header 2 bytes + payload)
+    vector<TableReadResult> readTablesPipelined(const vector<TableReadRequest>& requests,
+                                                size_t max_in_flight = 8);
+    // Subconjunto de requests (por índice) con resultados en results[índice]: sin copiar solicitudes
+    void readTablesPipelined(const vector<TableReadRequest>& requests, const vector<size_t>& indices,
+                             vector<TableReadResult>& results, size_t max_in_flight = 8);
+    // Igual, sin bloquear: decodifica en el hilo del motor y el future queda listo al terminar.
+    // requests, indices, results y los destinos deben seguir vivos hasta entonces
+    future<void> readTablesAsync(const vector<TableReadRequest>& requests, const vector<size_t>& indices,
+                                 vector<TableReadResult>& results, size_t max_in_flight = 8);
+
+    // Lectura de una tabla directamente en el destino del llamador (sin asignaciones);
+    // devuelve los elementos escritos, 0 si falló
+    size_t readFloatTableInto(const string& table_name, int start_pos, int end_pos, span<float> out);
+    size_t readInt32TableInto(const string& table_name, int start_pos, int end_pos, span<int32_t> out);
     string readStringVariable(const string& variable_name);
     // Escritura de variables (float e int32)
     bool writeFloatVariable(const string& table_name, int index, float value);
     bool writeInt32Variable(const string& table_name, int index, int32_t value);
     
-    // Escritura de tablas completas
+    // Escritura de tablas completas (desde el índice 0)
     bool writeFloatTable(const string& table_name, const vector<float>& values);
     bool writeInt32Table(const string& table_name, const vector<int32_t>& values);
+
+    // Escritura en bloque de un rango contiguo [start_index, start_index + values.size())
+    // TABLE! en pipeline con una pasada de confirmaciones; devuelve cuántos índices se confirmaron
+    size_t writeFloatTableRange(const string& table_name, int start_index, const vector<float>& values,
+                                size_t max_in_flight = 64);
+    size_t writeInt32TableRange(const string& table_name, int start_index, const vector<int32_t>& values,
+                                size_t max_in_flight = 64);
     
     // Comandos básicos descubiertos del análisis anterior
     vector<string> getTasks();
@@ -156,12 +247,14 @@ public:
     
     // Utilidades
     void clearCache();
-    void setIP(const string& ip) { pac_ip = ip; }
+    void setIP(const string& ip) { pac_ip = ip; metrics = &gatewayMetrics().pac(pac_ip, pac_port); }
     string getIP() const { return pac_ip; }
     string sendRawCommand(const string& command);
     
     // Control del cache para diagnóstico
     void enableCache(bool enabled = true) { cache_enabled = enabled; }
+    // Ids de tabla internados al cargar la configuración; dimensiona la caché (debe vivir más que el cliente)
+    void setTableRegistry(const TableRegistry* registry);
     bool isCacheEnabled() const { return cache_enabled; }
     
     // Análisis automático de tipo de datos
@@ -170,25 +263,31 @@ public:
     // Análisis de estabilidad de datos
     void analyzeDataStability(const string& table_name, const vector<uint8_t>& raw_data);
     
-    vector<uint8_t> receiveData(size_t expected_bytes);
     // 🔧 NUEVOS MÉTODOS PARA EVITAR INTERFERENCIAS (públicos para testing)
-    void flushSocketBuffer();  // Limpiar buffer del socket
     bool validateDataIntegrity(const vector<uint8_t>& data, const string& table_name);  // Validar integridad
     vector<float> convertBytesToFloats(const vector<uint8_t>& bytes);  // Expuesto para testing
     float readSingleFloatVariableByTag(const string& tag_name);
     int32_t readSingleInt32VariableByTag(const string& tag_name);
-    map<string, float> readMultipleSingleVariables(const vector<pair<string, string>>& variables);
+    // Lectura en lote: variables = {nombre PAC, "FLOAT"|"INT32"}; un solo envío ^NAME @@ F.
+    // concatenado y las respuestas ASCII (terminadas en 0x20) se parsean en orden
+    map<string, ScalarReadResult> readMultipleSingleVariables(const vector<pair<string, string>>& variables,
+                                                              size_t max_in_flight = 64);
+    // Igual, sin bloquear: results se rellena en el hilo del motor (vivo hasta que el future esté listo)
+    future<void> readScalarsAsync(const vector<pair<string, string>>& variables,
+                                  map<string, ScalarReadResult>& results, size_t max_in_flight = 64);
     bool writeSingleFloatVariable(const std::string& variable_name, float value);
     bool writeSingleInt32Variable(const std::string& variable_name, int32_t value);
     bool writeFloatTableIndex(const std::string& table_name, int index, float value);    
     bool writeInt32TableIndex(const std::string& table_name, int index, int32_t value);
+    // Escritura pipeline: hasta max_in_flight comandos por envío y una pasada de confirmaciones;
+    // marca ok en cada comando confirmado y devuelve cuántos lo fueron
+    size_t writeCommandsPipelined(vector<WriteCommand>& commands, size_t max_in_flight = 32);
     //void debugWriteOperation(const std::string& table_name, int index, float value);
     // NUEVA: Función para programar verificación asíncrona (opcional)
     void scheduleWriteVerification(const std::string& table_name, int index, float expected_value);
     void debugWriteOperation(const std::string& table_name, int index, float value);
 
 private:
-    bool sendCommand(const string& command);     
     vector<uint8_t> convertInt32sToBytes(const vector<int32_t>& ints);  
     vector<int32_t> convertBytesToInt32s(const vector<uint8_t>& bytes);
     vector<uint8_t> convertFloatsToBytes(const vector<float>& floats);
@@ -197,11 +296,9 @@ private:
     // NUEVAS: Funciones de conversión robustas
     float convertStringToFloat(const string& str);           // Maneja notación científica
     int32_t convertStringToInt32(const string& str);  
-    bool isCacheValid(const string& key);
-    string receiveResponse();
+    TableId tableIdOf(const string& table_name) const;
     bool validateSingleVariableIntegrity(const vector<uint8_t>& data, 
                                         const string& tag_name);
-    bool receiveWriteConfirmation();
     void clearCacheForTable(const std::string& table_name);    
 };
 
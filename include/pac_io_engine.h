@@ -0,0 +1,141 @@
+#ifndef PAC_IO_ENGINE_H
+#define PAC_IO_ENGINE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <span>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+#include "packet_capture.h"
+
+// Resultado de una solicitud al motor de E/S
+enum class IoStatus {
+    OK,
+    TIMEOUT,        // La trama no llegó completa antes del deadline de la solicitud
+    CLOSED,         // El PAC cerró la conexión, error de socket o conexión cerrada localmente
+    DESYNCED,       // Trama inválida (propia o de una solicitud anterior del mismo pipeline)
+    NOT_CONNECTED
+};
+
+// Cómo se delimita la respuesta de un comando PAC en el stream
+struct IoFrame {
+    enum Kind { FIXED, DELIMITED, ANY, NONE };
+    Kind kind = FIXED;
+    size_t bytes = 0;        // FIXED: tamaño exacto; DELIMITED: máximo sin terminador
+    uint8_t delimiter = 0;
+
+    static IoFrame fixed(size_t bytes) { return {FIXED, bytes, 0}; }                       // Tablas, 00 00
+    static IoFrame delimited(uint8_t delimiter, size_t max_bytes) { return {DELIMITED, max_bytes, delimiter}; }  // ASCII
+    static IoFrame any() { return {ANY, 0, 0}; }                                            // Lo que llegue primero
+    static IoFrame none() { return {NONE, 0, 0}; }                                          // Sin respuesta: completa al enviarse
+};
+
+// Un comando PAC y su respuesta
+struct IoRequest {
+    std::string tx;
+    IoFrame frame;
+    std::chrono::milliseconds timeout{3000};  // Desde que la solicitud encabeza la cola de respuestas
+    size_t max_in_flight = 0;                 // Solicitudes enviadas sin respuesta antes que ésta (0 = sin límite)
+    bool desync_after = false;                // Respuesta de tamaño incierto: descartar lo que siga antes del próximo envío
+
+    // Se invoca en el hilo del motor y en orden de envío; response (sin el terminador si
+    // es DELIMITED) sólo es válido durante la llamada. Devolver false = trama inválida:
+    // el stream queda desincronizado y las solicitudes pendientes terminan en DESYNCED
+    std::function<bool(IoStatus, std::span<const uint8_t>)> on_complete;
+};
+
+/**
+ * Motor de E/S hacia los PAC: un hilo con epoll para todas las conexiones
+ * - Sockets no bloqueantes (connect incluido) y un timerfd por conexión con el
+ *   deadline de la solicitud que encabeza la cola de respuestas
+ * - Los comandos encolados se escriben juntos en el socket (pipeline) y las
+ *   respuestas se enmarcan y completan en orden de envío
+ * - Un timeout o una trama inválida aborta lo pendiente y descarta los bytes
+ *   residuales antes del siguiente envío (lo que hacía flushSocketBuffer)
+ * - connect()/close() y el future de submit() no deben esperarse desde un callback
+ * - Si el motor no arrancó (epoll/eventfd) o ya se detuvo, connect() devuelve NO_CONNECTION y
+ *   submit() completa todo con NOT_CONNECTED al momento
+ */
+class PACIoEngine {
+public:
+    using ConnectionId = uint64_t;
+    static constexpr ConnectionId NO_CONNECTION = 0;
+
+    PACIoEngine();
+    ~PACIoEngine();
+    PACIoEngine(const PACIoEngine &) = delete;
+    PACIoEngine &operator=(const PACIoEngine &) = delete;
+
+    // Motor compartido por todos los clientes del proceso (se crea al primer uso); único
+    // dueño válido: su deleter nunca destruye el motor desde su propio hilo
+    static std::shared_ptr<PACIoEngine> shared();
+
+    // Conexión no bloqueante con timeout; NO_CONNECTION si falla. on_closed se invoca
+    // (en el hilo del motor) si la conexión se pierde, no al cerrarla con close()
+    ConnectionId connect(const std::string &ip, int port, std::chrono::milliseconds timeout,
+                         std::function<void()> on_closed = nullptr);
+    void close(ConnectionId id);
+
+    // Encola las solicitudes en orden; el future queda listo cuando se completó la última
+    std::future<void> submit(ConnectionId id, std::vector<IoRequest> &&requests);
+
+    // Descartar lo que haya en el stream antes del próximo envío
+    void discardInput(ConnectionId id);
+
+    size_t connectionCount() const { return open_connections.load(std::memory_order_relaxed); }
+
+    // Registrar las tramas de todas las conexiones en capture (nullptr la detiene)
+    void setCapture(std::shared_ptr<PacketCapture> capture);
+
+private:
+    struct Connection;
+
+    void run();
+    bool post(std::function<void()> task);   // false si el hilo no corre (la tarea se descarta)
+    void runPosted();
+
+    void startConnect(ConnectionId id, const std::string &ip, int port, std::chrono::milliseconds timeout,
+                      std::function<void()> on_closed, std::shared_ptr<std::promise<bool>> done);
+    void finishConnect(Connection &conn);
+    void enqueue(ConnectionId id, std::vector<IoRequest> &requests);
+    void drop(ConnectionId id, IoStatus status, bool notify);
+
+    void onSocket(Connection &conn, uint32_t events);
+    void onTimer(Connection &conn);
+    void onReadable(Connection &conn);
+    void deliver(Connection &conn);
+    void pump(Connection &conn);
+    void flushTx(Connection &conn);
+    void drainInput(Connection &conn);
+    void failPending(Connection &conn, IoStatus status);
+    void armHead(Connection &conn);
+    void armTimer(Connection &conn, std::chrono::milliseconds timeout);
+    void updateEvents(Connection &conn, uint32_t events);
+    void capturePacket(const Connection &conn, PacketRecordHeader::Kind kind, std::span<const uint8_t> frame,
+                       IoStatus status = IoStatus::OK, uint32_t count = 0);
+
+    int epoll_fd = -1;
+    int wake_fd = -1;       // eventfd: despierta al hilo cuando hay tareas publicadas
+    std::thread loop;
+    std::atomic<bool> stopping{false};
+
+    std::mutex posted_mutex;
+    std::vector<std::function<void()>> posted;
+    bool accepting = false;  // Bajo posted_mutex: el hilo corre y ejecutará lo publicado
+
+    // Sólo se tocan desde el hilo del motor
+    std::unordered_map<ConnectionId, std::unique_ptr<Connection>> connections;
+    std::atomic<ConnectionId> next_id{1};
+    std::atomic<size_t> open_connections{0};
+    std::shared_ptr<PacketCapture> packet_capture;
+};
+
+#endif // PAC_IO_ENGINE_H
@@ -0,0 +1,73 @@
+#ifndef PAC_PROTOCOL_H
+#define PAC_PROTOCOL_H
+
+#include <string>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Primitivas del protocolo PAC Control (reverse-engineered)
+ * Construcción de comandos y tamaños de trama compartidos por el cliente
+ */
+namespace pac_protocol {
+
+// Las respuestas binarias de tablas llevan un header de 2 bytes (00 00)
+constexpr size_t TABLE_HEADER_BYTES = 2;
+
+// Cada elemento de tabla (float o int32) ocupa 4 bytes little endian
+constexpr size_t TABLE_ELEMENT_BYTES = 4;
+
+// Comando de lectura de tabla: "<end_pos> <start_pos> }<tabla> TRange.\r"
+std::string buildTableReadCommand(const std::string& table_name, int start_pos, int end_pos);
+// Igual, pero añadido a un buffer existente (sin asignar si ya tiene capacidad)
+void appendTableReadCommand(std::string& out, const std::string& table_name, int start_pos, int end_pos);
+
+// Comandos de escritura (el PAC confirma cada uno con 2 bytes 00 00)
+// Tabla:      "<valor> <índice> }<tabla> TABLE!\r"  (float con 3 decimales fijos)
+// Individual: "<valor> ^<variable> @!\r"            (float con 7 cifras significativas)
+std::string buildTableWriteCommand(const std::string& table_name, int index, float value);
+std::string buildTableWriteCommand(const std::string& table_name, int index, int32_t value);
+std::string buildScalarWriteCommand(const std::string& variable_name, float value);
+std::string buildScalarWriteCommand(const std::string& variable_name, int32_t value);
+
+// Bytes de datos (sin header) que devuelve el PAC para el rango [start_pos, end_pos]
+size_t tableResponseBytes(int start_pos, int end_pos);
+
+// Decodificar payload binario little endian (sin header)
+std::vector<float> decodeFloatsLE(const std::vector<uint8_t>& data);
+std::vector<int32_t> decodeInt32sLE(const std::vector<uint8_t>& data);
+
+// Sin asignaciones: decodifica en el destino del llamador; devuelve los elementos escritos
+// (mín. entre elementos completos del payload y out.size())
+size_t decodeFloatsLE(std::span<const uint8_t> data, std::span<float> out);
+size_t decodeInt32sLE(std::span<const uint8_t> data, std::span<int32_t> out);
+
+// Decodificación masiva de floats con detección de lanes no finitos (Inf/NaN)
+// Kernel elegido en tiempo de ejecución: AVX2 → SSE2 → escalar (no x86 o sin soporte)
+enum class DecodeKernel { SCALAR = 0, SSE2 = 1, AVX2 = 2 };
+
+struct FloatDecodeResult {
+    size_t count = 0;        // Elementos escritos en out
+    size_t non_finite = 0;   // Cuántos de ellos son Inf/NaN
+};
+
+DecodeKernel activeDecodeKernel();                 // Mejor kernel soportado por la CPU
+const char* decodeKernelName(DecodeKernel kernel);
+
+// non_finite_flags (opcional): flags[i] = 1 si out[i] no es finito
+// kernel: forzar uno concreto (benchmarks); si la CPU no lo soporta se usa el activo
+FloatDecodeResult decodeFloatsChecked(std::span<const uint8_t> data, std::span<float> out,
+                                      std::span<uint8_t> non_finite_flags = {},
+                                      DecodeKernel kernel = activeDecodeKernel());
+
+// Respuestas ASCII de variables individuales ("1.234568e+03 " terminado en 0x20)
+std::string bytesToASCII(const std::vector<uint8_t>& bytes);       // Sólo imprimibles
+std::string cleanASCIINumber(const std::string& ascii_str);        // "0" si no queda un número válido
+float parseFloat(const std::string& str);                          // Notación científica; 0 si inválido/no finito
+int32_t parseInt32(const std::string& str);                        // Vía double; 0 si fuera de rango
+
+} // namespace pac_protocol
+
+#endif // PAC_PROTOCOL_H
@@ -0,0 +1,115 @@
+#ifndef PAC_SIMULATOR_H
+#define PAC_SIMULATOR_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <cstdint>
+#include <chrono>
+#include <nlohmann/json.hpp>
+
+// Opciones del simulador (latencias en microsegundos)
+struct PACSimulatorOptions {
+    std::string bind_address = "127.0.0.1";
+    int port = 22001;                  // 0 = puerto efímero (ver PACSimulator::port())
+    int latency_us = 0;                // Retardo de red por ráfaga recibida
+    int service_us = 0;                // Tiempo de proceso por comando
+    int jitter_us = 0;                 // ± aleatorio sobre latency_us y service_us
+    size_t fragment_bytes = 0;         // >0: las respuestas salen en trozos de este tamaño
+    int fragment_delay_us = 0;         // Pausa entre trozos
+    double churn = 0.0;                // Fracción de valores que cambia por segundo (0..1)
+    size_t default_table_size = 16;    // Elementos de una tabla creada bajo demanda
+    unsigned seed = 1;
+    // >=0: en cada TRange. el elemento de este índice de las tablas float lleva los ms
+    // transcurridos desde timestamp_epoch (edad del valor medible de extremo a extremo)
+    int timestamp_index = -1;
+    std::chrono::steady_clock::time_point timestamp_epoch{};
+};
+
+// Contadores del simulador
+struct PACSimulatorStats {
+    std::atomic<uint64_t> connections{0};
+    std::atomic<uint64_t> table_reads{0};
+    std::atomic<uint64_t> scalar_reads{0};
+    std::atomic<uint64_t> writes{0};
+    std::atomic<uint64_t> unknown_commands{0};
+    std::atomic<uint64_t> bytes_sent{0};
+};
+
+/**
+ * Sustituto local del PAC Opto22 para pruebas de carga sin hardware
+ * Habla el mismo protocolo que PACControlClient:
+ * - "<end> <start> }TABLA TRange."  → 00 00 + (end-start+1) elementos de 4 bytes LE
+ * - "^VAR @@ F." / "^VAR @@ ."      → número ASCII terminado en 0x20
+ * - "<v> ^VAR @!" / "<v> <i> }TABLA TABLE!" → 00 00
+ * Tablas y variables se generan desde tags.json; las tablas desconocidas se crean bajo demanda
+ */
+class PACSimulator {
+public:
+    explicit PACSimulator(const PACSimulatorOptions& options);
+    ~PACSimulator();
+
+    // Carga tablas (tbL_tags, tbl_api, tbl_batch, tbl_pid) y variables simples de tags.json
+    size_t loadTags(const nlohmann::json& tags);
+
+    void addTable(const std::string& name, size_t size, bool is_int32);
+    void addScalar(const std::string& name, bool is_int32);
+
+    bool start();
+    void stop();
+    int port() const { return bound_port; }
+
+    // Lectura directa del estado (para verificar escrituras en pruebas)
+    bool getTableBits(const std::string& name, size_t index, uint32_t& bits);
+    bool getScalarBits(const std::string& name, uint32_t& bits);
+
+    const PACSimulatorStats& getStats() const { return stats; }
+    size_t tableCount();
+    size_t scalarCount();
+
+private:
+    struct SimTable {
+        bool is_int32 = false;
+        std::vector<uint32_t> bits;    // Valores crudos (float o int32)
+    };
+    struct SimScalar {
+        bool is_int32 = false;
+        uint32_t bits = 0;
+    };
+
+    PACSimulatorOptions opts;
+    PACSimulatorStats stats;
+
+    std::mutex data_mutex;
+    std::unordered_map<std::string, SimTable> tables;
+    std::unordered_map<std::string, SimScalar> scalars;
+    std::vector<std::string> table_names;   // Para elegir tablas al azar en el churn
+    std::mt19937 churn_rng;
+
+    int listen_fd = -1;
+    int bound_port = 0;
+    std::atomic<bool> running{false};
+    std::thread accept_thread;
+    std::thread churn_thread;
+    std::mutex clients_mutex;
+    std::vector<std::thread> client_threads;
+    std::vector<int> client_fds;
+
+    void acceptLoop();
+    void clientLoop(int fd);
+    void churnLoop();
+
+    // Devuelve false si el comando no se reconoce (no se responde nada)
+    bool handleCommand(const std::string& command, std::string& reply);
+    SimTable& tableFor(const std::string& name, bool is_int32_hint);
+    uint32_t initialFloatBits(const std::string& name, size_t index) const;
+
+    void sleepJittered(int base_us, std::mt19937& rng);
+    bool sendReply(int fd, const std::string& reply);
+};
+
+#endif // PAC_SIMULATOR_H
@@ -0,0 +1,90 @@
+#ifndef PAC_WRITE_QUEUE_H
+#define PAC_WRITE_QUEUE_H
+
+#include "pac_connection_pool.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+// var_id de las escrituras sin variable propia (tramos de arrays de tabla)
+static constexpr uint32_t WRITE_NO_VARIABLE = UINT32_MAX;
+
+// Escritura de operador pendiente de enviar al PAC
+struct PACWriteRequest {
+    uint32_t var_id = 0;          // Id denso de la variable (clave de coalescencia)
+    string target;                // Tabla (TBL_xxx) o variable individual (F_xxx / I_xxx)
+    int index = -1;               // Índice en la tabla (primero del tramo); -1 = variable individual
+    bool is_int32 = false;
+    float float_value = 0.0f;
+    int32_t int_value = 0;
+    vector<float> float_range;    // Tramo desde index (arrays de tabla): un TABLE! por elemento
+    vector<int32_t> int_range;
+    chrono::steady_clock::time_point enqueued;
+
+    bool isRange() const { return !float_range.empty() || !int_range.empty(); }
+    size_t rangeLength() const { return is_int32 ? int_range.size() : float_range.size(); }
+};
+
+// Contadores expuestos como variables de estado
+struct PACWriteStats {
+    atomic<uint64_t> enqueued{0};
+    atomic<uint64_t> completed{0};
+    atomic<uint64_t> failed{0};
+    atomic<uint64_t> coalesced{0};   // Escrituras reemplazadas por otra posterior al mismo destino
+    atomic<uint64_t> batches{0};     // Pipelines con al menos una respuesta del PAC
+    atomic<uint32_t> pending{0};
+};
+
+/**
+ * Cola de escrituras asíncrona hacia la sesión dedicada de escritura del pool
+ * - push() encola sin locks (cola MPSC intrusiva) y nunca espera E/S: apto para el hilo del servidor OPC-UA;
+ *   sólo toma wake_mutex un instante para despertar al escritor, que duerme sin timeout
+ * - Un hilo escritor vacía la cola, coalesce por variable (gana el último valor)
+ *   y envía los comandos en lotes con una sola pasada de confirmaciones
+ * - Los tramos (isRange) no se coalescen y conservan su orden respecto al resto
+ * - El resultado de cada escritura se notifica con el callback de finalización
+ */
+class PACWriteQueue {
+public:
+    using CompletionHandler = function<void(const PACWriteRequest&, bool ok)>;
+
+    PACWriteQueue(PACConnectionPool& pool, CompletionHandler on_complete, size_t max_batch = 32);
+    ~PACWriteQueue();
+
+    void push(PACWriteRequest request);
+
+    const PACWriteStats& getStats() const { return stats; }
+
+private:
+    struct Node {
+        atomic<Node*> next{nullptr};
+        PACWriteRequest request;
+    };
+
+    // Cola MPSC (Vyukov): los productores sólo hacen exchange sobre head
+    atomic<Node*> head;
+    Node* tail;                   // Sólo lo toca el hilo escritor
+    Node stub;
+
+    void pushNode(Node* node);
+    Node* popNode();
+
+    PACConnectionPool& pool;
+    CompletionHandler on_complete;
+    size_t max_batch;
+    PACWriteStats stats;
+
+    thread writer_thread;
+    atomic<bool> stopping{false};
+    mutex wake_mutex;
+    condition_variable wake_cv;
+
+    void writerLoop();
+    size_t drainAndSubmit();     // Devuelve cuántas solicitudes sacó de la cola
+};
+
+#endif // PAC_WRITE_QUEUE_H
@@ -0,0 +1,95 @@
+#ifndef PACKET_CAPTURE_H
+#define PACKET_CAPTURE_H
+
+#include <string>
+#include <span>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+// ============== FORMATO DEL ARCHIVO ==============
+// [PacketCaptureHeader][área de registros de capacity bytes]
+// Cada registro: [PacketRecordHeader][length bytes de trama][relleno hasta múltiplo de 8]
+// El área es un anillo: los registros viven en [tail, head), o en [tail, wrap_end) + [0, head)
+// si dio la vuelta. Los campos del header se actualizan tras cada registro, así el archivo
+// es legible aunque el gateway muera (está mapeado MAP_SHARED: lo escribe el kernel)
+
+static constexpr char PACKET_CAPTURE_MAGIC[8] = {'P', 'A', 'C', 'C', 'A', 'P', '1', '\0'};
+static constexpr uint32_t PACKET_CAPTURE_VERSION = 1;
+static constexpr uint32_t PACKET_RECORD_MAGIC = 0x31544b50;   // "PKT1"
+
+struct PacketCaptureHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;     // Desplazamiento del área de registros
+    uint64_t capacity;        // Bytes del área de registros
+    uint64_t head;            // Siguiente escritura (relativo al área)
+    uint64_t tail;            // Registro más antiguo
+    uint64_t wrap_end;        // Fin de los registros antes de volver al principio
+    uint32_t wrapped;         // 1 = los registros siguen en [0, head) tras [tail, wrap_end)
+    uint32_t reserved;
+    uint64_t records;         // Registros escritos desde que se creó el archivo
+    uint64_t overwritten;     // Registros pisados al dar la vuelta
+};
+
+struct PacketRecordHeader {
+    enum Kind : uint8_t {
+        OPEN,       // Conexión establecida; la trama es "ip:puerto"
+        TX,         // Comando pasado al socket
+        RX,         // Respuesta enmarcada y entregada (sin el terminador si es ASCII)
+        DISCARD,    // Bytes residuales descartados tras un timeout o trama inválida
+        FAIL,       // Solicitudes pendientes abortadas; status = IoStatus, length = 0
+        CLOSE       // Conexión cerrada o perdida; status = IoStatus
+    };
+
+    uint32_t magic;
+    uint32_t length;          // Bytes de trama que siguen al header
+    int64_t wall_ns;          // system_clock (hora del registro)
+    int64_t mono_ns;          // steady_clock (diferencias entre registros)
+    uint64_t connection;      // PACIoEngine::ConnectionId
+    uint8_t kind;
+    uint8_t status;
+    uint16_t reserved;
+    uint32_t count;           // FAIL: solicitudes abortadas; resto 0
+};
+
+/**
+ * Captura de tramas PAC en un archivo anillo (opt-in: "packet_capture" en server_config)
+ * - La escribe el motor de E/S (PACIoEngine::setCapture) al enviar, enmarcar y abortar
+ * - Archivo de tamaño fijo mapeado en memoria: registrar es un memcpy, sin syscalls ni formato
+ * - Lleno: se pisan los registros más antiguos (el archivo guarda siempre lo último)
+ * - tools/pac_capture_decode lo lee y muestra los intercambios en hex/ASCII
+ */
+class PacketCapture {
+public:
+    // Crea (o trunca) el archivo con un área de capacity bytes; nullptr si no se puede
+    static std::unique_ptr<PacketCapture> create(const std::string &path, size_t capacity);
+    ~PacketCapture();
+    PacketCapture(const PacketCapture &) = delete;
+    PacketCapture &operator=(const PacketCapture &) = delete;
+
+    void record(PacketRecordHeader::Kind kind, uint64_t connection, std::span<const uint8_t> frame,
+                uint8_t status = 0, uint32_t count = 0);
+
+    const std::string &path() const { return file_path; }
+
+    // Recorre los registros de un archivo del más antiguo al más nuevo; false + error si no es válido
+    using Visitor = std::function<void(const PacketRecordHeader &, std::span<const uint8_t>)>;
+    static bool read(const std::string &path, const Visitor &visit, PacketCaptureHeader &header, std::string &error);
+
+private:
+    PacketCapture() = default;
+
+    void reserve(uint64_t size);
+
+    std::mutex write_mutex;     // Normalmente un solo escritor (el hilo del motor)
+    std::string file_path;
+    int fd = -1;
+    uint8_t *mapping = nullptr;
+    size_t mapping_size = 0;
+    PacketCaptureHeader *header = nullptr;
+    uint8_t *area = nullptr;
+};
+
+#endif // PACKET_CAPTURE_H
@@ -0,0 +1,115 @@
+#ifndef POLL_PLAN_H
+#define POLL_PLAN_H
+
+#include "common.h"
+#include "pac_control_client.h"
+#include <vector>
+#include <map>
+#include <mutex>
+#include <span>
+
+// Destino de un valor leído: variable OPC-UA y su índice dentro de la trama
+struct PollSlot {
+    Variable* var = nullptr;
+    uint32_t var_id = 0;          // Índice en config.variables (almacenes densos)
+    int index = 0;
+};
+
+// Lectura de tabla precompilada (una por tabla y clase de escaneo)
+struct TableReadDescriptor {
+    TableReadRequest request;     // Nombre, rango, tipo y comando TRange. ya formateado
+    size_t expected_bytes = 0;    // Bytes de datos esperados (sin cabecera)
+    size_t scan_class = 0;
+    size_t first_slot = 0;        // Destinos: PollPlan::slots[first_slot, first_slot + slot_count)
+    size_t slot_count = 0;
+    size_t value_offset = 0;      // Elementos: almacén float o int32 del plan [value_offset, +value_count)
+    size_t value_count = 0;
+    size_t source_id = 0;         // Fuente en el plan (= índice de tabla)
+};
+
+// Lectura escalar precompilada (F_xxx / I_xxx)
+struct ScalarReadDescriptor {
+    Variable* var = nullptr;
+    uint32_t var_id = 0;
+    size_t scan_class = 0;
+    size_t source_id = 0;         // Fuente en el plan (tableCount() + índice de escalar)
+};
+
+// Lote listo para PACConnectionPool::readCycle para un conjunto de clases vencidas
+struct PollBatch {
+    vector<TableReadRequest> tables;                  // Solicitudes, mismo orden que table_desc
+    vector<const TableReadDescriptor*> table_desc;
+    vector<pair<string, string>> scalars;             // {pac_source, "FLOAT"|"INT32"}
+    vector<const ScalarReadDescriptor*> scalar_desc;
+};
+
+/**
+ * Plan de sondeo compilado una sola vez desde config.variables
+ * - Sin parseo de pac_source ni mapas por ciclo: descriptores planos y contiguos
+ * - Los lotes por combinación de clases vencidas se construyen la primera vez y se reutilizan
+ * - Se reconstruye sólo cuando cambia la configuración (build())
+ * - Con clase de fondo (background_ms > 0) sólo las tablas/escalares con demanda se leen en su clase;
+ *   el resto se refresca en la clase de fondo (applyDemand() decide cuáles tienen demanda)
+ */
+class PollPlan {
+public:
+    // Compila el plan; los punteros a Variable deben seguir válidos hasta el próximo build()
+    // background_ms > 0 añade la clase de refresco de fondo para lo que no tiene demanda
+    // registry: interna cada tabla leída (request.table_id) con el tamaño que cubre el plan
+    // controller >= 0: sólo las variables de ese controlador (los ids siguen siendo globales)
+    void build(vector<Variable>& variables, int default_scan_ms, int background_ms = 0,
+               TableRegistry* registry = nullptr, int controller = -1);
+
+    // Demanda por variable (1 = vigilada, indexado por id): una tabla tiene demanda si alguno
+    // de sus destinos la tiene. Invalida los lotes cacheados; sin clase de fondo no hace nada
+    void applyDemand(const vector<uint8_t>& monitored_vars);
+
+    // Lote para las clases indicadas (índices ordenados como los devuelve PollScheduler)
+    const PollBatch& batchFor(vector<size_t> due_classes);
+
+    // Lote con todas las clases (actualización inmediata)
+    const PollBatch& fullBatch();
+
+    // Últimos valores decodificados de una tabla (el pipeline escribe aquí vía request.*_dest)
+    span<const float> floatValues(const TableReadDescriptor& desc) const;
+    span<const int32_t> int32Values(const TableReadDescriptor& desc) const;
+
+    // Fuentes de lectura: tablas [0, tableCount()) y escalares [tableCount(), sourceCount())
+    static constexpr size_t NO_SOURCE = static_cast<size_t>(-1);
+    size_t sourceCount() const { return tables.size() + scalars.size(); }
+    size_t sourceOf(uint32_t var_id) const;                      // NO_SOURCE si no está en el plan
+    const TableReadDescriptor* tableSource(size_t source) const;  // nullptr si es escalar
+    const ScalarReadDescriptor* scalarSource(size_t source) const;
+
+    const vector<int>& classPeriods() const { return class_periods; }
+    const vector<PollSlot>& getSlots() const { return slots; }
+    size_t tableCount() const { return tables.size(); }
+    size_t scalarCount() const { return scalars.size(); }
+    size_t demandedTables() const;
+    size_t demandedScalars() const;
+    bool hasBackgroundClass() const { return background_class != NO_CLASS; }
+    uint64_t generation() const { return build_generation; }
+
+private:
+    vector<int> class_periods;
+    vector<TableReadDescriptor> tables;
+    vector<ScalarReadDescriptor> scalars;
+    vector<PollSlot> slots;
+    vector<size_t> var_source;    // Fuente por id de variable
+
+    // Sondeo bajo demanda: 1 = leer en su clase, 0 = sólo en la clase de fondo
+    static constexpr size_t NO_CLASS = static_cast<size_t>(-1);
+    size_t background_class = NO_CLASS;
+    vector<uint8_t> table_demand;
+    vector<uint8_t> scalar_demand;
+
+    // Almacén de valores: un bloque contiguo por tipo, dimensionado una vez en build()
+    vector<float> float_values;
+    vector<int32_t> int_values;
+
+    map<vector<size_t>, PollBatch> batch_cache;
+    mutex cache_mutex;
+    uint64_t build_generation = 0;
+};
+
+#endif // POLL_PLAN_H
@@ -0,0 +1,49 @@
+#ifndef POLL_SCHEDULER_H
+#define POLL_SCHEDULER_H
+
+#include <vector>
+#include <queue>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+
+// Clase de escaneo: todos los tags con el mismo periodo comparten deadline
+struct ScanClass {
+    int period_ms = 2000;
+    std::chrono::steady_clock::time_point next_deadline;
+    uint64_t cycles = 0;          // Ciclos completados
+    uint64_t overruns = 0;        // Deadlines perdidos (el ciclo tardó más que el periodo)
+    double last_duration_ms = 0;  // Duración del último ciclo en el que participó
+};
+
+/**
+ * Planificador de lecturas por deadlines absolutos (cola de prioridad)
+ * - Cada clase se reprograma en deadline + periodo, sin deriva por latencia del PAC
+ * - Las clases que vencen juntas (dentro de la ventana de fusión) se leen en un solo lote
+ * - Si un ciclo se pasa del siguiente deadline se cuenta y se reporta como overrun
+ */
+class PollScheduler {
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit PollScheduler(const std::vector<int>& periods_ms, int merge_window_ms = 10);
+
+    // Bloquea hasta que venza al menos una clase (o keep_running pase a false)
+    // y devuelve los índices de las clases a leer en este lote
+    std::vector<size_t> waitForDue(const std::atomic<bool>& keep_running);
+
+    // Reprograma las clases leídas a partir de su deadline anterior
+    void complete(const std::vector<size_t>& classes, clock::time_point started, clock::time_point finished);
+
+    const std::vector<ScanClass>& getClasses() const { return classes; }
+    size_t size() const { return classes.size(); }
+
+private:
+    using Entry = std::pair<clock::time_point, size_t>;
+
+    std::vector<ScanClass> classes;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> due_queue;
+    std::chrono::milliseconds merge_window;
+};
+
+#endif // POLL_SCHEDULER_H
@@ -0,0 +1,59 @@
+#ifndef READ_THROUGH_CACHE_H
+#define READ_THROUGH_CACHE_H
+
+#include "common.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Contadores de la caché (expuestos en logs)
+struct ReadThroughStats {
+    std::atomic<uint64_t> hits{0};        // Lecturas servidas sin ir al PAC
+    std::atomic<uint64_t> fetches{0};     // Refrescos bajo demanda lanzados al PAC
+    std::atomic<uint64_t> coalesced{0};   // Lecturas viejas que encontraron un refresco ya en vuelo
+    std::atomic<uint64_t> failures{0};
+};
+
+/**
+ * Frescura de los valores publicados por fuente del plan (tabla o escalar)
+ * - Los valores viven en el espacio de direcciones; aquí sólo se guarda cuándo se leyó cada fuente
+ * - El hilo de sondeo marca las fuentes que lee en cada ciclo (markFresh)
+ * - Una lectura OPC-UA con la fuente más vieja que maxAge reserva su refresco (beginRefresh) y
+ *   responde con el valor actual; las siguientes sobre la misma fuente no lanzan otro mientras
+ *   ese siga en vuelo. beginRefresh/endRefresh son sólo del hilo del servidor
+ */
+class ReadThroughCache {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // Dimensiona para source_count fuentes, todas sin lectura ni refresco en vuelo
+    void reset(size_t source_count);
+
+    void markFresh(size_t source, clock::time_point read_at);
+
+    // true si la fuente se leyó hace max_age o menos (cuenta como acierto)
+    bool isFresh(size_t source, std::chrono::milliseconds max_age);
+
+    // true si alguna lectura de la fuente que empezó después de since ya la marcó fresca
+    bool readAfter(size_t source, clock::time_point since) const;
+
+    // true si el llamador debe lanzar el refresco; false si ya hay uno en vuelo (coalescido)
+    bool beginRefresh(size_t source);
+
+    // Fin de un refresco reservado: si ok, la fuente queda fresca desde started
+    void endRefresh(size_t source, bool ok, clock::time_point started);
+
+    const ReadThroughStats &getStats() const { return stats; }
+    size_t size() const { return count; }
+
+private:
+    size_t count = 0;
+    std::unique_ptr<std::atomic<int64_t>[]> read_at_ns;   // steady_clock en ns, 0 = nunca
+    std::unique_ptr<uint8_t[]> refreshing;                // 1 = refresco en vuelo (hilo del servidor)
+
+    ReadThroughStats stats;
+};
+
+#endif // READ_THROUGH_CACHE_H
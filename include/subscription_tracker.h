@@ -0,0 +1,43 @@
+#ifndef SUBSCRIPTION_TRACKER_H
+#define SUBSCRIPTION_TRACKER_H
+
+#include "common.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Variables con MonitoredItems activos (sondeo bajo demanda)
+ * - Contador por variable en un array denso indexado por id (índice en config.variables)
+ * - onRegister() se llama desde el hilo del servidor (monitoredItemRegisterCallback);
+ *   el hilo de sondeo sólo compara generation() y toma una instantánea cuando cambia
+ * - Varios clientes pueden vigilar la misma variable: deja de estar vigilada con el último
+ */
+class SubscriptionTracker {
+public:
+    // Dimensiona el almacén y olvida todas las suscripciones
+    void reset(size_t variable_count);
+
+    // Alta (removed = false) o baja de un MonitoredItem sobre la variable id
+    void onRegister(uint32_t id, bool removed);
+
+    bool isMonitored(uint32_t id) const;
+
+    // Cambia con cada transición vigilada ↔ no vigilada de alguna variable
+    uint64_t generation() const { return changes.load(std::memory_order_acquire); }
+
+    // Marca por variable (1 = vigilada) para PollPlan::applyDemand
+    std::vector<uint8_t> snapshot() const;
+
+    size_t monitoredCount() const { return monitored.load(std::memory_order_relaxed); }
+    size_t size() const { return count; }
+
+private:
+    size_t count = 0;
+    std::unique_ptr<std::atomic<uint32_t>[]> items;    // MonitoredItems por variable
+    std::atomic<size_t> monitored{0};                  // Variables con al menos uno
+    std::atomic<uint64_t> changes{0};
+};
+
+#endif // SUBSCRIPTION_TRACKER_H
@@ -0,0 +1,55 @@
+#ifndef TABLE_CACHE_H
+#define TABLE_CACHE_H
+
+#include "table_registry.h"
+#include <vector>
+#include <span>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Caché de contenidos de tabla en un único bloque contiguo (estructura de arrays)
+ * - Un tramo por tabla internada: [offset(id), offset(id) + size(id))
+ * - Por elemento: bits del valor (float o int32), instante de lectura y validez
+ * - Consultas por id + índice: sin strings, árboles ni vectores por entrada
+ * - Sin sincronización propia: el dueño (PACControlClient) la usa bajo su comm_mutex
+ */
+class TableCache {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // Reserva un tramo por tabla del registro y descarta todo lo cacheado
+    void layout(const TableRegistry &registry);
+
+    // true si [start, end] está entero, válido y leído en not_before o después; copia a out
+    // (el llamador calcula now - max_age una vez para todo un lote de consultas)
+    bool getFloats(TableId id, int start, int end, std::span<float> out, clock::time_point not_before) const;
+    bool getInt32s(TableId id, int start, int end, std::span<int32_t> out, clock::time_point not_before) const;
+
+    // Guarda values a partir de start (lo que no cabe en el tramo de la tabla se ignora)
+    void putFloats(TableId id, int start, std::span<const float> values, clock::time_point read_at);
+    void putInt32s(TableId id, int start, std::span<const int32_t> values, clock::time_point read_at);
+
+    void invalidate(TableId id);
+    void invalidate(TableId id, int index);
+    void clear();
+
+    size_t tableCount() const { return table_offset.size(); }
+    size_t capacity() const { return values.size(); }
+
+private:
+    // Posición en el bloque de [start, start + count) de la tabla; false si se sale del tramo
+    bool locate(TableId id, int start, size_t count, size_t &offset) const;
+
+    bool get(TableId id, int start, int end, void *out, size_t out_count, clock::time_point not_before) const;
+    void put(TableId id, int start, const void *bits, size_t count, clock::time_point read_at);
+
+    std::vector<uint32_t> table_offset;
+    std::vector<uint32_t> table_size;
+
+    std::vector<uint32_t> values;   // Bits IEEE 754 o int32
+    std::vector<int64_t> read_ns;   // steady_clock en ns
+    std::vector<uint8_t> valid;
+};
+
+#endif // TABLE_CACHE_H
@@ -0,0 +1,45 @@
+#ifndef TABLE_REGISTRY_H
+#define TABLE_REGISTRY_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+
+// Id denso de tabla PAC (índice en TableRegistry)
+using TableId = uint32_t;
+constexpr TableId NO_TABLE = static_cast<TableId>(-1);
+
+/**
+ * Nombres de tabla PAC internados a ids densos al cargar la configuración
+ * - find() busca por string_view: sin construir strings ni asignar memoria por consulta
+ * - size(id) es el número de elementos conocidos (mayor índice configurado + 1),
+ *   lo que usa TableCache para reservar un bloque por tabla
+ */
+class TableRegistry {
+public:
+    // Devuelve el id de la tabla (nuevo o existente) y amplía su tamaño a min_size si hace falta
+    TableId intern(std::string_view name, uint32_t min_size = 0);
+
+    TableId find(std::string_view name) const;
+
+    const std::string &name(TableId id) const { return names[id]; }
+    uint32_t size(TableId id) const { return sizes[id]; }
+    size_t count() const { return names.size(); }
+
+    void clear();
+
+private:
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+
+    std::vector<std::string> names;
+    std::vector<uint32_t> sizes;
+    std::unordered_map<std::string, TableId, NameHash, std::equal_to<>> ids;
+};
+
+#endif // TABLE_REGISTRY_H
@@ -0,0 +1,84 @@
+#ifndef VALUE_STORE_H
+#define VALUE_STORE_H
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <bit>
+
+// Un valor publicado tal como lo ve quien vuelca al espacio de direcciones
+struct PublishedValue {
+    uint32_t id;              // Id denso de la variable (índice en config.variables)
+    bool is_int32;
+    uint32_t bits;            // float o int32 según is_int32
+    int64_t read_at_ns;       // system_clock: cuándo se leyó del PAC (sourceTimestamp)
+
+    float asFloat() const { float v; std::memcpy(&v, &bits, sizeof(v)); return v; }
+    int32_t asInt32() const { int32_t v; std::memcpy(&v, &bits, sizeof(v)); return v; }
+};
+
+/**
+ * Valores leídos del PAC en camino al espacio de direcciones
+ * - Un slot por variable con su seqlock: los hilos de sondeo (uno por PAC) y la lectura bajo
+ *   demanda publican sin locks; el lector reintenta si cruza una escritura
+ * - Publicar marca la variable en un bitmap de pendientes (un fetch_or por valor)
+ * - drain() lo llama sólo el hilo del servidor: toma los pendientes palabra a palabra y entrega
+ *   la última versión de cada uno. Varias publicaciones entre dos drain() se funden en una
+ * - Los hilos de sondeo nunca tocan nodos y el servidor nunca espera al sondeo
+ */
+class ValueStore {
+public:
+    // Dimensiona el almacén y descarta lo pendiente (no concurrente con publish/drain)
+    void reset(size_t variable_count);
+
+    void publishFloat(uint32_t id, float value, int64_t read_at_ns);
+    void publishInt32(uint32_t id, int32_t value, int64_t read_at_ns);
+
+    // Entrega cada valor pendiente a apply(const PublishedValue &); devuelve cuántos entregó
+    template <typename Apply>
+    size_t drain(Apply &&apply);
+
+    size_t size() const { return count; }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence{0};   // Impar = escritura en curso
+        std::atomic<uint32_t> bits{0};
+        std::atomic<uint8_t> is_int32{0};
+        std::atomic<int64_t> read_at_ns{0};
+    };
+
+    void publish(uint32_t id, uint32_t bits, bool is_int32, int64_t read_at_ns);
+    PublishedValue load(uint32_t id) const;
+
+    size_t count = 0;
+    size_t words = 0;
+    std::unique_ptr<Slot[]> slots;
+    std::unique_ptr<std::atomic<uint64_t>[]> pending;   // Bit por variable publicada y no volcada
+};
+
+template <typename Apply>
+size_t ValueStore::drain(Apply &&apply)
+{
+    size_t applied = 0;
+    for (size_t w = 0; w < words; w++)
+    {
+        // Palabras limpias sin escritura: el caso normal entre ciclos
+        if (pending[w].load(std::memory_order_relaxed) == 0)
+            continue;
+
+        uint64_t bits = pending[w].exchange(0, std::memory_order_acquire);
+        while (bits)
+        {
+            int bit = std::countr_zero(bits);
+            bits &= bits - 1;
+            apply(load((uint32_t)(w * 64 + bit)));
+            applied++;
+        }
+    }
+    return applied;
+}
+
+#endif // VALUE_STORE_H
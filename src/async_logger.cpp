@@ -0,0 +1,565 @@
+#include "async_logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+using namespace std;
+
+// ============== ANILLOS POR HILO ==============
+
+static constexpr size_t RING_BYTES = 256 * 1024;          // Por hilo (potencia de 2)
+static constexpr size_t STAGING_RESERVE = 1024;
+static constexpr auto SINK_PERIOD = chrono::milliseconds(20);
+
+// Cabecera de cada registro en el anillo; le siguen los argumentos codificados
+struct RecordHeader {
+    uint32_t size;          // Cabecera incluida
+    LogLevel level;
+    LogModule module;
+    uint16_t reserved;
+    uint32_t suppressed;    // Repeticiones descartadas antes de éste (límite por punto de log)
+    int64_t wall_ns;        // system_clock: lo que se imprime y el orden entre hilos
+};
+
+// Anillo SPSC: escribe sólo su hilo, lee sólo el sumidero
+struct AsyncLogger::Ring {
+    unique_ptr<uint8_t[]> data{new uint8_t[RING_BYTES]};
+    atomic<size_t> head{0};     // Bytes publicados (productor)
+    atomic<size_t> tail{0};     // Bytes consumidos (sumidero)
+    atomic<bool> retired{false};
+
+    bool push(const uint8_t *record, size_t size)
+    {
+        size_t h = head.load(memory_order_relaxed);
+        if (RING_BYTES - (h - tail.load(memory_order_acquire)) < size)
+            return false;
+
+        size_t at = h & (RING_BYTES - 1);
+        size_t first = min(size, RING_BYTES - at);
+        memcpy(&data[at], record, first);
+        memcpy(&data[0], record + first, size - first);
+        head.store(h + size, memory_order_release);
+        return true;
+    }
+
+    void copyOut(size_t from, uint8_t *out, size_t size) const
+    {
+        size_t at = from & (RING_BYTES - 1);
+        size_t first = min(size, RING_BYTES - at);
+        memcpy(out, &data[at], first);
+        memcpy(out + first, &data[0], size - first);
+    }
+};
+
+// Tras destruirse el logger (destructores estáticos) o el estado del hilo, se escribe directo
+static atomic<bool> logger_destroyed{false};
+static thread_local bool thread_log_destroyed = false;
+
+// Estado de logging de un hilo: su anillo y el registro que se está codificando
+struct AsyncLogger::ThreadLog {
+    shared_ptr<Ring> ring;
+    vector<uint8_t> staging;
+
+    ThreadLog() { staging.reserve(STAGING_RESERVE); }
+    ~ThreadLog()
+    {
+        // El sumidero drena lo que quede y suelta el anillo
+        if (ring)
+            ring->retired.store(true, memory_order_release);
+        thread_log_destroyed = true;
+    }
+};
+
+static AsyncLogger::ThreadLog *threadLog()
+{
+    static thread_local AsyncLogger::ThreadLog log;
+    if (thread_log_destroyed || logger_destroyed.load(memory_order_acquire))
+        return nullptr;
+    return &log;
+}
+
+// ============== NIVELES Y LÍMITES ==============
+
+#ifdef VERBOSE_DEBUG
+static constexpr uint8_t DEFAULT_LEVEL = static_cast<uint8_t>(LogLevel::Debug);
+#else
+static constexpr uint8_t DEFAULT_LEVEL = static_cast<uint8_t>(LogLevel::Info);
+#endif
+
+atomic<uint8_t> AsyncLogger::levels[static_cast<size_t>(LogModule::Count)] = {
+    DEFAULT_LEVEL, DEFAULT_LEVEL, DEFAULT_LEVEL, DEFAULT_LEVEL, DEFAULT_LEVEL};
+atomic<uint32_t> AsyncLogger::rate_burst{5};
+atomic<int64_t> AsyncLogger::rate_window_ns{10'000'000'000};
+
+static const char *MODULE_NAMES[] = {"general", "server", "pac", "poll", "write"};
+static const char *LEVEL_NAMES[] = {"error", "warning", "info", "debug"};
+
+const char *AsyncLogger::moduleName(LogModule module)
+{
+    return MODULE_NAMES[static_cast<size_t>(module)];
+}
+
+const char *AsyncLogger::levelName(LogLevel level)
+{
+    return LEVEL_NAMES[static_cast<size_t>(level)];
+}
+
+void AsyncLogger::setLevel(LogModule module, LogLevel level)
+{
+    levels[static_cast<size_t>(module)].store(static_cast<uint8_t>(level), memory_order_relaxed);
+}
+
+void AsyncLogger::setLevel(LogLevel level)
+{
+    for (auto &moduleLevel : levels)
+        moduleLevel.store(static_cast<uint8_t>(level), memory_order_relaxed);
+}
+
+LogLevel AsyncLogger::level(LogModule module)
+{
+    return static_cast<LogLevel>(levels[static_cast<size_t>(module)].load(memory_order_relaxed));
+}
+
+static bool parseLevel(string_view name, LogLevel &level)
+{
+    for (size_t l = 0; l < size(LEVEL_NAMES); l++)
+    {
+        if (name == LEVEL_NAMES[l])
+        {
+            level = static_cast<LogLevel>(l);
+            return true;
+        }
+    }
+    if (name == "warn")
+    {
+        level = LogLevel::Warning;
+        return true;
+    }
+    return false;
+}
+
+bool AsyncLogger::applyLevelSpec(string_view spec)
+{
+    // Validar todo antes de aplicar nada: una especificación errónea no deja niveles a medias
+    vector<pair<int, LogLevel>> changes;   // -1 = todos los subsistemas
+    while (!spec.empty())
+    {
+        size_t comma = spec.find(',');
+        string_view item = spec.substr(0, comma);
+        spec = comma == string_view::npos ? string_view() : spec.substr(comma + 1);
+
+        while (!item.empty() && item.front() == ' ')
+            item.remove_prefix(1);
+        while (!item.empty() && item.back() == ' ')
+            item.remove_suffix(1);
+        if (item.empty())
+            continue;
+
+        LogLevel level;
+        size_t eq = item.find('=');
+        if (eq == string_view::npos)
+        {
+            if (!parseLevel(item, level))
+                return false;
+            changes.emplace_back(-1, level);
+            continue;
+        }
+
+        string_view module = item.substr(0, eq);
+        auto it = find_if(begin(MODULE_NAMES), end(MODULE_NAMES), [&](const char *name) { return module == name; });
+        if (it == end(MODULE_NAMES) || !parseLevel(item.substr(eq + 1), level))
+            return false;
+        changes.emplace_back((int)(it - begin(MODULE_NAMES)), level);
+    }
+
+    for (const auto &[module, level] : changes)
+    {
+        if (module < 0)
+            setLevel(level);
+        else
+            setLevel(static_cast<LogModule>(module), level);
+    }
+    return true;
+}
+
+string AsyncLogger::levelSpec()
+{
+    string spec;
+    for (size_t m = 0; m < size(MODULE_NAMES); m++)
+    {
+        if (!spec.empty())
+            spec += ',';
+        spec += MODULE_NAMES[m];
+        spec += '=';
+        spec += levelName(level(static_cast<LogModule>(m)));
+    }
+    return spec;
+}
+
+void AsyncLogger::setRateLimit(uint32_t burst, chrono::milliseconds window)
+{
+    rate_burst.store(burst, memory_order_relaxed);
+    rate_window_ns.store(chrono::duration_cast<chrono::nanoseconds>(window).count(), memory_order_relaxed);
+}
+
+bool AsyncLogger::admit(LogSite &site, uint32_t &suppressed)
+{
+    uint32_t burst = rate_burst.load(memory_order_relaxed);
+    if (burst == 0)
+        return true;
+
+    int64_t now = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t start = site.window_start_ns.load(memory_order_relaxed);
+    if (now - start >= rate_window_ns.load(memory_order_relaxed) &&
+        site.window_start_ns.compare_exchange_strong(start, now, memory_order_relaxed))
+    {
+        site.in_window.store(0, memory_order_relaxed);
+    }
+
+    if (site.in_window.fetch_add(1, memory_order_relaxed) >= burst)
+    {
+        site.suppressed.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    suppressed = site.suppressed.exchange(0, memory_order_relaxed);
+    return true;
+}
+
+// ============== FORMATO (HILO SUMIDERO) ==============
+
+static const char *LEVEL_PREFIX[] = {
+    "\033[31m❌ [ERROR] \033[0m",
+    "\033[33m⚠️  [WARN]  \033[0m",
+    "\033[36mℹ️  [INFO]  \033[0m",
+    "\033[34m🔧 [DEBUG] \033[0m",
+};
+
+template <typename T>
+static T readValue(const uint8_t *&p)
+{
+    T value;
+    memcpy(&value, p, sizeof value);
+    p += sizeof value;
+    return value;
+}
+
+// Decodifica un registro y lo añade a out como una línea
+static void formatRecord(const uint8_t *record, string &out)
+{
+    RecordHeader header;
+    memcpy(&header, record, sizeof header);
+
+    time_t seconds = (time_t)(header.wall_ns / 1'000'000'000);
+    struct tm local;
+    localtime_r(&seconds, &local);
+    char stamp[32];
+    snprintf(stamp, sizeof stamp, "%02d:%02d:%02d.%03d ", local.tm_hour, local.tm_min, local.tm_sec,
+             (int)(header.wall_ns / 1'000'000 % 1000));
+
+    ostringstream line;
+    const uint8_t *p = record + sizeof header;
+    const uint8_t *end = record + header.size;
+    while (p < end)
+    {
+        auto tag = static_cast<LogLine::Tag>(*p++);
+        switch (tag)
+        {
+        case LogLine::STR:
+        {
+            uint32_t size = readValue<uint32_t>(p);
+            line.write(reinterpret_cast<const char *>(p), size);
+            p += size;
+            break;
+        }
+        case LogLine::CHAR:
+            line << readValue<char>(p);
+            break;
+        case LogLine::BOOL:
+            line << (bool)readValue<uint8_t>(p);
+            break;
+        case LogLine::I64:
+            line << readValue<int64_t>(p);
+            break;
+        case LogLine::U64:
+            line << readValue<uint64_t>(p);
+            break;
+        case LogLine::F32:
+            line << readValue<float>(p);
+            break;
+        case LogLine::F64:
+            line << readValue<double>(p);
+            break;
+        case LogLine::PTR:
+            line << readValue<const void *>(p);
+            break;
+        case LogLine::IOS_MANIP:
+            line << readValue<ios_base &(*)(ios_base &)>(p);
+            break;
+        case LogLine::OS_MANIP:
+            line << readValue<ostream &(*)(ostream &)>(p);
+            break;
+        case LogLine::SETW:
+            line << setw(readValue<int32_t>(p));
+            break;
+        case LogLine::SETFILL:
+            line << setfill(readValue<char>(p));
+            break;
+        case LogLine::SETPRECISION:
+            line << setprecision(readValue<int32_t>(p));
+            break;
+        default:
+            p = end;   // Registro corrupto: no debería ocurrir
+            break;
+        }
+    }
+
+    out += stamp;
+    out += LEVEL_PREFIX[static_cast<size_t>(header.level)];
+    if (header.module != LogModule::General)
+    {
+        out += '(';
+        out += AsyncLogger::moduleName(header.module);
+        out += ") ";
+    }
+    out += line.str();
+    if (header.suppressed > 0)
+        out += " (⏸️ " + to_string(header.suppressed) + " repeticiones suprimidas)";
+    out += '\n';
+}
+
+// ============== LOGGER ==============
+
+AsyncLogger::AsyncLogger()
+{
+    sink = thread(&AsyncLogger::sinkLoop, this);
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    {
+        lock_guard<mutex> lock(wake_mutex);
+        stopping.store(true);
+        wake_requested = true;
+    }
+    wake_cv.notify_one();
+    if (sink.joinable())
+        sink.join();
+    logger_destroyed.store(true, memory_order_release);
+}
+
+AsyncLogger &AsyncLogger::instance()
+{
+    static AsyncLogger logger;
+    return logger;
+}
+
+shared_ptr<AsyncLogger::Ring> AsyncLogger::registerThread()
+{
+    auto ring = make_shared<Ring>();
+    lock_guard<mutex> lock(rings_mutex);
+    rings.push_back(ring);
+    return ring;
+}
+
+void AsyncLogger::publish(ThreadLog &log, const uint8_t *record, size_t size, LogLevel level)
+{
+    if (!log.ring)
+        log.ring = registerThread();
+
+    if (!log.ring->push(record, size))
+    {
+        dropped_records.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+
+    // Los errores salen sin esperar al periodo del sumidero; el resto se agrupa salvo que
+    // el anillo vaya por la mitad (una ráfaga no debe llenarlo antes de la próxima pasada)
+    bool half_full = log.ring->head.load(memory_order_relaxed) - log.ring->tail.load(memory_order_relaxed) > RING_BYTES / 2;
+    if (level == LogLevel::Error || (half_full && !wake_pending.exchange(true, memory_order_relaxed)))
+    {
+        {
+            lock_guard<mutex> lock(wake_mutex);
+            wake_requested = true;
+        }
+        wake_cv.notify_one();
+    }
+}
+
+// Una pasada: drena todos los anillos, ordena por instante y escribe de una vez
+bool AsyncLogger::drainOnce()
+{
+    vector<shared_ptr<Ring>> snapshot;
+    {
+        lock_guard<mutex> lock(rings_mutex);
+        snapshot = rings;
+    }
+
+    struct Pending {
+        int64_t wall_ns;
+        size_t ring;
+        size_t offset;      // En records
+    };
+    static thread_local vector<uint8_t> records;
+    static thread_local vector<Pending> pending;
+    static thread_local string text;
+    records.clear();
+    pending.clear();
+    text.clear();
+
+    vector<bool> retired(snapshot.size());
+    for (size_t r = 0; r < snapshot.size(); r++)
+    {
+        Ring &ring = *snapshot[r];
+        retired[r] = ring.retired.load(memory_order_acquire);   // Antes de leer head: nada más llegará
+        size_t tail = ring.tail.load(memory_order_relaxed);
+        size_t head = ring.head.load(memory_order_acquire);
+        while (tail < head)
+        {
+            uint32_t size;
+            ring.copyOut(tail, reinterpret_cast<uint8_t *>(&size), sizeof size);
+            size_t offset = records.size();
+            records.resize(offset + size);
+            ring.copyOut(tail, &records[offset], size);
+
+            RecordHeader header;
+            memcpy(&header, &records[offset], sizeof header);
+            pending.push_back({header.wall_ns, r, offset});
+            tail += size;
+        }
+        ring.tail.store(tail, memory_order_release);
+    }
+
+    // Anillos de hilos terminados y ya vacíos
+    if (any_of(retired.begin(), retired.end(), [](bool r) { return r; }))
+    {
+        lock_guard<mutex> lock(rings_mutex);
+        rings.erase(remove_if(rings.begin(), rings.end(),
+                              [](const shared_ptr<Ring> &ring) {
+                                  return ring->retired.load(memory_order_acquire) &&
+                                         ring->tail.load(memory_order_relaxed) == ring->head.load(memory_order_acquire);
+                              }),
+                    rings.end());
+    }
+
+    // Descartes por anillo lleno desde la pasada anterior
+    uint64_t dropped_now = dropped_records.load(memory_order_relaxed);
+    if (dropped_now != dropped_reported)
+    {
+        text += "\033[33m⚠️  [WARN]  \033[0m" + to_string(dropped_now - dropped_reported) +
+                " mensajes de log descartados (anillo lleno)\n";
+        dropped_reported = dropped_now;
+    }
+
+    if (pending.empty() && text.empty())
+        return false;
+
+    stable_sort(pending.begin(), pending.end(),
+                [](const Pending &a, const Pending &b) { return a.wall_ns < b.wall_ns; });
+    for (const Pending &entry : pending)
+        formatRecord(&records[entry.offset], text);
+
+    fwrite(text.data(), 1, text.size(), stdout);
+    fflush(stdout);
+    return true;
+}
+
+void AsyncLogger::sinkLoop()
+{
+    while (true)
+    {
+        bool stop;
+        {
+            unique_lock<mutex> lock(wake_mutex);
+            wake_cv.wait_for(lock, SINK_PERIOD, [this] { return wake_requested; });
+            wake_requested = false;
+            wake_pending.store(false, memory_order_relaxed);
+            stop = stopping.load();
+        }
+
+        drainOnce();
+
+        {
+            lock_guard<mutex> lock(wake_mutex);
+            passes++;
+        }
+        drained_cv.notify_all();
+
+        if (stop)
+            break;
+    }
+
+    // Lo publicado durante la última pasada
+    drainOnce();
+}
+
+void AsyncLogger::flush()
+{
+    unique_lock<mutex> lock(wake_mutex);
+    if (stopping.load())
+        return;
+
+    // Una pasada completa que empiece después de esta llamada
+    uint64_t target = passes + 2;
+    wake_requested = true;
+    wake_cv.notify_one();
+    drained_cv.wait(lock, [&] { return passes >= target || stopping.load(); });
+}
+
+// ============== CODIFICACIÓN (HILO QUE LOGUEA) ==============
+
+LogLine::LogLine(LogModule module, LogLevel level, uint32_t suppressed) : log(threadLog()), level(level)
+{
+    if (!log)
+    {
+        detached = make_unique<AsyncLogger::ThreadLog>();
+        log = detached.get();
+    }
+
+    // Mensajes anidados (un argumento que a su vez loguea) se codifican a continuación
+    start = log->staging.size();
+    RecordHeader header{};
+    header.level = level;
+    header.module = module;
+    header.suppressed = suppressed;
+    header.wall_ns = chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    log->staging.resize(start + sizeof header);
+    memcpy(&log->staging[start], &header, sizeof header);
+}
+
+LogLine::~LogLine()
+{
+    size_t size = log->staging.size() - start;
+    uint32_t size32 = (uint32_t)size;
+    memcpy(&log->staging[start], &size32, sizeof size32);
+
+    if (!detached)
+    {
+        AsyncLogger::instance().publish(*log, &log->staging[start], size, level);
+        log->staging.resize(start);
+        return;
+    }
+
+    string text;
+    formatRecord(&log->staging[start], text);
+    fwrite(text.data(), 1, text.size(), stdout);
+}
+
+LogLine &LogLine::str(const char *text, size_t size)
+{
+    uint32_t size32 = (uint32_t)size;
+    size_t at = log->staging.size();
+    log->staging.resize(at + 1 + sizeof size32 + size);
+    log->staging[at] = STR;
+    memcpy(&log->staging[at + 1], &size32, sizeof size32);
+    memcpy(&log->staging[at + 1 + sizeof size32], text, size);
+    return *this;
+}
+
+LogLine &LogLine::put(Tag tag, const void *value, size_t size)
+{
+    size_t at = log->staging.size();
+    log->staging.resize(at + 1 + size);
+    log->staging[at] = tag;
+    memcpy(&log->staging[at + 1], value, size);
+    return *this;
+}
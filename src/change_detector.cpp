@@ -0,0 +1,67 @@
+#include "change_detector.h"
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+void ChangeDetector::reset(size_t variable_count)
+{
+    count = variable_count;
+    last_bits.assign(variable_count, 0);
+    valid.reset(new atomic<uint8_t>[variable_count]);
+    for (size_t i = 0; i < variable_count; i++)
+        valid[i].store(0, memory_order_relaxed);
+}
+
+bool ChangeDetector::acceptFloat(uint32_t id, float value, const Deadband &deadband)
+{
+    if (id >= count)
+        return true;
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    if (valid[id].load(memory_order_acquire))
+    {
+        if (bits == last_bits[id])
+            return false;
+
+        float last;
+        memcpy(&last, &last_bits[id], sizeof(last));
+
+        // Con banda y ambos valores finitos: descartar cambios dentro de la banda
+        if (deadband.value > 0.0 && isfinite(value) && isfinite(last))
+        {
+            double delta = fabs((double)value - (double)last);
+            double limit = deadband.mode == Deadband::PERCENT
+                               ? fabs((double)last) * deadband.value / 100.0
+                               : deadband.value;
+            if (delta <= limit)
+                return false;
+        }
+    }
+
+    last_bits[id] = bits;
+    valid[id].store(1, memory_order_release);
+    return true;
+}
+
+bool ChangeDetector::acceptInt32(uint32_t id, int32_t value)
+{
+    if (id >= count)
+        return true;
+
+    uint32_t bits = (uint32_t)value;
+    if (valid[id].load(memory_order_acquire) && bits == last_bits[id])
+        return false;
+
+    last_bits[id] = bits;
+    valid[id].store(1, memory_order_release);
+    return true;
+}
+
+void ChangeDetector::invalidate(uint32_t id)
+{
+    if (id < count)
+        valid[id].store(0, memory_order_release);
+}
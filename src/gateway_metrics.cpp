@@ -0,0 +1,243 @@
+#include "gateway_metrics.h"
+#include <algorithm>
+#include <sstream>
+#include <bit>
+
+using namespace std;
+
+// ============== HISTOGRAMA ==============
+
+size_t LatencyHistogram::bucketOf(uint64_t micros)
+{
+    if (micros < SUB_BUCKETS)
+        return (size_t)micros;
+
+    // Octava (bit más alto) + los SUB_BITS bits siguientes como sub-cubeta
+    int msb = 63 - countl_zero(micros);
+    if (msb >= MAX_BITS)
+        return BUCKETS - 1;
+
+    int shift = msb - SUB_BITS;
+    return SUB_BUCKETS * (size_t)(shift + 1) + (size_t)((micros >> shift) - SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::bucketUpper(size_t bucket)
+{
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+
+    int shift = (int)(bucket / SUB_BUCKETS) - 1;
+    uint64_t lower = (uint64_t)(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    return lower + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t micros)
+{
+    buckets[bucketOf(micros)].fetch_add(1, memory_order_relaxed);
+    total.fetch_add(1, memory_order_relaxed);
+    sum_us.fetch_add(micros, memory_order_relaxed);
+
+    uint64_t seen = max_us.load(memory_order_relaxed);
+    while (micros > seen && !max_us.compare_exchange_weak(seen, micros, memory_order_relaxed))
+    {
+    }
+}
+
+uint64_t LatencyHistogram::percentile(double q) const
+{
+    // Las cubetas se leen sin detener a los escritores: el total se recuenta sobre ellas
+    uint64_t counted = 0;
+    for (const auto &bucket : buckets)
+        counted += bucket.load(memory_order_relaxed);
+    if (counted == 0)
+        return 0;
+
+    uint64_t rank = (uint64_t)(clamp(q, 0.0, 1.0) * (double)(counted - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < BUCKETS; b++)
+    {
+        seen += buckets[b].load(memory_order_relaxed);
+        if (seen >= rank)
+            return min(bucketUpper(b), max());
+    }
+    return max();
+}
+
+// ============== REGISTRO ==============
+
+TableMetrics &PACMetrics::table(string_view name)
+{
+    lock_guard<mutex> lock(tables_mutex);
+
+    auto it = by_name.find(name);
+    if (it != by_name.end())
+        return *it->second;
+
+    TableMetrics &table = tables.emplace_back();
+    table.name = string(name);
+    by_name.emplace(table.name, &table);
+    return table;
+}
+
+vector<const TableMetrics *> PACMetrics::tableList() const
+{
+    lock_guard<mutex> lock(tables_mutex);
+
+    vector<const TableMetrics *> list;
+    list.reserve(tables.size());
+    for (const auto &table : tables)
+        list.push_back(&table);
+    return list;
+}
+
+GatewayMetrics &GatewayMetrics::instance()
+{
+    static GatewayMetrics metrics;
+    return metrics;
+}
+
+PACMetrics &GatewayMetrics::pac(const string &ip, int port)
+{
+    string label = ip + ":" + to_string(port);
+    lock_guard<mutex> lock(pacs_mutex);
+
+    for (auto &entry : pacs)
+    {
+        if (entry.pac == label)
+            return entry;
+    }
+
+    PACMetrics &entry = pacs.emplace_back();
+    entry.pac = label;
+    return entry;
+}
+
+vector<const PACMetrics *> GatewayMetrics::pacList() const
+{
+    lock_guard<mutex> lock(pacs_mutex);
+
+    vector<const PACMetrics *> list;
+    for (const auto &entry : pacs)
+        list.push_back(&entry);
+    return list;
+}
+
+// ============== FORMATO PROMETHEUS ==============
+
+// Valor de etiqueta con \, " y salto de línea escapados
+static string labelValue(const string &value)
+{
+    string out;
+    out.reserve(value.size());
+    for (char c : value)
+    {
+        if (c == '\\' || c == '"')
+            out += '\\';
+        if (c == '\n')
+        {
+            out += "\\n";
+            continue;
+        }
+        out += c;
+    }
+    return out;
+}
+
+static void header(ostringstream &out, const char *name, const char *type, const char *help)
+{
+    out << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+}
+
+// Histograma como summary en segundos (cuantiles del HDR + _sum + _count)
+static void summary(ostringstream &out, const char *name, const string &labels, const LatencyHistogram &histogram)
+{
+    static const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+    for (double q : QUANTILES)
+    {
+        out << name << "{" << labels << ",quantile=\"" << q << "\"} " << histogram.percentile(q) / 1e6 << "\n";
+    }
+    out << name << "_sum{" << labels << "} " << histogram.sum() / 1e6 << "\n";
+    out << name << "_count{" << labels << "} " << histogram.count() << "\n";
+}
+
+string GatewayMetrics::renderPrometheus() const
+{
+    vector<const PACMetrics *> list = pacList();
+    ostringstream out;
+
+    struct Counter {
+        const char *name;
+        const char *help;
+        const atomic<uint64_t> PACMetrics::*field;
+    };
+    static const Counter COUNTERS[] = {
+        {"pac_bytes_out_total", "Bytes enviados al PAC", &PACMetrics::bytes_out},
+        {"pac_bytes_in_total", "Bytes recibidos del PAC", &PACMetrics::bytes_in},
+        {"pac_timeouts_total", "Respuestas del PAC que no llegaron antes del deadline", &PACMetrics::timeouts},
+        {"pac_desyncs_total", "Tramas invalidas o conexiones cerradas con solicitudes en vuelo", &PACMetrics::desyncs},
+        {"pac_connects_total", "Conexiones TCP abiertas", &PACMetrics::connects},
+        {"pac_reconnects_total", "Reconexiones de sesiones caidas", &PACMetrics::reconnects},
+        {"pac_connect_failures_total", "Intentos de conexion fallidos", &PACMetrics::connect_failures},
+        {"pac_integrity_retries_total", "Relecturas por validacion de integridad", &PACMetrics::retries},
+        {"pac_writes_ok_total", "Escrituras confirmadas con 00 00", &PACMetrics::writes_ok},
+        {"pac_writes_failed_total", "Escrituras sin confirmacion valida", &PACMetrics::writes_failed},
+        {"pac_poll_cycles_total", "Ciclos de sondeo completados", &PACMetrics::cycles},
+        {"pac_poll_overruns_total", "Deadlines de sondeo perdidos", &PACMetrics::overruns},
+        {"opcua_values_published_total", "Valores escritos en el espacio de direcciones", &PACMetrics::values_published},
+        {"opcua_values_suppressed_total", "Lecturas descartadas por banda muerta", &PACMetrics::values_suppressed},
+    };
+
+    for (const Counter &counter : COUNTERS)
+    {
+        header(out, counter.name, "counter", counter.help);
+        for (const PACMetrics *pac : list)
+            out << counter.name << "{pac=\"" << labelValue(pac->pac) << "\"} " << (pac->*counter.field).load() << "\n";
+    }
+
+    header(out, "pac_poll_cycle_seconds", "summary", "Duracion de un ciclo de sondeo (lectura y volcado)");
+    for (const PACMetrics *pac : list)
+        summary(out, "pac_poll_cycle_seconds", "pac=\"" + labelValue(pac->pac) + "\"", pac->cycle_time);
+
+    header(out, "pac_write_confirm_seconds", "summary", "Latencia envio-confirmacion de escrituras");
+    for (const PACMetrics *pac : list)
+        summary(out, "pac_write_confirm_seconds", "pac=\"" + labelValue(pac->pac) + "\"", pac->write_latency);
+
+    // Por tabla: latencia de servicio, lecturas, errores y bytes
+    header(out, "pac_table_read_seconds", "summary", "Tiempo de servicio de la lectura TRange. de una tabla");
+    for (const PACMetrics *pac : list)
+    {
+        for (const TableMetrics *table : pac->tableList())
+        {
+            summary(out, "pac_table_read_seconds",
+                    "pac=\"" + labelValue(pac->pac) + "\",table=\"" + labelValue(table->name) + "\"", table->latency);
+        }
+    }
+
+    struct TableCounter {
+        const char *name;
+        const char *help;
+        const atomic<uint64_t> TableMetrics::*field;
+    };
+    static const TableCounter TABLE_COUNTERS[] = {
+        {"pac_table_reads_total", "Lecturas de tabla completadas", &TableMetrics::reads},
+        {"pac_table_errors_total", "Lecturas de tabla sin trama completa", &TableMetrics::errors},
+        {"pac_table_bytes_in_total", "Bytes de trama recibidos por tabla", &TableMetrics::bytes_in},
+        {"pac_table_changed_reads_total", "Lecturas cuya trama cambio respecto a la anterior", &TableMetrics::changed_reads},
+        {"pac_table_unchanged_reads_total", "Lecturas identicas a la anterior", &TableMetrics::unchanged_reads},
+    };
+
+    for (const TableCounter &counter : TABLE_COUNTERS)
+    {
+        header(out, counter.name, "counter", counter.help);
+        for (const PACMetrics *pac : list)
+        {
+            for (const TableMetrics *table : pac->tableList())
+            {
+                out << counter.name << "{pac=\"" << labelValue(pac->pac) << "\",table=\"" << labelValue(table->name)
+                    << "\"} " << (table->*counter.field).load() << "\n";
+            }
+        }
+    }
+
+    return out.str();
+}
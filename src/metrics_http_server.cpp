@@ -0,0 +1,170 @@
+#define LOG_MODULE LogModule::Server
+#include "metrics_http_server.h"
+#include "common.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+
+using namespace std;
+
+static constexpr int POLL_INTERVAL_MS = 200;       // Cada cuánto se revisa stopping
+static constexpr int CLIENT_TIMEOUT_MS = 1000;      // Tope por cliente: leer la petición y enviar la respuesta
+static constexpr size_t MAX_REQUEST_BYTES = 4096;
+
+MetricsHttpServer::MetricsHttpServer(Renderer renderer, int port, const string &bind_address)
+    : renderer(std::move(renderer)), port(port), bind_address(bind_address)
+{
+}
+
+MetricsHttpServer::~MetricsHttpServer()
+{
+    stop();
+}
+
+bool MetricsHttpServer::start()
+{
+    listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0)
+    {
+        LOG_ERROR("❌ Métricas: no se pudo crear el socket: " << strerror(errno));
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, bind_address.c_str(), &addr.sin_addr) != 1 ||
+        ::bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd, 8) < 0)
+    {
+        LOG_ERROR("❌ Métricas: no se pudo escuchar en " << bind_address << ":" << port << ": " << strerror(errno));
+        ::close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+
+    socklen_t len = sizeof(addr);
+    getsockname(listen_fd, reinterpret_cast<sockaddr *>(&addr), &len);
+    port = ntohs(addr.sin_port);
+
+    stopping = false;
+    server_thread = thread(&MetricsHttpServer::serveLoop, this);
+    LOG_INFO("📈 Métricas Prometheus en http://" << bind_address << ":" << port << "/metrics");
+    return true;
+}
+
+void MetricsHttpServer::stop()
+{
+    stopping = true;
+    if (server_thread.joinable())
+        server_thread.join();
+    if (listen_fd >= 0)
+    {
+        ::close(listen_fd);
+        listen_fd = -1;
+    }
+}
+
+void MetricsHttpServer::serveLoop()
+{
+    while (!stopping)
+    {
+        pollfd pfd{listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, POLL_INTERVAL_MS) <= 0)
+            continue;
+
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0)
+            continue;
+
+        handleClient(fd);
+        ::close(fd);
+    }
+}
+
+using Deadline = chrono::steady_clock::time_point;
+
+// Esperar events en fd sin pasar de deadline; false si venció o hubo error
+static bool waitFor(int fd, short events, Deadline deadline)
+{
+    while (true)
+    {
+        auto remaining = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+        if (remaining <= 0)
+            return false;
+
+        pollfd pfd{fd, events, 0};
+        int ready = poll(&pfd, 1, (int)remaining);
+        if (ready > 0)
+            return true;
+        if (ready == 0 || errno != EINTR)
+            return false;
+    }
+}
+
+// Envío no bloqueante acotado por deadline: un scraper que deja de leer no retiene el hilo
+static bool sendAll(int fd, const string &data, Deadline deadline)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0)
+        {
+            sent += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && waitFor(fd, POLLOUT, deadline))
+            continue;
+        return false;
+    }
+    return true;
+}
+
+void MetricsHttpServer::handleClient(int fd)
+{
+    // Un solo plazo para todo el intercambio: ni goteando la petición ni sin leer la respuesta
+    // un cliente retiene el hilo (ni a stop()) más de CLIENT_TIMEOUT_MS
+    Deadline deadline = chrono::steady_clock::now() + chrono::milliseconds(CLIENT_TIMEOUT_MS);
+
+    // Sólo hace falta la línea de petición: leer hasta el fin de cabeceras
+    string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == string::npos && request.size() < MAX_REQUEST_BYTES)
+    {
+        if (!waitFor(fd, POLLIN, deadline))
+            return;
+
+        ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0)
+            return;
+        request.append(buffer, (size_t)n);
+    }
+
+    string status = "404 Not Found";
+    string body = "not found\n";
+    if (request.rfind("GET /metrics ", 0) == 0 || request.rfind("GET /metrics?", 0) == 0)
+    {
+        status = "200 OK";
+        body = renderer();
+    }
+
+    bool sent = sendAll(fd, "HTTP/1.1 " + status + "\r\n"
+                            "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                            "Content-Length: " + to_string(body.size()) + "\r\n"
+                            "Connection: close\r\n\r\n" + body, deadline);
+    if (!sent)
+    {
+        LOG_DEBUG("⚠️ Métricas: respuesta no enviada en " << CLIENT_TIMEOUT_MS << " ms, cliente descartado");
+    }
+}
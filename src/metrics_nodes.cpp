@@ -0,0 +1,190 @@
+#define LOG_MODULE LogModule::Server
+#include "metrics_nodes.h"
+#include "common.h"
+
+using namespace std;
+
+static const char *DIAGNOSTICS_FOLDER = "Diagnostics";
+
+// Variables de la carpeta: nombre de nodo, campo y tipo
+struct MetricNodeSpec {
+    const char *name;
+    PACMetricsNodes::Field field;
+    int type;          // UA_TYPES_*
+    bool array;
+};
+
+static const MetricNodeSpec NODE_SPECS[] = {
+    {"CycleTimeP50Ms", PACMetricsNodes::CYCLE_P50_MS, UA_TYPES_DOUBLE, false},
+    {"CycleTimeP99Ms", PACMetricsNodes::CYCLE_P99_MS, UA_TYPES_DOUBLE, false},
+    {"CycleTimeMaxMs", PACMetricsNodes::CYCLE_MAX_MS, UA_TYPES_DOUBLE, false},
+    {"PollCycles", PACMetricsNodes::POLL_CYCLES, UA_TYPES_UINT64, false},
+    {"PollOverruns", PACMetricsNodes::POLL_OVERRUNS, UA_TYPES_UINT64, false},
+    {"ValuesPublished", PACMetricsNodes::VALUES_PUBLISHED, UA_TYPES_UINT64, false},
+    {"BytesIn", PACMetricsNodes::BYTES_IN, UA_TYPES_UINT64, false},
+    {"BytesOut", PACMetricsNodes::BYTES_OUT, UA_TYPES_UINT64, false},
+    {"Timeouts", PACMetricsNodes::TIMEOUTS, UA_TYPES_UINT64, false},
+    {"Reconnects", PACMetricsNodes::RECONNECTS, UA_TYPES_UINT64, false},
+    {"IntegrityRetries", PACMetricsNodes::INTEGRITY_RETRIES, UA_TYPES_UINT64, false},
+    {"WriteConfirmP99Ms", PACMetricsNodes::WRITE_CONFIRM_P99_MS, UA_TYPES_DOUBLE, false},
+    {"TableNames", PACMetricsNodes::TABLE_NAMES, UA_TYPES_STRING, true},
+    {"TableReadP99Ms", PACMetricsNodes::TABLE_READ_P99_MS, UA_TYPES_DOUBLE, true},
+    {"TableReadTotalMs", PACMetricsNodes::TABLE_READ_TOTAL_MS, UA_TYPES_DOUBLE, true},
+};
+
+PACMetricsNodes::PACMetricsNodes(const PACMetrics &metrics) : metrics(metrics)
+{
+}
+
+size_t PACMetricsNodes::createNodes(UA_Server *server, const UA_NodeId &parent, const string &prefix)
+{
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    oAttr.displayName = UA_LOCALIZEDTEXT(const_cast<char *>("en"), const_cast<char *>(DIAGNOSTICS_FOLDER));
+    oAttr.description = UA_LOCALIZEDTEXT(const_cast<char *>("en"), const_cast<char *>(metrics.pac.c_str()));
+
+    string folderName = prefix + DIAGNOSTICS_FOLDER;
+    UA_NodeId folderId;
+    UA_StatusCode result = UA_Server_addObjectNode(
+        server,
+        UA_NODEID_STRING(1, const_cast<char *>(folderName.c_str())),
+        parent,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+        UA_QUALIFIEDNAME(1, const_cast<char *>(DIAGNOSTICS_FOLDER)),
+        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+        oAttr,
+        nullptr,
+        &folderId);
+
+    if (result != UA_STATUSCODE_GOOD)
+    {
+        LOG_ERROR("❌ Error creando carpeta " << folderName << ": " << UA_StatusCode_name(result));
+        return 0;
+    }
+
+    UA_DataSource dataSource;
+    dataSource.read = readCallback;
+    dataSource.write = nullptr;
+
+    size_t created = 0;
+    for (const MetricNodeSpec &spec : NODE_SPECS)
+    {
+        UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+        vAttr.displayName = UA_LOCALIZEDTEXT(const_cast<char *>("en"), const_cast<char *>(spec.name));
+        vAttr.dataType = UA_TYPES[spec.type].typeId;
+        vAttr.valueRank = spec.array ? UA_VALUERANK_ONE_DIMENSION : UA_VALUERANK_SCALAR;
+        vAttr.accessLevel = UA_ACCESSLEVELMASK_READ;
+        vAttr.userAccessLevel = vAttr.accessLevel;
+
+        nodes.push_back(make_unique<MetricNode>(MetricNode{this, spec.field}));
+
+        string nodeName = folderName + "." + spec.name;
+        result = UA_Server_addDataSourceVariableNode(
+            server,
+            UA_NODEID_STRING(1, const_cast<char *>(nodeName.c_str())),
+            folderId,
+            UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+            UA_QUALIFIEDNAME(1, const_cast<char *>(spec.name)),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+            vAttr,
+            dataSource,
+            nodes.back().get(),
+            nullptr);
+
+        if (result != UA_STATUSCODE_GOOD)
+        {
+            LOG_ERROR("❌ Error creando diagnóstico " << nodeName << ": " << UA_StatusCode_name(result));
+            nodes.pop_back();
+            continue;
+        }
+        created++;
+    }
+
+    UA_NodeId_clear(&folderId);
+    LOG_INFO("📈 " << created << " variables de diagnóstico creadas en " << folderName << " (" << metrics.pac << ")");
+    return created;
+}
+
+UA_StatusCode PACMetricsNodes::readCallback(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+                                            const UA_NodeId *nodeId, void *nodeContext, UA_Boolean includeSourceTimeStamp,
+                                            const UA_NumericRange *range, UA_DataValue *value)
+{
+    MetricNode *node = static_cast<MetricNode *>(nodeContext);
+    if (!node)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_StatusCode status = node->owner->read(node->field, value->value);
+    if (status != UA_STATUSCODE_GOOD)
+        return status;
+
+    value->hasValue = true;
+    if (includeSourceTimeStamp)
+    {
+        value->sourceTimestamp = UA_DateTime_now();
+        value->hasSourceTimestamp = true;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode setDouble(UA_Variant &out, double value)
+{
+    return UA_Variant_setScalarCopy(&out, &value, &UA_TYPES[UA_TYPES_DOUBLE]);
+}
+
+static UA_StatusCode setCounter(UA_Variant &out, const atomic<uint64_t> &counter)
+{
+    UA_UInt64 value = counter.load(memory_order_relaxed);
+    return UA_Variant_setScalarCopy(&out, &value, &UA_TYPES[UA_TYPES_UINT64]);
+}
+
+UA_StatusCode PACMetricsNodes::read(Field field, UA_Variant &out) const
+{
+    switch (field)
+    {
+    case CYCLE_P50_MS:
+        return setDouble(out, metrics.cycle_time.percentile(0.5) / 1000.0);
+    case CYCLE_P99_MS:
+        return setDouble(out, metrics.cycle_time.percentile(0.99) / 1000.0);
+    case CYCLE_MAX_MS:
+        return setDouble(out, metrics.cycle_time.max() / 1000.0);
+    case POLL_CYCLES:
+        return setCounter(out, metrics.cycles);
+    case POLL_OVERRUNS:
+        return setCounter(out, metrics.overruns);
+    case VALUES_PUBLISHED:
+        return setCounter(out, metrics.values_published);
+    case BYTES_IN:
+        return setCounter(out, metrics.bytes_in);
+    case BYTES_OUT:
+        return setCounter(out, metrics.bytes_out);
+    case TIMEOUTS:
+        return setCounter(out, metrics.timeouts);
+    case RECONNECTS:
+        return setCounter(out, metrics.reconnects);
+    case INTEGRITY_RETRIES:
+        return setCounter(out, metrics.retries);
+    case WRITE_CONFIRM_P99_MS:
+        return setDouble(out, metrics.write_latency.percentile(0.99) / 1000.0);
+    default:
+        break;
+    }
+
+    // Arrays por tabla, en el orden de registro (el mismo en los tres nodos)
+    vector<const TableMetrics *> tables = metrics.tableList();
+    if (field == TABLE_NAMES)
+    {
+        vector<UA_String> names;
+        names.reserve(tables.size());
+        for (const TableMetrics *table : tables)
+            names.push_back(UA_STRING(const_cast<char *>(table->name.c_str())));
+        return UA_Variant_setArrayCopy(&out, names.data(), names.size(), &UA_TYPES[UA_TYPES_STRING]);
+    }
+
+    vector<double> values;
+    values.reserve(tables.size());
+    for (const TableMetrics *table : tables)
+    {
+        values.push_back(field == TABLE_READ_P99_MS ? table->latency.percentile(0.99) / 1000.0
+                                                    : table->latency.sum() / 1000.0);
+    }
+    return UA_Variant_setArrayCopy(&out, values.data(), values.size(), &UA_TYPES[UA_TYPES_DOUBLE]);
+}
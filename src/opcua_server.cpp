@@ -1,8 +1,25 @@
+#define LOG_MODULE LogModule::Server
 #include "opcua_server.h"
+#include <open62541/server_config_default.h>
 #include "pac_control_client.h"
+#include "pac_connection_pool.h"
+#include "poll_scheduler.h"
+#include "poll_plan.h"
+#include "change_detector.h"
+#include "pac_write_queue.h"
+#include "pac_array_source.h"
+#include "subscription_tracker.h"
+#include "read_through_cache.h"
+#include "gateway_metrics.h"
+#include "metrics_http_server.h"
+#include "metrics_nodes.h"
+#include "value_store.h"
 #include <fstream>
+#include <unordered_map>
+#include <set>
 #include <iostream>
 #include <thread>
+#include <future>
 #include <chrono>
 #include <algorithm>
 #include <numeric>
@@ -15,14 +32,59 @@ using json = nlohmann::json;
 
 // ============== VARIABLES GLOBALES ==============
 UA_Server *server = nullptr;
-std::unique_ptr<PACControlClient> pacClient;
+
+// Refresco bajo demanda en vuelo: lo lanza readCallback y lo recoge el volcado periódico,
+// ambos en el hilo del servidor (el motor de E/S escribe cycle hasta que done esté listo)
+struct PendingRefresh {
+    size_t source = 0;
+    PollBatch batch;                             // La fuente como lote de una sola lectura
+    PollCycleResult cycle;
+    std::future<void> done;
+    int64_t read_at_ns = 0;
+    chrono::steady_clock::time_point started;
+};
+
+// Un PAC del gateway: todo lo que toca E/S es propio, así un PAC lento sólo retrasa su sondeo
+struct Controller {
+    ControllerConfig cfg;
+    int index = 0;                               // Índice en config.controllers (Variable::controller)
+    string prefix;                               // Prefijo de NodeIds: "" o "<name>."
+    std::unique_ptr<PACConnectionPool> pool;     // Sesiones de lectura + sesión dedicada de escritura
+    PollPlan plan;                               // Lecturas precompiladas de sus variables
+    TableRegistry tables;                        // Nombres de tabla → ids densos (caché de sus sesiones)
+    ReadThroughCache readCache;                  // Frescura por fuente de su plan (lecturas OPC-UA con maxAge)
+    std::unique_ptr<PACWriteQueue> writeQueue;   // Escrituras de operador asíncronas (sesión dedicada)
+    std::unique_ptr<PACArraySource> arraySource; // Tablas expuestas como arrays (copia refrescada bajo demanda)
+    PACMetrics *metrics = nullptr;                // Contadores de su ip:port (compartidos con sus sesiones)
+    std::unique_ptr<PACMetricsNodes> metricsNodes; // Carpeta "Diagnostics" con esos contadores
+    std::mutex publishMutex;                     // Publicación de su sondeo y de sus lecturas bajo demanda (banda muerta)
+    vector<unique_ptr<PendingRefresh>> refreshes; // Lecturas bajo demanda en vuelo (sólo hilo del servidor)
+};
+
+static vector<unique_ptr<Controller>> controllers;  // Uno por config.controllers, mismo orden
+ChangeDetector changeDetector;               // Últimos valores publicados (banda muerta, ids globales)
+SubscriptionTracker subscriptionTracker;     // Variables con MonitoredItems (sondeo bajo demanda)
+static ValueStore valueStore;                // Valores leídos → hilo del servidor (seqlock por variable)
+static bool writingInternally = false;       // Sólo hilo del servidor: sus escrituras de nodos no van al PAC
+static unordered_map<string, Variable *> variableByNodeId;  // NodeId STRING → variable
+static PollCycleObserver pollCycleObserver;                 // Instrumentación opcional (benchmark)
+static unique_ptr<MetricsHttpServer> metricsServer;         // GET /metrics (con metrics_port)
+static shared_ptr<PACIoEngine> captureEngine;               // Motor con la captura de tramas (packet_capture)
+
+// Sesiones de un controlador (se crean una sola vez, la conexión se abre aparte)
+static PACConnectionPool &ensurePool(Controller &ctrl)
+{
+    if (!ctrl.pool) {
+        ctrl.pool = std::make_unique<PACConnectionPool>(ctrl.cfg.ip, ctrl.cfg.port, ctrl.cfg.sessions);
+        ctrl.pool->setTableRegistry(&ctrl.tables);
+    }
+    return *ctrl.pool;
+}
 
 // 🔧 DEFINIR LAS VARIABLES GLOBALES DECLARADAS EN COMMON.H
 Config config;
 std::atomic<bool> running{true};
 std::atomic<bool> server_running{true};
-std::atomic<bool> updating_internally{false};
-std::atomic<bool> server_writing_internally{false};
 
 // Variable normal para UA_Server_run (requiere bool*)
 bool server_running_flag = true;
@@ -176,7 +238,7 @@ bool isWritableVariable(const std::string &varName)
 
 bool loadConfig(const string &configFile)
 {
-    cout << "📄 Cargando configuración desde: " << configFile << endl;
+    LOG_INFO("📄 Cargando configuración desde: " << configFile);
 
     try
     {
@@ -197,7 +259,7 @@ bool loadConfig(const string &configFile)
             ifstream file(fileName);
             if (file.is_open())
             {
-                cout << "📄 Usando archivo: " << fileName << endl;
+                LOG_INFO("📄 Usando archivo: " << fileName);
                 file >> configJson;
                 file.close();
                 configLoaded = true;
@@ -207,12 +269,12 @@ bool loadConfig(const string &configFile)
 
         if (!configLoaded)
         {
-            cout << "❌ No se encontró ningún archivo de configuración" << endl;
-            cout << "📝 Archivos intentados:" << endl;
+            string tried;
             for (const auto &fileName : configFiles)
             {
-                cout << "   - " << fileName << endl;
+                tried += "\n   - " + fileName;
             }
+            LOG_ERROR("No se encontró ningún archivo de configuración. Archivos intentados:" << tried);
             return false;
         }
 
@@ -220,40 +282,28 @@ bool loadConfig(const string &configFile)
     }
     catch (const exception &e)
     {
-        cout << "❌ Error cargando configuración: " << e.what() << endl;
+        LOG_ERROR("Error cargando configuración: " << e.what());
         return false;
     }
 }
 
-bool processConfigFromJson(const json &configJson)
+// Prefijo de NodeIds de un controlador: vacío con un solo PAC sin nombre (espacio de direcciones clásico)
+static string nodePrefix(int controller)
 {
-    // Configuración PAC
-    if (configJson.contains("pac_config"))
-    {
-        auto &pac = configJson["pac_config"];
-        config.pac_ip = pac.value("ip", "192.168.1.30");
-        config.pac_port = pac.value("port", 22001);
-    }
-
-    // Configuración del servidor
-    if (configJson.contains("server_config"))
-    {
-        auto &srv = configJson["server_config"];
-        config.opcua_port = srv.value("opcua_port", 4840);
-        config.update_interval_ms = srv.value("update_interval_ms", 2000);
-        config.server_name = srv.value("server_name", "PAC Control SCADA Server");
-    }
-
-    // 🔧 LIMPIAR CONFIGURACIÓN ANTERIOR
-    // config.clear();  // ← ELIMINAR ESTA LÍNEA - BORRA LAS VARIABLES SIMPLES
+    const string &name = config.controllers[controller].name;
+    return name.empty() ? "" : name + ".";
+}
 
+// Secciones de tags (simple_variables, tbL_tags, tbl_api, tbl_batch, tbl_pid, tbl_arrays) de un controlador
+static void processTagSections(const json &section, int controller)
+{
     // 📋 PROCESAR SIMPLE_VARIABLES
-    if (configJson.contains("simple_variables"))
+    if (section.contains("simple_variables"))
     {
-        for (const auto &simpleVar : configJson["simple_variables"])
+        for (const auto &simpleVar : section["simple_variables"])
         {
             Variable var;
-            var.opcua_name = simpleVar.value("name", "");
+            var.opcua_name = nodePrefix(controller) + simpleVar.value("name", "");
             var.tag_name = "SimpleVars";
             var.var_name = simpleVar.value("name", "");
             var.pac_source = simpleVar.value("pac_source", var.var_name);
@@ -276,26 +326,30 @@ bool processConfigFromJson(const json &configJson)
 
             var.writable = simpleVar.value("writable", false);
             var.table_index = -1;
+            var.scan_ms = simpleVar.value("scan_ms", 0);
+            var.controller = controller;
 
             // 🔧 AGREGAR DIRECTAMENTE A config.variables, NO A config.simple_variables
             config.variables.push_back(var);
             LOG_DEBUG("🔧 Variable simple " << (var.type == Variable::FLOAT ? "FLOAT" : "INT32") << ": " << var.opcua_name);
         }
 
-        LOG_INFO("✓ Cargadas " << configJson["simple_variables"].size() << " variables simples");
+        LOG_INFO("✓ Cargadas " << section["simple_variables"].size() << " variables simples");
     }
 
     // 📊 PROCESAR TBL_TAGS (tradicionales - TT, LT, DT, PT)
-    if (configJson.contains("tbL_tags"))
+    if (section.contains("tbL_tags"))
     {
         LOG_INFO("🔍 Procesando tbL_tags...");
 
-        for (const auto &tagJson : configJson["tbL_tags"])
+        for (const auto &tagJson : section["tbL_tags"])
         {
             Tag tag;
             tag.name = tagJson.value("name", "");
             tag.value_table = tagJson.value("value_table", "");
             tag.alarm_table = tagJson.value("alarm_table", "");
+            tag.scan_ms = tagJson.value("scan_ms", 0);
+            tag.controller = controller;
 
             if (tagJson.contains("variables"))
             {
@@ -320,15 +374,17 @@ bool processConfigFromJson(const json &configJson)
     }
 
     // 🔧 PROCESAR TBL_API (tablas API) - CORREGIR NOMBRE DE SECCIÓN
-    if (configJson.contains("tbl_api"))
+    if (section.contains("tbl_api"))
     { // 🔧 ERA "tbl_api" NO "tbl_api"
         LOG_INFO("🔍 Procesando tbl_api...");
 
-        for (const auto &apiJson : configJson["tbl_api"])
+        for (const auto &apiJson : section["tbl_api"])
         {
             APITag apiTag;
             apiTag.name = apiJson.value("name", "");
             apiTag.value_table = apiJson.value("value_table", "");
+            apiTag.scan_ms = apiJson.value("scan_ms", 0);
+            apiTag.controller = controller;
 
             if (apiJson.contains("variables"))
             {
@@ -345,15 +401,17 @@ bool processConfigFromJson(const json &configJson)
     }
 
     // 📦 PROCESAR TBL_BATCH (tablas de lote) - CORREGIR NOMBRE DE SECCIÓN
-    if (configJson.contains("tbl_batch"))
+    if (section.contains("tbl_batch"))
     { // 🔧 YA ESTÁ CORRECTO
         LOG_INFO("🔍 Procesando tbl_batch...");
 
-        for (const auto &batchJson : configJson["tbl_batch"])
+        for (const auto &batchJson : section["tbl_batch"])
         {
             BatchTag batchTag;
             batchTag.name = batchJson.value("name", "");
             batchTag.value_table = batchJson.value("value_table", "");
+            batchTag.scan_ms = batchJson.value("scan_ms", 0);
+            batchTag.controller = controller;
 
             if (batchJson.contains("variables"))
             {
@@ -370,16 +428,18 @@ bool processConfigFromJson(const json &configJson)
     }
 
     // 🎛️ PROCESAR TBL_PID (controladores PID)
-    if (configJson.contains("tbl_pid"))
+    if (section.contains("tbl_pid"))
     {
         LOG_INFO("🔍 Procesando tbl_pid...");
 
-        for (const auto &pidJson : configJson["tbl_pid"])
+        for (const auto &pidJson : section["tbl_pid"])
         {
             Tag pidTag; // Usar estructura Tag normal
             pidTag.name = pidJson.value("name", "");
             pidTag.value_table = pidJson.value("value_table", "");
             pidTag.alarm_table = ""; // Los PID normalmente no tienen alarmas
+            pidTag.scan_ms = pidJson.value("scan_ms", 0);
+            pidTag.controller = controller;
 
             if (pidJson.contains("variables"))
             {
@@ -395,12 +455,172 @@ bool processConfigFromJson(const json &configJson)
         LOG_INFO("✓ Cargados PID_tags como tags tradicionales");
     }
 
+    // 📚 PROCESAR TBL_ARRAYS (tablas completas como una variable array, sin sondeo)
+    if (section.contains("tbl_arrays"))
+    {
+        LOG_INFO("🔍 Procesando tbl_arrays...");
+
+        for (const auto &arrayJson : section["tbl_arrays"])
+        {
+            ArrayTag arrayTag;
+            arrayTag.name = arrayJson.value("name", "");
+            arrayTag.table = arrayJson.value("table", "");
+            arrayTag.size = arrayJson.value("size", 0);
+            arrayTag.is_int32 = arrayJson.value("type", "FLOAT") == "INT32";
+            arrayTag.writable = arrayJson.value("writable", false);
+            arrayTag.description = arrayJson.value("description", "");
+            arrayTag.controller = controller;
+
+            if (arrayTag.name.empty() || arrayTag.table.empty() || arrayTag.size <= 0)
+            {
+                LOG_WARNING("⚠️ Array ignorado (requiere name, table y size > 0): " << arrayJson.dump());
+                continue;
+            }
+
+            config.array_tags.push_back(arrayTag);
+            LOG_DEBUG("✅ Array_tag: " << arrayTag.name << " (" << arrayTag.table << "[" << arrayTag.size << "])");
+        }
+        LOG_INFO("✓ Cargados " << config.array_tags.size() << " Array_tags");
+    }
+}
+
+// Conexión de un controlador ("pac_config" o una entrada de "controllers")
+static ControllerConfig parseControllerConfig(const json &pac, const string &name)
+{
+    ControllerConfig controller;
+    controller.name = name;
+    controller.ip = pac.value("ip", "192.168.1.30");
+    controller.port = pac.value("port", 22001);
+    controller.pipeline_depth = pac.value("pipeline_depth", 8);
+    controller.sessions = pac.value("sessions", 1);
+    return controller;
+}
+
+bool processConfigFromJson(const json &configJson)
+{
+    // 🏭 CONTROLADORES PAC: lista "controllers" o, si no está, un único PAC desde "pac_config"
+    config.controllers.clear();
+    if (configJson.contains("controllers") && !configJson["controllers"].is_array())
+    {
+        LOG_ERROR("❌ \"controllers\" debe ser una lista de controladores");
+        return false;
+    }
+
+    // Lista vacía = como si no estuviera (un PAC desde "pac_config")
+    bool controllerList = configJson.contains("controllers") && !configJson["controllers"].empty();
+    if (controllerList)
+    {
+        set<string> names;
+        for (const auto &pac : configJson["controllers"])
+        {
+            if (!pac.is_object())
+            {
+                LOG_ERROR("❌ Entrada de \"controllers\" que no es un objeto: " << pac.dump());
+                return false;
+            }
+            ControllerConfig controller =
+                parseControllerConfig(pac, pac.value("name", "PAC" + to_string(config.controllers.size() + 1)));
+            if (controller.name.empty() || !names.insert(controller.name).second)
+            {
+                LOG_ERROR("❌ Nombre de controlador vacío o repetido: '" << controller.name << "'");
+                return false;
+            }
+            config.controllers.push_back(controller);
+        }
+    }
+    else
+    {
+        config.controllers.push_back(parseControllerConfig(
+            configJson.contains("pac_config") ? configJson["pac_config"] : json::object(), ""));
+    }
+
+    // Configuración del servidor
+    if (configJson.contains("server_config"))
+    {
+        auto &srv = configJson["server_config"];
+        config.opcua_port = srv.value("opcua_port", 4840);
+        config.update_interval_ms = srv.value("update_interval_ms", 2000);
+        config.server_name = srv.value("server_name", "PAC Control SCADA Server");
+        config.poll_on_demand = srv.value("poll_on_demand", false);
+        config.background_refresh_ms = srv.value("background_refresh_ms", 30000);
+        config.read_max_age_ms = srv.value("read_max_age_ms", 0);
+        config.publish_interval_ms = max(srv.value("publish_interval_ms", 50), 1);
+        config.metrics_port = srv.value("metrics_port", 0);
+        config.metrics_bind = srv.value("metrics_bind", "127.0.0.1");
+        if (srv.contains("packet_capture"))
+        {
+            auto &capture = srv["packet_capture"];
+            config.packet_capture_file = capture.value("file", "");
+            config.packet_capture_mb = capture.value("size_mb", 16);
+        }
+    }
+
+    // 🗒️ LOGGING: niveles por subsistema ("info,pac=debug") y límite de errores repetidos
+    if (configJson.contains("logging"))
+    {
+        auto &logging = configJson["logging"];
+        string levels = logging.value("levels", "info");
+        if (!AsyncLogger::applyLevelSpec(levels))
+        {
+            LOG_WARNING("Niveles de log no reconocidos: '" << levels << "' (se mantienen " << AsyncLogger::levelSpec() << ")");
+        }
+        AsyncLogger::setRateLimit(logging.value("rate_limit_burst", 5u),
+                                  chrono::milliseconds(logging.value("rate_limit_window_ms", 10000)));
+    }
+
+    // 📉 BANDAS MUERTAS POR CLASE DE TAG ("TT", "API", "SimpleVars", ... o "default")
+    if (configJson.contains("deadbands"))
+    {
+        for (const auto &[tagClass, dbJson] : configJson["deadbands"].items())
+        {
+            Deadband deadband;
+            deadband.mode = dbJson.value("type", "absolute") == "percent" ? Deadband::PERCENT : Deadband::ABSOLUTE;
+            deadband.value = dbJson.value("value", 0.0);
+            config.deadbands[tagClass] = deadband;
+            LOG_DEBUG("📉 Banda muerta " << tagClass << ": " << deadband.value
+                      << (deadband.mode == Deadband::PERCENT ? " %" : " (absoluta)"));
+        }
+        LOG_INFO("✓ Cargadas " << config.deadbands.size() << " bandas muertas");
+    }
+
+    // 📋 TAGS: las secciones de la raíz son del primer controlador; cada entrada de "controllers" trae las suyas
+    processTagSections(configJson, 0);
+    if (controllerList)
+    {
+        for (size_t c = 0; c < config.controllers.size(); c++)
+            processTagSections(configJson["controllers"][c], (int)c);
+    }
+
+    for (const auto &controller : config.controllers)
+    {
+        LOG_INFO("🏭 Controlador " << (controller.name.empty() ? "PAC" : controller.name) << ": "
+                 << controller.ip << ":" << controller.port << " (" << controller.sessions << " sesiones)");
+    }
+
     // Procesar configuración en variables
     processConfigIntoVariables();
 
     return true;
 }
 
+// Banda muerta de una variable: nombre de tag, luego clase (prefijo antes de '_'), luego "default"
+static Deadband resolveDeadband(const Variable &var)
+{
+    auto it = config.deadbands.find(var.tag_name);
+    if (it != config.deadbands.end())
+        return it->second;
+
+    it = config.deadbands.find(var.tag_name.substr(0, var.tag_name.find('_')));
+    if (it != config.deadbands.end())
+        return it->second;
+
+    it = config.deadbands.find("default");
+    if (it != config.deadbands.end())
+        return it->second;
+
+    return Deadband();
+}
+
 void processConfigIntoVariables()
 {
     LOG_INFO("🔧 Procesando configuración en variables...");
@@ -425,7 +645,7 @@ void processConfigIntoVariables()
         for (const auto &varName : tag.variables)
         {
             Variable var;
-            var.opcua_name = tag.name + "." + varName;
+            var.opcua_name = nodePrefix(tag.controller) + tag.name + "." + varName;
             var.tag_name = tag.name;
             var.var_name = varName;
             var.pac_source = tag.value_table + ":" + to_string(getVariableIndex(varName));
@@ -439,6 +659,8 @@ void processConfigIntoVariables()
             
             var.writable = isWritableVariable(varName);
             var.table_index = getVariableIndex(varName);
+            var.scan_ms = tag.scan_ms;
+            var.controller = tag.controller;
             
             config.variables.push_back(var);
         }
@@ -449,13 +671,15 @@ void processConfigIntoVariables()
             for (const auto &alarmName : tag.alarms)
             {
                 Variable var;
-                var.opcua_name = tag.name + ".ALARM_" + alarmName;
+                var.opcua_name = nodePrefix(tag.controller) + tag.name + ".ALARM_" + alarmName;
                 var.tag_name = tag.name;
                 var.var_name = "ALARM_" + alarmName;
                 var.pac_source = tag.alarm_table + ":" + to_string(getVariableIndex(alarmName));
                 var.type = Variable::INT32;
                 var.writable = false;
                 var.table_index = getVariableIndex(alarmName);
+                var.scan_ms = tag.scan_ms;
+                var.controller = tag.controller;
 
                 config.variables.push_back(var);
             }
@@ -468,13 +692,15 @@ void processConfigIntoVariables()
         for (const auto &varName : apiTag.variables)
         {
             Variable var;
-            var.opcua_name = apiTag.name + "." + varName;
+            var.opcua_name = nodePrefix(apiTag.controller) + apiTag.name + "." + varName;
             var.tag_name = apiTag.name;
             var.var_name = varName;
             var.pac_source = apiTag.value_table + ":" + to_string(getAPIVariableIndex(varName));
             var.type = Variable::FLOAT;
             var.writable = isWritableVariable(varName);
             var.table_index = getAPIVariableIndex(varName);
+            var.scan_ms = apiTag.scan_ms;
+            var.controller = apiTag.controller;
 
             config.variables.push_back(var);
         }
@@ -486,13 +712,15 @@ void processConfigIntoVariables()
         for (const auto &varName : batchTag.variables)
         {
             Variable var;
-            var.opcua_name = batchTag.name + "." + varName;
+            var.opcua_name = nodePrefix(batchTag.controller) + batchTag.name + "." + varName;
             var.tag_name = batchTag.name;
             var.var_name = varName;
             var.pac_source = batchTag.value_table + ":" + to_string(getBatchVariableIndex(varName));
             var.type = Variable::FLOAT;
             var.writable = false;
             var.table_index = getBatchVariableIndex(varName);
+            var.scan_ms = batchTag.scan_ms;
+            var.controller = batchTag.controller;
 
             config.variables.push_back(var);
         }
@@ -517,10 +745,280 @@ void processConfigIntoVariables()
     LOG_INFO("   📊 Variables de tags (TT_/PT_/etc.): " << tagCount);
     LOG_INFO("   🔢 Tipos: " << floatCount << " FLOAT, " << int32Count << " INT32");
     LOG_INFO("   🎯 Total: " << config.variables.size() << " variables");
+
+    // 🔑 IDS DENSOS E ÍNDICE NodeId → Variable (búsqueda O(1) en callbacks)
+    variableByNodeId.clear();
+    variableByNodeId.reserve(config.variables.size());
+    for (size_t i = 0; i < config.variables.size(); i++)
+    {
+        Variable &var = config.variables[i];
+        var.deadband = resolveDeadband(var);
+        var.node_id = (int)i;
+        var.node_string_id = var.opcua_name;
+        variableByNodeId[var.node_string_id] = &var;
+    }
+
+    // 🏭 ESTADO POR CONTROLADOR (las sesiones se abren después, en la primera actualización)
+    if (controllers.size() != config.controllers.size())
+    {
+        controllers.clear();
+        for (size_t c = 0; c < config.controllers.size(); c++)
+        {
+            controllers.push_back(make_unique<Controller>());
+            controllers.back()->index = (int)c;
+        }
+    }
+
+    // 🗺️ COMPILAR UN PLAN DE SONDEO POR CONTROLADOR (sólo cuando cambia la configuración)
+    for (auto &ctrl : controllers)
+    {
+        ctrl->cfg = config.controllers[ctrl->index];
+        ctrl->prefix = nodePrefix(ctrl->index);
+        ctrl->metrics = &gatewayMetrics().pac(ctrl->cfg.ip, ctrl->cfg.port);
+        ctrl->tables.clear();
+        ctrl->plan.build(config.variables, config.update_interval_ms,
+                         config.poll_on_demand ? config.background_refresh_ms : 0, &ctrl->tables, ctrl->index);
+        if (ctrl->pool)
+            ctrl->pool->setTableRegistry(&ctrl->tables);
+        ctrl->readCache.reset(ctrl->plan.sourceCount());
+    }
+    changeDetector.reset(config.variables.size());
+    subscriptionTracker.reset(config.variables.size());
+    valueStore.reset(config.variables.size());
 }
 
 // ============== CALLBACKS CORREGIDOS ==============
 
+// ============== ESTADO DE ESCRITURAS ==============
+
+static const char *WRITE_STATUS_FOLDER = "Gateway";
+static const char *WRITE_STATUS_PENDING = "Gateway.WritesPending";
+static const char *WRITE_STATUS_COMPLETED = "Gateway.WritesCompleted";
+static const char *WRITE_STATUS_FAILED = "Gateway.WritesFailed";
+static const char *WRITE_STATUS_COALESCED = "Gateway.WritesCoalesced";
+static const char *WRITE_STATUS_LAST = "Gateway.LastWriteResult";
+static const char *LOG_LEVELS_NODE = "Gateway.LogLevels";
+
+static void addStatusVariable(const UA_NodeId &parent, const char *nodeName, const char *browseName,
+                              const void *initial, const UA_DataType *type)
+{
+    UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+    vAttr.displayName = UA_LOCALIZEDTEXT(const_cast<char *>("en"), const_cast<char *>(browseName));
+    vAttr.accessLevel = UA_ACCESSLEVELMASK_READ;
+    vAttr.userAccessLevel = UA_ACCESSLEVELMASK_READ;
+    vAttr.dataType = type->typeId;
+    vAttr.valueRank = UA_VALUERANK_SCALAR;
+    UA_Variant_setScalar(&vAttr.value, const_cast<void *>(initial), type);
+
+    UA_StatusCode result = UA_Server_addVariableNode(
+        server,
+        UA_NODEID_STRING(1, const_cast<char *>(nodeName)),
+        parent,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+        UA_QUALIFIEDNAME(1, const_cast<char *>(browseName)),
+        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+        vAttr,
+        nullptr,
+        nullptr);
+
+    if (result != UA_STATUSCODE_GOOD)
+    {
+        LOG_ERROR("❌ Error creando variable de estado " << nodeName << ": " << UA_StatusCode_name(result));
+    }
+}
+
+// Gateway.LogLevels: lee "general=info,pac=debug,..." y acepta la misma sintaxis que "logging.levels"
+static UA_StatusCode readLogLevels(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+                                   const UA_NodeId *nodeId, void *nodeContext, UA_Boolean includeSourceTimeStamp,
+                                   const UA_NumericRange *range, UA_DataValue *value)
+{
+    string spec = AsyncLogger::levelSpec();
+    UA_String text = UA_STRING(const_cast<char *>(spec.c_str()));
+    UA_StatusCode result = UA_Variant_setScalarCopy(&value->value, &text, &UA_TYPES[UA_TYPES_STRING]);
+    value->hasValue = result == UA_STATUSCODE_GOOD;
+    return result;
+}
+
+static UA_StatusCode writeLogLevels(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+                                    const UA_NodeId *nodeId, void *nodeContext,
+                                    const UA_NumericRange *range, const UA_DataValue *value)
+{
+    if (!value || !value->hasValue || value->value.type != &UA_TYPES[UA_TYPES_STRING])
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+
+    const UA_String *text = static_cast<const UA_String *>(value->value.data);
+    string spec((const char *)text->data, text->length);
+    if (!AsyncLogger::applyLevelSpec(spec))
+        return UA_STATUSCODE_BADOUTOFRANGE;
+
+    LOG_INFO("🗒️ Niveles de log: " << AsyncLogger::levelSpec());
+    return UA_STATUSCODE_GOOD;
+}
+
+static void addLogLevelsVariable(const UA_NodeId &parent)
+{
+    UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+    vAttr.displayName = UA_LOCALIZEDTEXT(const_cast<char *>("en"), const_cast<char *>("LogLevels"));
+    vAttr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    vAttr.userAccessLevel = vAttr.accessLevel;
+    vAttr.dataType = UA_TYPES[UA_TYPES_STRING].typeId;
+    vAttr.valueRank = UA_VALUERANK_SCALAR;
+
+    UA_DataSource dataSource;
+    dataSource.read = readLogLevels;
+    dataSource.write = writeLogLevels;
+
+    UA_StatusCode result = UA_Server_addDataSourceVariableNode(
+        server,
+        UA_NODEID_STRING(1, const_cast<char *>(LOG_LEVELS_NODE)),
+        parent,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+        UA_QUALIFIEDNAME(1, const_cast<char *>("LogLevels")),
+        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+        vAttr,
+        dataSource,
+        nullptr,
+        nullptr);
+
+    if (result != UA_STATUSCODE_GOOD)
+    {
+        LOG_ERROR("❌ Error creando " << LOG_LEVELS_NODE << ": " << UA_StatusCode_name(result));
+    }
+}
+
+// Carpeta "Gateway" con los contadores de la cola de escritura y los niveles de log
+static void createWriteStatusNodes()
+{
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    oAttr.displayName = UA_LOCALIZEDTEXT(const_cast<char *>("en"), const_cast<char *>(WRITE_STATUS_FOLDER));
+
+    UA_NodeId folderId;
+    UA_StatusCode result = UA_Server_addObjectNode(
+        server,
+        UA_NODEID_STRING(1, const_cast<char *>(WRITE_STATUS_FOLDER)),
+        UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+        UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+        UA_QUALIFIEDNAME(1, const_cast<char *>(WRITE_STATUS_FOLDER)),
+        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+        oAttr,
+        nullptr,
+        &folderId);
+
+    if (result != UA_STATUSCODE_GOOD)
+    {
+        LOG_ERROR("❌ Error creando carpeta de estado: " << UA_StatusCode_name(result));
+        return;
+    }
+
+    UA_UInt32 zero32 = 0;
+    UA_UInt64 zero64 = 0;
+    UA_String empty = UA_STRING_NULL;
+    addStatusVariable(folderId, WRITE_STATUS_PENDING, "WritesPending", &zero32, &UA_TYPES[UA_TYPES_UINT32]);
+    addStatusVariable(folderId, WRITE_STATUS_COMPLETED, "WritesCompleted", &zero64, &UA_TYPES[UA_TYPES_UINT64]);
+    addStatusVariable(folderId, WRITE_STATUS_FAILED, "WritesFailed", &zero64, &UA_TYPES[UA_TYPES_UINT64]);
+    addStatusVariable(folderId, WRITE_STATUS_COALESCED, "WritesCoalesced", &zero64, &UA_TYPES[UA_TYPES_UINT64]);
+    addStatusVariable(folderId, WRITE_STATUS_LAST, "LastWriteResult", &empty, &UA_TYPES[UA_TYPES_STRING]);
+    addLogLevelsVariable(folderId);
+
+    UA_NodeId_clear(&folderId);
+    LOG_INFO("📊 Variables de estado de escritura creadas en " << WRITE_STATUS_FOLDER);
+}
+
+static void writeStatusValue(const char *nodeName, const void *value, const UA_DataType *type)
+{
+    UA_Variant variant;
+    UA_Variant_init(&variant);
+    UA_Variant_setScalar(&variant, const_cast<void *>(value), type);
+    UA_Server_writeValue(server, UA_NODEID_STRING(1, const_cast<char *>(nodeName)), variant);
+}
+
+// Resultado de la última escritura: lo deja cualquier hilo, los nodos los actualiza el hilo del servidor
+static mutex writeStatusMutex;
+static string lastWriteResult;
+static atomic<bool> writeStatusDirty{false};
+
+void publishWriteStatus(const string &lastResult)
+{
+    {
+        lock_guard<mutex> lock(writeStatusMutex);
+        lastWriteResult = lastResult;
+    }
+    writeStatusDirty.store(true, memory_order_release);
+}
+
+// Hilo del servidor: contadores de las colas (suma de todos los controladores) y última escritura
+static void refreshWriteStatusNodes()
+{
+    if (!writeStatusDirty.exchange(false, memory_order_acquire))
+        return;
+
+    string lastResult;
+    {
+        lock_guard<mutex> lock(writeStatusMutex);
+        lastResult = lastWriteResult;
+    }
+
+    UA_UInt32 pending = 0;
+    UA_UInt64 completed = 0, failed = 0, coalesced = 0;
+    for (const auto &ctrl : controllers)
+    {
+        if (!ctrl->writeQueue)
+            continue;
+        const PACWriteStats &stats = ctrl->writeQueue->getStats();
+        pending += stats.pending.load();
+        completed += stats.completed.load();
+        failed += stats.failed.load();
+        coalesced += stats.coalesced.load();
+    }
+    UA_String last = UA_STRING(const_cast<char *>(lastResult.c_str()));
+
+    writeStatusValue(WRITE_STATUS_PENDING, &pending, &UA_TYPES[UA_TYPES_UINT32]);
+    writeStatusValue(WRITE_STATUS_COMPLETED, &completed, &UA_TYPES[UA_TYPES_UINT64]);
+    writeStatusValue(WRITE_STATUS_FAILED, &failed, &UA_TYPES[UA_TYPES_UINT64]);
+    writeStatusValue(WRITE_STATUS_COALESCED, &coalesced, &UA_TYPES[UA_TYPES_UINT64]);
+    writeStatusValue(WRITE_STATUS_LAST, &last, &UA_TYPES[UA_TYPES_STRING]);
+}
+
+// Búsqueda para callbacks sin contexto de nodo: STRING por índice hash, NUMERIC por id denso
+Variable *findVariableByNodeId(const UA_NodeId &nodeId)
+{
+    if (nodeId.identifierType == UA_NODEIDTYPE_STRING)
+    {
+        string key((const char *)nodeId.identifier.string.data, nodeId.identifier.string.length);
+        auto it = variableByNodeId.find(key);
+        return it != variableByNodeId.end() ? it->second : nullptr;
+    }
+
+    if (nodeId.identifierType == UA_NODEIDTYPE_NUMERIC &&
+        nodeId.identifier.numeric < config.variables.size())
+    {
+        return &config.variables[nodeId.identifier.numeric];
+    }
+
+    return nullptr;
+}
+
+// 👁️ Alta/baja de MonitoredItems: marca qué variables tienen demanda para el hilo de sondeo
+static void monitoredItemRegisterCallback(UA_Server *server,
+                                          const UA_NodeId *sessionId,
+                                          void *sessionContext,
+                                          const UA_NodeId *nodeId,
+                                          void *nodeContext,
+                                          UA_UInt32 attributeId,
+                                          UA_Boolean removed)
+{
+    if (attributeId != UA_ATTRIBUTEID_VALUE || !nodeId)
+        return;
+
+    Variable *var = findVariableByNodeId(*nodeId);
+    if (!var)
+        return;
+
+    subscriptionTracker.onRegister((uint32_t)var->node_id, removed);
+    LOG_DEBUG("👁️ MonitoredItem " << (removed ? "eliminado" : "creado") << ": " << var->opcua_name
+              << " (" << subscriptionTracker.monitoredCount() << " variables vigiladas)");
+}
+
 // Para UA_DataSource.write
 // 🔧 WRITECALLBACK PORTADO DE v1.0.0 - FUNCIONABA PERFECTAMENTE
 static void writeCallback(UA_Server *server,
@@ -531,17 +1029,12 @@ static void writeCallback(UA_Server *server,
                          const UA_NumericRange *range,
                          const UA_DataValue *data) {
     
-    // 🔍 IGNORAR ESCRITURAS INTERNAS DEL SERVIDOR
-    if (server_writing_internally.load()) {
+    // 🔍 IGNORAR ESCRITURAS INTERNAS DEL SERVIDOR (volcado de valores publicados en este hilo)
+    // Las de clientes pasan siempre: el sondeo ya no escribe nodos, sólo publica en valueStore
+    if (writingInternally) {
         LOG_DEBUG("📝 Escritura interna detectada - no propagar al PAC");
         return;
     }
-
-    // 🔒 EVITAR PROCESAMIENTO DURANTE ACTUALIZACIONES
-    if (updating_internally.load()) {
-        LOG_ERROR("Escritura rechazada: servidor actualizando");
-        return;
-    }
     
     // ✅ VALIDACIONES BÁSICAS
     if (!server || !nodeId || !data || !data->value.data) {
@@ -549,100 +1042,100 @@ static void writeCallback(UA_Server *server,
         return;
     }
 
-    // 🔧 MANEJAR NODEID NUMÉRICO (COMO EN v1.0.0)
-    if (nodeId->identifierType != UA_NODEIDTYPE_NUMERIC) {
-        LOG_ERROR("Tipo de NodeId no soportado (esperado numérico)");
-        return;
-    }
-
-    uint32_t numericNodeId = nodeId->identifier.numeric;
-    LOG_INFO("📝 ESCRITURA RECIBIDA en NodeId: " << numericNodeId);
-
-    // 🔍 BUSCAR VARIABLE POR NODEID NUMÉRICO
-    Variable *var = nullptr;
-    for (auto &v : config.variables) {
-        if (v.has_node && v.node_id == (int)numericNodeId) {
-            var = &v;
-            break;
-        }
+    // 🔍 VARIABLE DESDE EL CONTEXTO DEL NODO (O(1)); índice NodeId como respaldo
+    Variable *var = static_cast<Variable *>(nodeContext);
+    if (!var) {
+        var = findVariableByNodeId(*nodeId);
     }
 
-    if (!var) {
-        LOG_ERROR("Variable no encontrada para NodeId: " << numericNodeId);
+    if (!var || !var->has_node) {
+        LOG_ERROR("Variable no encontrada para el NodeId de la escritura");
         return;
     }
 
+    LOG_INFO("📝 ESCRITURA RECIBIDA en: " << var->opcua_name);
+
     if (!var->writable) {
         LOG_ERROR("Variable no escribible: " << var->opcua_name);
         return;
     }
 
-    // 🔒 VERIFICAR CONEXIÓN PAC
-    if (!pacClient || !pacClient->isConnected()) {
-        LOG_ERROR("PAC no conectado para escritura: " << var->opcua_name);
+    // 📥 ENCOLAR en la cola de su controlador: el hilo escritor hace la E/S con el PAC (el bucle del servidor nunca espera)
+    if (var->controller >= (int)controllers.size() || !controllers[var->controller]->writeQueue) {
+        LOG_ERROR("Cola de escritura no inicializada: " << var->opcua_name);
         return;
     }
+    PACWriteQueue &writeQueue = *controllers[var->controller]->writeQueue;
 
-    LOG_INFO("✅ Procesando escritura para: " << var->opcua_name << " (PAC: " << var->pac_source << ")");
+    PACWriteRequest request;
+    request.var_id = (uint32_t)var->node_id;
 
-    // 🎯 PROCESAR ESCRITURA SEGÚN TIPO
-    bool write_success = false;
+    if (var->tag_name == "SimpleVars") {
+        // Variable simple
+        request.target = var->pac_source;
+        request.index = -1;
+    } else {
+        // Variable de tabla por índice
+        size_t pos = var->pac_source.find(':');
+        if (pos == string::npos || var->table_index < 0) {
+            LOG_ERROR("pac_source inválido para escritura: " << var->pac_source);
+            return;
+        }
+        request.target = var->pac_source.substr(0, pos);
+        request.index = var->table_index;
+    }
 
+    // 🎯 VALOR SEGÚN TIPO
     if (var->type == Variable::FLOAT) {
-        if (data->value.type == &UA_TYPES[UA_TYPES_FLOAT]) {
-            float value = *(float*)data->value.data;
-            LOG_INFO("🔧 Escribiendo FLOAT " << value << " a " << var->pac_source);
-            
-            // 🔧 ESCRIBIR AL PAC USANDO FUNCIONES EXISTENTES
-            if (var->tag_name == "SimpleVars") {
-                // Variable simple
-                write_success = pacClient->writeSingleFloatVariable(var->pac_source, value);
-            } else {
-                // Variable de tabla por índice
-                size_t pos = var->pac_source.find(':');
-                if (pos != string::npos) {
-                    string tableName = var->pac_source.substr(0, pos);
-                    int index = stoi(var->pac_source.substr(pos + 1));
-                    write_success = pacClient->writeFloatTableIndex(tableName, index, value);
-                    LOG_INFO("🔧 Escribiendo tabla: " << tableName << "[" << index << "] = " << value);
-                }
-            }
-        } else {
+        if (data->value.type != &UA_TYPES[UA_TYPES_FLOAT]) {
             LOG_ERROR("Tipo de dato incorrecto para variable FLOAT: " << var->opcua_name);
+            return;
         }
+        request.float_value = *(float*)data->value.data;
+        LOG_INFO("🔧 Encolando FLOAT " << request.float_value << " a " << var->pac_source);
     } else if (var->type == Variable::INT32) {
-        if (data->value.type == &UA_TYPES[UA_TYPES_INT32]) {
-            int32_t value = *(int32_t*)data->value.data;
-            LOG_INFO("🔧 Escribiendo INT32 " << value << " a " << var->pac_source);
-            
-            // 🔧 ESCRIBIR AL PAC USANDO FUNCIONES EXISTENTES
-            if (var->tag_name == "SimpleVars") {
-                // Variable simple
-                write_success = pacClient->writeSingleInt32Variable(var->pac_source, value);
-            } else {
-                // Variable de tabla por índice
-                size_t pos = var->pac_source.find(':');
-                if (pos != string::npos) {
-                    string tableName = var->pac_source.substr(0, pos);
-                    int index = stoi(var->pac_source.substr(pos + 1));
-                    write_success = pacClient->writeInt32TableIndex(tableName, index, value);
-                    LOG_INFO("🔧 Escribiendo tabla: " << tableName << "[" << index << "] = " << value);
-                }
-            }
-        } else {
+        if (data->value.type != &UA_TYPES[UA_TYPES_INT32]) {
             LOG_ERROR("Tipo de dato incorrecto para variable INT32: " << var->opcua_name);
+            return;
         }
+        request.is_int32 = true;
+        request.int_value = *(int32_t*)data->value.data;
+        LOG_INFO("🔧 Encolando INT32 " << request.int_value << " a " << var->pac_source);
+    } else {
+        return;
     }
 
-    // ✅ RESULTADO FINAL
-    if (write_success) {
-        LOG_INFO("✅ Escritura exitosa: " << var->opcua_name);
+    writeQueue.push(std::move(request));
+}
+
+// Resultado de una escritura encolada (hilo escritor)
+static void onWriteComplete(const PACWriteRequest &request, bool ok)
+{
+    // 🔄 Publicar la próxima lectura del PAC aunque no cambie: corrige el nodo si la escritura falló
+    changeDetector.invalidate(request.var_id);
+
+    string name = request.var_id < config.variables.size() ? config.variables[request.var_id].opcua_name : request.target;
+    if (request.isRange())
+        name += "[" + to_string(request.index) + ".." + to_string(request.index + (int)request.rangeLength() - 1) + "]";
+    string result;
+    if (ok) {
+        LOG_INFO("✅ Escritura exitosa: " << name);
+        result = "OK " + name;
     } else {
-        LOG_ERROR("❌ Error en escritura: " << var->opcua_name);
+        LOG_ERROR("❌ Error en escritura: " << name);
+        result = "ERROR " + name;
     }
+
+    publishWriteStatus(result);
 }
 
 // 🔧 READCALLBACK PORTADO DE v1.0.0 - SIMPLE Y FUNCIONAL
+static void startRefresh(Controller &ctrl, size_t source);
+static void collectRefreshes(Controller &ctrl, bool wait);
+
+// Lectura OPC-UA: se sirve siempre el valor del nodo; si su fuente es más vieja que read_max_age_ms
+// se lanza un refresco en segundo plano que verán los Read siguientes. Este Read no puede esperarlo:
+// open62541 sólo tiene operaciones asíncronas para métodos y esperar aquí bloquearía el bucle del servidor
 static void readCallback(UA_Server *server,
                         const UA_NodeId *sessionId,
                         void *sessionContext,
@@ -651,17 +1144,76 @@ static void readCallback(UA_Server *server,
                         const UA_NumericRange *range,
                         const UA_DataValue *data) {
     
-    // 🔍 IGNORAR LECTURAS DURANTE ACTUALIZACIONES INTERNAS
-    if (updating_internally.load()) {
+    // 🔍 IGNORAR LECTURAS DURANTE EL VOLCADO INTERNO
+    if (writingInternally) {
         return;
     }
-    
-    // Para este callback de lectura, no necesitamos hacer nada especial
-    // ya que los valores se actualizan desde updateData()
-    
-    if (nodeId && nodeId->identifierType == UA_NODEIDTYPE_NUMERIC) {
-        uint32_t numericNodeId = nodeId->identifier.numeric;
-        LOG_DEBUG("📖 Lectura de NodeId: " << numericNodeId);
+
+    if (config.read_max_age_ms <= 0) {
+        return;
+    }
+
+    Variable *var = static_cast<Variable *>(nodeContext);
+    if (!var && nodeId) {
+        var = findVariableByNodeId(*nodeId);
+    }
+    if (!var || var->controller >= (int)controllers.size() || !controllers[var->controller]->pool) {
+        return;
+    }
+    Controller &ctrl = *controllers[var->controller];
+
+    // 👁️ El muestreo de MonitoredItems también pasa por aquí: esas variables ya las cubre el sondeo
+    if (subscriptionTracker.isMonitored((uint32_t)var->node_id)) {
+        return;
+    }
+
+    size_t source = ctrl.plan.sourceOf((uint32_t)var->node_id);
+    if (source == PollPlan::NO_SOURCE || ctrl.readCache.isFresh(source, chrono::milliseconds(config.read_max_age_ms))) {
+        return;
+    }
+
+    if (ctrl.readCache.beginRefresh(source)) {
+        LOG_DEBUG("📖 Refresco bajo demanda de: " << var->opcua_name);
+        startRefresh(ctrl, source);
+    }
+}
+
+// Carpeta de un controlador en el espacio de direcciones (ObjectsFolder si no tiene nombre)
+static UA_NodeId controllerFolder(int controller)
+{
+    const string &name = config.controllers[controller].name;
+    if (name.empty())
+        return UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    return UA_NODEID_STRING(1, const_cast<char *>(name.c_str()));
+}
+
+static void createControllerFolders()
+{
+    for (const auto &controller : config.controllers)
+    {
+        if (controller.name.empty())
+            continue;
+
+        UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+        oAttr.displayName = UA_LOCALIZEDTEXT(const_cast<char *>("en"), const_cast<char *>(controller.name.c_str()));
+        string description = controller.ip + ":" + to_string(controller.port);
+        oAttr.description = UA_LOCALIZEDTEXT(const_cast<char *>("en"), const_cast<char *>(description.c_str()));
+
+        UA_StatusCode result = UA_Server_addObjectNode(
+            server,
+            UA_NODEID_STRING(1, const_cast<char *>(controller.name.c_str())),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+            UA_QUALIFIEDNAME(1, const_cast<char *>(controller.name.c_str())),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+            oAttr,
+            nullptr,
+            nullptr);
+
+        if (result != UA_STATUSCODE_GOOD)
+        {
+            LOG_ERROR("❌ Error creando carpeta del controlador " << controller.name << ": " << UA_StatusCode_name(result));
+        }
     }
 }
 
@@ -675,19 +1227,24 @@ void createNodes()
         return;
     }
 
-    // 🗂️ AGRUPAR VARIABLES POR TAG (COMO EN LA VERSIÓN ORIGINAL)
-    map<string, vector<Variable *>> tagVars;
+    // 🏭 UNA CARPETA POR CONTROLADOR CON NOMBRE (sin nombre: los TAGs cuelgan de ObjectsFolder)
+    createControllerFolders();
+
+    // 🗂️ AGRUPAR VARIABLES POR CONTROLADOR Y TAG (COMO EN LA VERSIÓN ORIGINAL)
+    map<pair<int, string>, vector<Variable *>> tagVars;
     for (auto &var : config.variables)
     {
-        tagVars[var.tag_name].push_back(&var);
+        tagVars[{var.controller, var.tag_name}].push_back(&var);
     }
 
     LOG_INFO("📊 Creando " << tagVars.size() << " TAGs con estructura jerárquica");
 
     // 🏗️ CREAR CADA TAG CON SUS VARIABLES (ESTRUCTURA ORIGINAL)
-    for (const auto &[tagName, variables] : tagVars)
+    for (const auto &[key, variables] : tagVars)
     {
-        LOG_INFO("📁 Creando TAG: " << tagName << " (" << variables.size() << " variables)");
+        const string &tagName = key.second;
+        string tagNodeName = nodePrefix(key.first) + tagName;
+        LOG_INFO("📁 Creando TAG: " << tagNodeName << " (" << variables.size() << " variables)");
 
         // 🏗️ CREAR NODO TAG COMO CARPETA PADRE
         UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
@@ -696,8 +1253,8 @@ void createNodes()
         UA_NodeId tagNodeId;
         UA_StatusCode result = UA_Server_addObjectNode(
             server,
-            UA_NODEID_STRING(1, const_cast<char *>(tagName.c_str())), // 🔧 STRING NodeId
-            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),             // Bajo ObjectsFolder
+            UA_NODEID_STRING(1, const_cast<char *>(tagNodeName.c_str())), // 🔧 STRING NodeId
+            controllerFolder(key.first),                                  // Bajo su controlador u ObjectsFolder
             UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),                 // Relación
             UA_QUALIFIEDNAME(1, const_cast<char *>(tagName.c_str())), // Nombre calificado
             UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),            // Tipo base
@@ -708,11 +1265,11 @@ void createNodes()
 
         if (result != UA_STATUSCODE_GOOD)
         {
-            LOG_ERROR("❌ Error creando TAG: " << tagName << " - " << UA_StatusCode_name(result));
+            LOG_ERROR("❌ Error creando TAG: " << tagNodeName << " - " << UA_StatusCode_name(result));
             continue;
         }
 
-        LOG_DEBUG("✅ TAG creado: " << tagName);
+        LOG_DEBUG("✅ TAG creado: " << tagNodeName);
 
         // 🔧 CREAR VARIABLES BAJO EL TAG (COMO HIJOS)
         int created_vars = 0;
@@ -820,7 +1377,7 @@ void createNodes()
                     UA_QUALIFIEDNAME(1, const_cast<char *>(var->var_name.c_str())), // Nombre calificado (solo variable)
                     UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),            // Tipo base
                     vAttr,
-                    nullptr,
+                    var,                                                            // 🔑 Contexto: Variable* (lookup O(1) en callbacks)
                     nullptr);
 
                 if (result == UA_STATUSCODE_GOOD)
@@ -844,7 +1401,7 @@ void createNodes()
             }
         }
 
-        LOG_DEBUG("✅ TAG " << tagName << " completado: " << created_vars << "/" << variables.size() << " variables creadas");
+        LOG_DEBUG("✅ TAG " << tagNodeName << " completado: " << created_vars << "/" << variables.size() << " variables creadas");
     }
 
     // 🔧 RESUMEN FINAL - SOLO UNA VEZ
@@ -866,8 +1423,12 @@ void createNodes()
     LOG_INFO("   📝 Variables escribibles: " << config.getWritableVariableCount());
     LOG_INFO("   🔢 Tipos asignados: " << floatNodes << " FLOAT, " << int32Nodes << " INT32");
 
+    // 📊 VARIABLES DE ESTADO DE LA COLA DE ESCRITURA
+    createWriteStatusNodes();
+
     // 🔧 ACTIVAR CALLBACKS INMEDIATAMENTE DESPUÉS DE CREAR NODOS
     enableWriteCallbacksOnce();
+    enableReadThroughCallbacks();
 
     // 🔧 ESCRIBIR VALORES POR DEFECTO A VARIABLES ESCRIBIBLES
     writeDefaultValuesToWritableVariables();
@@ -878,312 +1439,391 @@ void createNodes()
 
 // ============== ACTUALIZACIÓN DE DATOS ==============
 
-void updateData()
+// Publica en valueStore los valores leídos para un lote del plan (el hilo del servidor los vuelca)
+// Sólo se publican los valores que salen de la banda muerta; devuelve el número de variables publicadas
+static int publishPollResults(const PollPlan &plan, const PollBatch &batch, const PollCycleResult &cycle,
+                              PACMetrics &metrics, int64_t readAtNs)
 {
-    static auto lastReconnect = chrono::steady_clock::now();
+    int vars_updated = 0;
+    int vars_unchanged = 0;
 
-    while (running && server_running)
+    // 📋 VARIABLES SIMPLES
+    for (const ScalarReadDescriptor *desc : batch.scalar_desc)
     {
-        // Solo log cuando inicia ciclo completo
-        LOG_DEBUG("Iniciando ciclo de actualización PAC");
+        Variable *var = desc->var;
+        if (!var->has_node)
+            continue;
 
-        // 🔒 VERIFICAR SI ES SEGURO HACER ACTUALIZACIONES
-        if (updating_internally.load())
+        auto it = cycle.scalars.find(var->pac_source);
+        if (it == cycle.scalars.end() || !it->second.ok)
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            LOG_DEBUG("❌ Sin respuesta para variable simple: " << var->pac_source);
             continue;
         }
 
-        if (pacClient && pacClient->isConnected())
+        float floatValue = it->second.float_value;
+        int32_t intValue = it->second.int_value;
+        bool isInt32 = var->type == Variable::INT32;
+        bool changed = isInt32 ? changeDetector.acceptInt32(desc->var_id, intValue)
+                               : changeDetector.acceptFloat(desc->var_id, floatValue, var->deadband);
+
+        // Las SimpleVars escribibles no tienen callback: un cliente puede haber cambiado el nodo
+        if (!changed && !var->writable)
         {
-            // 🔧 VALIDACIÓN DE TIPOS ANTES DE ACTUALIZAR
-            static bool typesValidated = false;
-         
+            vars_unchanged++;
+            continue;
+        }
 
-            // ⚠️ MARCAR ACTUALIZACIÓN EN PROGRESO
-            updating_internally.store(true);
+        if (isInt32)
+            valueStore.publishInt32(desc->var_id, intValue, readAtNs);
+        else
+            valueStore.publishFloat(desc->var_id, floatValue, readAtNs);
+        vars_updated++;
+    }
+
+    // 📊 VARIABLES DE TABLA: cada descriptor apunta a su rango de destinos precompilado
+    const vector<PollSlot> &slots = plan.getSlots();
+    for (size_t t = 0; t < batch.table_desc.size(); t++)
+    {
+        const TableReadDescriptor &desc = *batch.table_desc[t];
+        const TableReadResult &data = cycle.tables[t];
 
-            // 🔒 ACTIVAR BANDERA DE ESCRITURA INTERNA DEL SERVIDOR (EVITAR CALLBACKS)
-            server_writing_internally.store(true);
+        if (!data.ok)
+        {
+            LOG_ERROR("❌ Error leyendo tabla: " << desc.request.table_name);
+            continue;
+        }
 
-            // Separar variables por tipo
-            vector<Variable *> simpleVars;             // Variables individuales (F_xxx, I_xxx)
-            map<string, vector<Variable *>> tableVars; // Variables de tabla (TBL_xxx:índice)
+        // Valores decodificados en el almacén del plan (o en el resultado si no tenía destino)
+        size_t decoded = min(data.count, desc.value_count);
+        span<const float> floats;
+        span<const int32_t> ints;
+        if (desc.request.is_int32)
+            ints = data.ints.empty() ? plan.int32Values(desc).first(decoded) : span<const int32_t>(data.ints);
+        else
+            floats = data.floats.empty() ? plan.floatValues(desc).first(decoded) : span<const float>(data.floats);
 
-            for (auto &var : config.variables)
+        for (size_t s = desc.first_slot; s < desc.first_slot + desc.slot_count; s++)
+        {
+            Variable *var = slots[s].var;
+            const uint32_t var_id = slots[s].var_id;
+            const int index = slots[s].index;
+            if (!var->has_node)
+                continue;
+
+            if (desc.request.is_int32)
             {
-                if (!var.has_node)
+                if (index >= (int)ints.size())
                     continue;
 
-                // Verificar si es variable de tabla o simple
-                size_t pos = var.pac_source.find(':');
-                if (pos != std::string::npos)
+                int32_t intValue = ints[index];
+                if (!changeDetector.acceptInt32(var_id, intValue))
                 {
-                    // Variable de tabla
-                    string table = var.pac_source.substr(0, pos);
-                    tableVars[table].push_back(&var);
-                }
-                else
-                {
-                    // Variable simple (F_xxx, I_xxx)
-                    simpleVars.push_back(&var);
+                    vars_unchanged++;
+                    continue;
                 }
+                valueStore.publishInt32(var_id, intValue, readAtNs);
+                LOG_DEBUG("📝 " << var->opcua_name << " = " << intValue << " (INT32 desde alarma)");
             }
-
-            // 📋 ACTUALIZAR VARIABLES SIMPLES PRIMERO
-            if (!simpleVars.empty())
+            else
             {
-                LOG_DEBUG("📋 Actualizando " << simpleVars.size() << " variables simples...");
+                if (index >= (int)floats.size())
+                    continue;
 
-                for (const auto &var : simpleVars)
+                float floatValue = floats[index];
+                if (!changeDetector.acceptFloat(var_id, floatValue, var->deadband))
                 {
-                    try
-                    {
-                        UA_NodeId nodeId = UA_NODEID_STRING(1, const_cast<char *>(var->opcua_name.c_str()));
-                        UA_Variant value;
-                        UA_Variant_init(&value);
-
-                        if (var->type == Variable::FLOAT)
-                        {
-                            float newValue = pacClient->readSingleFloatVariableByTag(var->pac_source);
-                            UA_Variant_setScalar(&value, &newValue, &UA_TYPES[UA_TYPES_FLOAT]);
-                        }
-                        else if (var->type == Variable::INT32)
-                        {
-                            int32_t newValue = pacClient->readSingleInt32VariableByTag(var->pac_source);
-                            UA_Variant_setScalar(&value, &newValue, &UA_TYPES[UA_TYPES_INT32]);
-                        }
-
-                        UA_StatusCode result = UA_Server_writeValue(server, nodeId, value);
-                        if (result != UA_STATUSCODE_GOOD)
-                        {
-                            LOG_ERROR("❌ Error actualizando: " << var->opcua_name);
-                        }
-                    }
-                    catch (const std::exception &e)
-                    {
-                        LOG_ERROR("❌ Excepción: " << var->pac_source << " - " << e.what());
-                    }
+                    vars_unchanged++;
+                    continue;
                 }
+                valueStore.publishFloat(var_id, floatValue, readAtNs);
+                LOG_DEBUG("📝 " << var->opcua_name << " = " << floatValue << " (FLOAT directo)");
             }
+            vars_updated++;
+        }
+    }
 
-            // 📊 ACTUALIZAR VARIABLES DE TABLA (código existente)
-            int tables_updated = 0;
-            for (const auto &[tableName, vars] : tableVars)
-            {
-                if (vars.empty())
-                    continue;
+    metrics.values_published.fetch_add(vars_updated, memory_order_relaxed);
+    metrics.values_suppressed.fetch_add(vars_unchanged, memory_order_relaxed);
 
-                LOG_DEBUG("📋 Actualizando tabla: " << tableName << " (" << vars.size() << " variables)");
+    LOG_DEBUG("📉 Sin cambios (banda muerta): " << vars_unchanged << " variables");
+    return vars_updated;
+}
 
-                // Determinar rango de índices
-                vector<int> indices;
-                for (const auto &var : vars)
-                {
-                    size_t pos = var->pac_source.find(':');
-                    if (pos != std::string::npos)
-                    {
-                        int index = stoi(var->pac_source.substr(pos + 1));
-                        indices.push_back(index);
-                    }
-                }
+// Instante de lectura para sourceTimestamp (ns de system_clock)
+static int64_t wallClockNs()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
 
-                if (indices.empty())
-                {
-                    LOG_DEBUG("⚠️ Tabla sin índices válidos: " << tableName);
-                    continue;
-                }
+// 🔄 Hilo del servidor: vuelca al espacio de direcciones lo publicado desde el último volcado
+// (callback periódico del servidor, lectura bajo demanda y arranque; nunca desde otro hilo)
+static size_t applyPublishedValues()
+{
+    if (!server)
+        return 0;
 
-                int minIndex = *min_element(indices.begin(), indices.end());
-                int maxIndex = *max_element(indices.begin(), indices.end());
+    writingInternally = true;
+    size_t applied = valueStore.drain([](const PublishedValue &published) {
+        const Variable &var = config.variables[published.id];
 
-                LOG_DEBUG("🔢 Leyendo tabla " << tableName << " índices [" << minIndex << "-" << maxIndex << "]");
+        UA_NodeId nodeId = UA_NODEID_STRING(1, const_cast<char *>(var.opcua_name.c_str()));
+        UA_DataValue value;
+        UA_DataValue_init(&value);
 
-                // Leer datos del PAC
-                bool isAlarmTable = tableName.find("TBL_DA_") == 0 ||
-                                    tableName.find("TBL_PA_") == 0 ||
-                                    tableName.find("TBL_LA_") == 0 ||
-                                    tableName.find("TBL_TA_") == 0;
+        int32_t intValue = published.asInt32();
+        float floatValue = published.asFloat();
+        if (published.is_int32)
+            UA_Variant_setScalar(&value.value, &intValue, &UA_TYPES[UA_TYPES_INT32]);
+        else
+            UA_Variant_setScalar(&value.value, &floatValue, &UA_TYPES[UA_TYPES_FLOAT]);
+        value.hasValue = true;
 
-                if (isAlarmTable)
-                {
-                    // 🚨 LEER TABLA DE ALARMAS (INT32)
-                    vector<int32_t> values = pacClient->readInt32Table(tableName, minIndex, maxIndex);
-
-                    if (values.empty())
-                    {
-                        LOG_DEBUG("❌ Error leyendo tabla INT32: " << tableName);
-                        continue;
-                    }
-
-                    LOG_DEBUG("✅ Leída tabla INT32: " << tableName << " (" << values.size() << " valores)");
-
-                    // Actualizar variables
-                    int vars_updated = 0;
-                    for (const auto &var : vars)
-                    {
-                        // 🔒 VERIFICAR SI VARIABLE TIENE ESCRITURA PENDIENTE
-                        if (var->writable && WriteRegistrationManager::isWriteRegistered(var->opcua_name)) {
-                            LOG_DEBUG("🔒 Saltando variable de tabla con escritura pendiente: " << var->opcua_name);
-                            continue;
-                        }
-
-                        // 🔧 PROCESAR TODAS LAS VARIABLES (resto del código igual)
-                        size_t pos = var->pac_source.find(':');
-                        int index = stoi(var->pac_source.substr(pos + 1));
-                        int arrayIndex = index - minIndex;
-
-                        if (arrayIndex >= 0 && arrayIndex < (int)values.size())
-                        {
-                            UA_NodeId nodeId = UA_NODEID_STRING(1, const_cast<char *>(var->opcua_name.c_str()));
-
-                            UA_Variant value;
-                            UA_Variant_init(&value);
-
-                            // Usar datos INT32 directamente
-                            int32_t newValue = values[arrayIndex];
-                            UA_Variant_setScalar(&value, &newValue, &UA_TYPES[UA_TYPES_INT32]);
-
-                            LOG_DEBUG("📝 " << var->opcua_name << " = " << newValue << " (INT32 desde alarma)");
-
-                            UA_StatusCode result = UA_Server_writeValue(server, nodeId, value);
-
-                            if (result == UA_STATUSCODE_GOOD)
-                            {
-                                vars_updated++;
-                                
-                                // 🔧 CONSUMIR ESCRITURA SI EXISTE
-                                if (var->writable) {
-                                    WriteRegistrationManager::consumeWrite(var->opcua_name);
-                                }
-                            }
-                            else
-                            {
-                                LOG_ERROR("❌ Error actualizando alarma " << var->opcua_name << ": " << UA_StatusCode_name(result));
-                            }
-                        }
-                        else
-                        {
-                            // 🔧 VALOR POR DEFECTO SI ESTÁ FUERA DE RANGO
-                            UA_NodeId nodeId = UA_NODEID_STRING(1, const_cast<char *>(var->opcua_name.c_str()));
-                            UA_Variant value;
-                            UA_Variant_init(&value);
-
-                            if (var->type == Variable::INT32)
-                            {
-                                int32_t defaultValue = 0;
-                                UA_Variant_setScalar(&value, &defaultValue, &UA_TYPES[UA_TYPES_INT32]);
-                            }
-                            else
-                            {
-                                float defaultValue = 0.0f;
-                                UA_Variant_setScalar(&value, &defaultValue, &UA_TYPES[UA_TYPES_FLOAT]);
-                            }
-
-                            UA_Server_writeValue(server, nodeId, value);
-                            LOG_DEBUG("📝 " << var->opcua_name << " = 0 (valor por defecto - fuera de rango)");
-                        }
-                    }
-
-                    if (vars_updated > 0)
-                    {
-                        LOG_DEBUG("✅ Tabla alarmas " << tableName << ": " << vars_updated << " variables actualizadas");
-                    }
-                }
-                else
-                {
-                    // 🔧 TABLAS NORMALES - USAR readFloatTable()
-                    LOG_DEBUG("📊 Leyendo tabla de DATOS (FLOAT): " << tableName);
-
-                    vector<float> float_values = pacClient->readFloatTable(tableName, minIndex, maxIndex);
-                    if (float_values.empty())
-                    {
-                        LOG_ERROR("❌ Error leyendo tabla de datos: " << tableName);
-                        continue;
-                    }
-
-                    LOG_DEBUG("✅ Tabla datos leída: " << float_values.size() << " valores float");
-
-                    // Actualizar variables de datos
-                    int vars_updated = 0;
-                    for (const auto &var : vars)
-                    {
-                        size_t pos = var->pac_source.find(':');
-                        int index = stoi(var->pac_source.substr(pos + 1));
-                        int arrayIndex = index - minIndex;
-
-                        if (arrayIndex >= 0 && arrayIndex < (int)float_values.size())
-                        {
-                            UA_NodeId nodeId = UA_NODEID_STRING(1, const_cast<char *>(var->opcua_name.c_str()));
-
-                            UA_Variant value;
-                            UA_Variant_init(&value);
-
-                            // Nodo FLOAT: usar valor directo del PAC
-                            float floatValue = float_values[arrayIndex];
-                            UA_Variant_setScalar(&value, &floatValue, &UA_TYPES[UA_TYPES_FLOAT]);
-
-                            LOG_DEBUG("📝 " << var->opcua_name << " = " << floatValue << " (FLOAT directo)");
-
-                            UA_StatusCode result = UA_Server_writeValue(server, nodeId, value);
-
-                            if (result == UA_STATUSCODE_GOOD)
-                            {
-                                vars_updated++;
-                            }
-                            else
-                            {
-                                LOG_ERROR("❌ Error actualizando " << var->opcua_name << ": " << UA_StatusCode_name(result));
-
-                                // 🔧 NO INTENTAR CORREGIR - SOLO REPORTAR
-                                // NO escribir valores por defecto aquí
-                            }
-                        }
-                    }
-
-                    if (vars_updated > 0)
-                    {
-                        LOG_DEBUG("✅ Tabla datos " << tableName << ": " << vars_updated << " variables actualizadas");
-                    }
-                }
+        // Cuándo se leyó del PAC, no cuándo se volcó
+        value.sourceTimestamp = published.read_at_ns / 100 + UA_DATETIME_UNIX_EPOCH;
+        value.hasSourceTimestamp = true;
 
-                tables_updated++;
+        UA_StatusCode result = UA_Server_writeDataValue(server, nodeId, value);
+        if (result != UA_STATUSCODE_GOOD)
+        {
+            changeDetector.invalidate(published.id);
+            LOG_ERROR("❌ Error actualizando " << var.opcua_name << ": " << UA_StatusCode_name(result));
+        }
+    });
+    refreshWriteStatusNodes();
+    writingInternally = false;
+    return applied;
+}
 
-                // Pequeña pausa entre tablas
-                this_thread::sleep_for(chrono::milliseconds(50));
-            }
+static void publishValuesCallback(UA_Server *server, void *data)
+{
+    for (auto &ctrl : controllers)
+    {
+        if (!ctrl->refreshes.empty())
+            collectRefreshes(*ctrl, false);
+    }
+    applyPublishedValues();
+}
+
+// Fuentes leídas bien en un lote: frescas desde el inicio de la lectura
+static void markBatchFresh(ReadThroughCache &readCache, const PollBatch &batch, const PollCycleResult &cycle,
+                           chrono::steady_clock::time_point readAt)
+{
+    for (size_t t = 0; t < batch.table_desc.size() && t < cycle.tables.size(); t++)
+    {
+        if (cycle.tables[t].ok)
+            readCache.markFresh(batch.table_desc[t]->source_id, readAt);
+    }
+
+    for (const ScalarReadDescriptor *desc : batch.scalar_desc)
+    {
+        auto it = cycle.scalars.find(desc->var->pac_source);
+        if (it != cycle.scalars.end() && it->second.ok)
+            readCache.markFresh(desc->source_id, readAt);
+    }
+}
+
+// Refresco bajo demanda de una fuente: se envía por una sesión de sondeo ya conectada y sin esperar
+// (el motor de E/S la intercala con el ciclo); collectRefreshes la publica cuando termina
+static void startRefresh(Controller &ctrl, size_t source)
+{
+    auto refresh = make_unique<PendingRefresh>();
+    refresh->source = source;
+    refresh->started = chrono::steady_clock::now();
+    refresh->read_at_ns = wallClockNs();
+
+    PollBatch &batch = refresh->batch;
+    if (const TableReadDescriptor *desc = ctrl.plan.tableSource(source))
+    {
+        // Sin destino: el almacén del plan es del hilo de sondeo, el resultado va a floats/ints
+        TableReadRequest request = desc->request;
+        request.float_dest = {};
+        request.int_dest = {};
+        batch.tables.push_back(request);
+        batch.table_desc.push_back(desc);
+    }
+    else if (const ScalarReadDescriptor *desc = ctrl.plan.scalarSource(source))
+    {
+        batch.scalars.emplace_back(desc->var->pac_source, desc->var->type == Variable::INT32 ? "INT32" : "FLOAT");
+        batch.scalar_desc.push_back(desc);
+    }
 
-            // 🔓 DESACTIVAR BANDERAS
-            server_writing_internally.store(false);
-            updating_internally.store(false);
+    // Nunca reconectar desde aquí: sin sesión de lectura conectada se sirve lo que hay
+    PACControlClient *session = ctrl.pool ? ctrl.pool->reader() : nullptr;
+    if (!session || (batch.tables.empty() && batch.scalars.empty()))
+    {
+        ctrl.readCache.endRefresh(source, false, refresh->started);
+        return;
+    }
 
-            LOG_DEBUG("✅ Actualización completada: " << tables_updated << " tablas procesadas");
+    if (!batch.tables.empty())
+    {
+        refresh->cycle.tables.resize(1);
+        refresh->done = session->readTablesAsync(batch.tables, {0}, refresh->cycle.tables, 1);
+    }
+    else
+    {
+        refresh->done = session->readScalarsAsync(batch.scalars, refresh->cycle.scalars);
+    }
+    ctrl.refreshes.push_back(std::move(refresh));
+}
+
+// Hilo del servidor: publica los refrescos terminados (wait = esperar a todos, al cerrar)
+static void collectRefreshes(Controller &ctrl, bool wait)
+{
+    auto &refreshes = ctrl.refreshes;
+    for (size_t i = 0; i < refreshes.size();)
+    {
+        PendingRefresh &refresh = *refreshes[i];
+        if (!wait && refresh.done.wait_for(chrono::seconds(0)) != future_status::ready)
+        {
+            i++;
+            continue;
         }
+        refresh.done.wait();
+
+        bool ok = false;
+        if (!refresh.batch.tables.empty())
+            ok = refresh.cycle.tables[0].ok;
         else
         {
-            // 🔌 SIN CONEXIÓN PAC - INTENTAR RECONECTAR
+            auto it = refresh.cycle.scalars.find(refresh.batch.scalars[0].first);
+            ok = it != refresh.cycle.scalars.end() && it->second.ok;
+        }
+
+        // Misma ruta que el sondeo (el lock sólo cubre la banda muerta); el volcado lo hace applyPublishedValues.
+        // Un ciclo que empezó después del refresco ya publicó valores más nuevos: no pisarlos
+        // (el sondeo marca la fuente bajo el mismo lock)
+        if (ok && !wait)
+        {
+            lock_guard<mutex> publishLock(ctrl.publishMutex);
+            if (ctrl.readCache.readAfter(refresh.source, refresh.started))
+            {
+                LOG_DEBUG("📖 Refresco descartado: el sondeo ya publicó un valor más reciente");
+            }
+            else
+            {
+                publishPollResults(ctrl.plan, refresh.batch, refresh.cycle, *ctrl.metrics, refresh.read_at_ns);
+            }
+        }
+        ctrl.readCache.endRefresh(refresh.source, ok, refresh.started);
+
+        refreshes[i] = std::move(refreshes.back());
+        refreshes.pop_back();
+    }
+}
+
+// Bucle de sondeo de un controlador: su propio planificador, sesiones y deadlines
+static void pollController(Controller &ctrl)
+{
+    auto lastReconnect = chrono::steady_clock::now();
+    uint64_t demandGeneration = 0;
+    uint64_t reportedOverruns = 0;   // Overruns del planificador ya sumados a las métricas
+    PollPlan &pollPlan = ctrl.plan;
+    const string name = ctrl.cfg.name.empty() ? "PAC" : ctrl.cfg.name;
+
+    // 🕒 CLASES DE ESCANEO (compiladas en el plan de sondeo)
+    PollScheduler scheduler(pollPlan.classPeriods());
+    LOG_INFO("🕒 Clases de escaneo de " << name << ": " << scheduler.size());
+    for (const auto &scanClass : scheduler.getClasses())
+    {
+        LOG_INFO("   ⏱️ " << scanClass.period_ms << " ms");
+    }
+
+    while (running && server_running)
+    {
+        // ⏱️ ESPERAR AL PRÓXIMO DEADLINE (fusiona las clases que vencen juntas)
+        vector<size_t> due = scheduler.waitForDue(running);
+        if (due.empty())
+            continue;
+
+        auto cycleStart = chrono::steady_clock::now();
+        int64_t readAtNs = wallClockNs();
+
+        // Solo log cuando inicia ciclo completo
+        LOG_DEBUG("Iniciando ciclo de actualización PAC (" << due.size() << " clases vencidas)");
+
+        // 👁️ RECALCULAR DEMANDA SI CAMBIARON LAS SUSCRIPCIONES (generación antes de la instantánea)
+        uint64_t generation = subscriptionTracker.generation();
+        if (pollPlan.hasBackgroundClass() && generation != demandGeneration)
+        {
+            demandGeneration = generation;
+            pollPlan.applyDemand(subscriptionTracker.snapshot());
+            LOG_INFO("👁️ Demanda actualizada en " << name << ": " << pollPlan.demandedTables() << "/" << pollPlan.tableCount()
+                     << " tablas y " << pollPlan.demandedScalars() << "/" << pollPlan.scalarCount()
+                     << " escalares vigilados");
+        }
+
+        // 🔄 REABRIR SESIONES CAÍDAS (cada 10 s como máximo)
+        if (ctrl.pool && ctrl.pool->connectedSessions() < ctrl.pool->sessionCount())
+        {
             auto now = chrono::steady_clock::now();
             if (chrono::duration_cast<chrono::seconds>(now - lastReconnect).count() >= 10)
             {
-                LOG_DEBUG("🔄 Intentando reconectar al PAC: " << config.pac_ip << ":" << config.pac_port);
+                LOG_DEBUG("🔄 Reabriendo sesiones PAC: " << ctrl.cfg.ip << ":" << ctrl.cfg.port);
+                ctrl.pool->reconnectDeadSessions();
+                lastReconnect = now;
+            }
+        }
 
-                pacClient.reset();
-                pacClient = make_unique<PACControlClient>(config.pac_ip, config.pac_port);
+        // 📡 LOTE PRECOMPILADO DE LAS CLASES VENCIDAS (vacío si nada en ellas está vigilado)
+        const PollBatch &batch = pollPlan.batchFor(due);
+        bool hasReads = !batch.tables.empty() || !batch.scalars.empty();
 
-                if (pacClient->connect())
-                {
-                    LOG_DEBUG("✅ Reconectado al PAC exitosamente");
-                }
-                else
-                {
-                    LOG_DEBUG("❌ Fallo en reconexión al PAC");
-                }
-                lastReconnect = now;
+        if (hasReads && ctrl.pool && ctrl.pool->isConnected())
+        {
+            // Tablas en pipeline y escalares en lote, en paralelo entre sesiones
+            PollCycleResult cycle = ctrl.pool->readCycle(batch.tables, batch.scalars, ctrl.cfg.pipeline_depth);
+
+            // Publicar sin tocar nodos: el hilo del servidor los vuelca en su callback periódico,
+            // así las escrituras de operador nunca compiten con el ciclo
+            int vars_updated = 0;
+            {
+                lock_guard<mutex> publishLock(ctrl.publishMutex);
+                vars_updated = publishPollResults(pollPlan, batch, cycle, *ctrl.metrics, readAtNs);
+                markBatchFresh(ctrl.readCache, batch, cycle, cycleStart);
+            }
+
+            auto cycleEnd = chrono::steady_clock::now();
+            ctrl.metrics->cycle_time.record(chrono::duration_cast<chrono::microseconds>(cycleEnd - cycleStart).count());
+            ctrl.metrics->cycles.fetch_add(1, memory_order_relaxed);
+
+            if (pollCycleObserver)
+            {
+                double cycle_ms = chrono::duration<double, milli>(cycleEnd - cycleStart).count();
+                pollCycleObserver(cycle, cycle_ms);
             }
+
+            LOG_DEBUG("✅ Actualización de " << name << " completada: " << batch.tables.size() << " tablas, "
+                      << vars_updated << " variables publicadas");
         }
 
-        // ⏱️ ESPERAR INTERVALO DE ACTUALIZACIÓN
-        this_thread::sleep_for(chrono::milliseconds(config.update_interval_ms));
+        // 📅 REPROGRAMAR EN DEADLINE ABSOLUTO (reporta overruns en lugar de derivar)
+        scheduler.complete(due, cycleStart, chrono::steady_clock::now());
+
+        uint64_t overruns = 0;
+        for (const auto &scanClass : scheduler.getClasses())
+            overruns += scanClass.overruns;
+        ctrl.metrics->overruns.fetch_add(overruns - reportedOverruns, memory_order_relaxed);
+        reportedOverruns = overruns;
+    }
+
+    LOG_DEBUG("🛑 Hilo de sondeo de " << name << " terminado");
+}
+
+void updateData()
+{
+    // 🏭 UN HILO DE SONDEO POR CONTROLADOR: la E/S de un PAC lento no retrasa a los demás
+    // (todos comparten el motor de E/S y publican en valueStore; los nodos sólo los toca el hilo del servidor)
+    vector<thread> pollers;
+    for (auto &ctrl : controllers)
+    {
+        pollers.emplace_back(pollController, ref(*ctrl));
+    }
+
+    for (auto &poller : pollers)
+    {
+        poller.join();
     }
 
     LOG_DEBUG("🛑 Hilo de actualización terminado");
@@ -1191,19 +1831,28 @@ void updateData()
 
 // ============== FUNCIONES PRINCIPALES ==============
 
-bool ServerInit()
+void setPollCycleObserver(PollCycleObserver observer)
+{
+    // Debe llamarse antes de runServer(): el hilo de actualización lo lee sin lock
+    pollCycleObserver = std::move(observer);
+}
+
+bool ServerInit(const std::string &configFile)
 {
     LOG_INFO("🚀 Inicializando servidor OPC-UA...");
 
     // Cargar configuración
-    if (!loadConfig("tags.json"))
+    if (!loadConfig(configFile))
     {
         LOG_ERROR("Error cargando configuración");
         return false;
     }
 
-    // Crear servidor
-    server = UA_Server_new();
+    // Crear servidor en el puerto configurado (UA_Server_new() siempre escucha en 4840)
+    UA_ServerConfig initial_config;
+    memset(&initial_config, 0, sizeof(UA_ServerConfig));
+    UA_ServerConfig_setMinimal(&initial_config, static_cast<UA_UInt16>(config.opcua_port), nullptr);
+    server = UA_Server_newWithConfig(&initial_config);
     if (!server)
     {
         LOG_ERROR("Error creando servidor OPC-UA");
@@ -1218,16 +1867,78 @@ bool ServerInit()
     server_config->applicationDescription.applicationName =
         UA_LOCALIZEDTEXT(const_cast<char *>("en"), const_cast<char *>(config.server_name.c_str()));
 
+    // 👁️ Sondeo bajo demanda: seguir las suscripciones de los clientes
+    // (también con lectura bajo demanda: el muestreo de MonitoredItems no debe ir al PAC)
+    if (config.poll_on_demand || config.read_max_age_ms > 0)
+        server_config->monitoredItemRegisterCallback = monitoredItemRegisterCallback;
+    if (config.poll_on_demand)
+    {
+        LOG_INFO("👁️ Sondeo bajo demanda: variables vigiladas a su ritmo, resto cada "
+                 << config.background_refresh_ms << " ms");
+    }
+
     LOG_INFO("📡 Servidor configurado en puerto " << config.opcua_port);
 
+    // 📼 Captura de tramas (antes de conectar: el anillo registra también las aperturas)
+    if (!config.packet_capture_file.empty())
+    {
+        shared_ptr<PacketCapture> capture =
+            PacketCapture::create(config.packet_capture_file, (size_t)max(config.packet_capture_mb, 1) << 20);
+        if (capture)
+        {
+            captureEngine = PACIoEngine::shared();
+            captureEngine->setCapture(capture);
+        }
+    }
+
     // Crear nodos
     createNodes();
 
     // 🔧 ELIMINAR ESTA LÍNEA - NO NECESITAMOS verifyAndFixNodeTypes
     // verifyAndFixNodeTypes();
 
-    // Inicializar cliente PAC
-    pacClient = std::make_unique<PACControlClient>(config.pac_ip, config.pac_port);
+    for (auto &ctrl : controllers)
+    {
+        // Pool de sesiones del controlador (si createNodes() no lo creó ya)
+        PACConnectionPool &pool = ensurePool(*ctrl);
+
+        // Cola de escrituras asíncrona sobre la sesión dedicada del pool
+        ctrl->writeQueue = std::make_unique<PACWriteQueue>(pool, onWriteComplete);
+
+        // Arrays de tabla: lecturas por las sesiones de sondeo, escrituras por la cola del controlador
+        ctrl->arraySource = std::make_unique<PACArraySource>(pool, *ctrl->writeQueue, ctrl->index,
+                                                             chrono::milliseconds(config.read_max_age_ms));
+        ctrl->arraySource->createNodes(server, config.array_tags, controllerFolder(ctrl->index), ctrl->prefix);
+
+        // 📈 Diagnóstico: métricas del controlador como variables de sólo lectura
+        ctrl->metricsNodes = std::make_unique<PACMetricsNodes>(*ctrl->metrics);
+        ctrl->metricsNodes->createNodes(server, controllerFolder(ctrl->index), ctrl->prefix);
+    }
+
+    // 🔄 Volcado de lo publicado por los sondeos, en el hilo del servidor
+    UA_StatusCode callbackResult = UA_Server_addRepeatedCallback(server, publishValuesCallback, nullptr,
+                                                                 (UA_Double)config.publish_interval_ms, nullptr);
+    if (callbackResult != UA_STATUSCODE_GOOD)
+    {
+        LOG_ERROR("❌ No se pudo programar el volcado de valores: " << UA_StatusCode_name(callbackResult));
+        return false;
+    }
+    LOG_INFO("🔄 Valores del sondeo volcados al espacio de direcciones cada " << config.publish_interval_ms << " ms");
+
+    // 📈 Endpoint Prometheus (opcional: metrics_port = 0 lo desactiva)
+    if (config.metrics_port > 0)
+    {
+        metricsServer = std::make_unique<MetricsHttpServer>(
+            [] { return gatewayMetrics().renderPrometheus(); }, config.metrics_port, config.metrics_bind);
+        if (metricsServer->start())
+        {
+            LOG_INFO("📈 Métricas Prometheus en http://" << config.metrics_bind << ":" << config.metrics_port << "/metrics");
+        }
+        else
+        {
+            metricsServer.reset();
+        }
+    }
 
     LOG_INFO("✅ Servidor OPC-UA inicializado correctamente");
     return true;
@@ -1256,6 +1967,14 @@ UA_StatusCode runServer()
     return retval;
 }
 
+void requestServerStop()
+{
+    // Sólo levanta las banderas: runServer() retorna y el llamador hace shutdownServer()
+    running.store(false);
+    server_running.store(false);
+    server_running_flag = false;
+}
+
 void shutdownServer()
 {
     LOG_INFO("🛑 Cerrando servidor...");
@@ -1264,9 +1983,23 @@ void shutdownServer()
     server_running.store(false);
     server_running_flag = false;
 
-    if (pacClient)
+    metricsServer.reset();
+
+    // La cola usa el pool: detenerla primero (envía lo pendiente); los refrescos en vuelo
+    // referencian sus sesiones, esperar a que el motor los complete
+    for (auto &ctrl : controllers)
+    {
+        collectRefreshes(*ctrl, true);
+        ctrl->arraySource.reset();
+        ctrl->writeQueue.reset();
+        ctrl->metricsNodes.reset();
+        ctrl->pool.reset();
+    }
+
+    if (captureEngine)
     {
-        pacClient.reset();
+        captureEngine->setCapture(nullptr);
+        captureEngine.reset();
     }
 
     if (server)
@@ -1274,11 +2007,15 @@ void shutdownServer()
         UA_Server_delete(server);
         server = nullptr;
     }
+
+    AsyncLogger::instance().flush();
 }
 
 bool getPACConnectionStatus()
 {
-    return pacClient && pacClient->isConnected();
+    // Conectado si al menos un controlador lo está
+    return any_of(controllers.begin(), controllers.end(),
+                  [](const unique_ptr<Controller> &ctrl) { return ctrl->pool && ctrl->pool->isConnected(); });
 }
 
 void cleanupServer()
@@ -1315,12 +2052,12 @@ void enableWriteCallbacksOnce()
         callback.onRead = readCallback;
         callback.onWrite = writeCallback;
         
-        UA_NodeId nodeId = UA_NODEID_NUMERIC(1, var.node_id);
+        UA_NodeId nodeId = UA_NODEID_STRING(1, const_cast<char *>(var.node_string_id.c_str()));
         UA_StatusCode cbResult = UA_Server_setVariableNode_valueCallback(server, nodeId, callback);
             
         if (cbResult == UA_STATUSCODE_GOOD) {
             callbacksEnabled++;
-            LOG_DEBUG("  ✅ ValueCallback configurado para: " << var.opcua_name << " (NodeId: " << var.node_id << ")");
+            LOG_DEBUG("  ✅ ValueCallback configurado para: " << var.opcua_name << " (NodeId: " << var.node_string_id << ")");
         } else {
             LOG_ERROR("  ❌ Error configurando ValueCallback para: " << var.opcua_name << " - " << UA_StatusCode_name(cbResult));
         }
@@ -1330,162 +2067,80 @@ void enableWriteCallbacksOnce()
     LOG_INFO("🔧 SimpleVars mantienen lectura/escritura normal (sin callbacks)");
 }
 
-void performImmediateDataUpdate()
+// onRead para las variables sin callback de escritura (las escribibles de tabla ya lo tienen)
+void enableReadThroughCallbacks()
 {
-    LOG_INFO("🚀 Realizando actualización inmediata de datos para evitar valores null...");
-    
-    // Verificar conexión PAC
-    if (!pacClient) {
-        pacClient = std::make_unique<PACControlClient>(config.pac_ip, config.pac_port);
-    }
-    
-    if (!pacClient->isConnected()) {
-        LOG_INFO("🔌 Conectando al PAC para actualización inmediata...");
-        if (!pacClient->connect()) {
-            LOG_ERROR("❌ No se pudo conectar al PAC para actualización inmediata");
-            return;
-        }
+    if (config.read_max_age_ms <= 0) {
+        LOG_INFO("📖 Lectura bajo demanda desactivada (read_max_age_ms = 0)");
+        return;
     }
-    
-    // Activar bandera de escritura interna
-    server_writing_internally.store(true);
-    
-    int variablesUpdated = 0;
-    
-    // Separar variables por tipo
-    vector<Variable *> simpleVars;
-    map<string, vector<Variable *>> tableVars;
-    
+
+    int callbacksEnabled = 0;
     for (auto &var : config.variables) {
-        if (!var.has_node) continue;
-        
-        size_t pos = var.pac_source.find(':');
-        if (pos != std::string::npos) {
-            string table = var.pac_source.substr(0, pos);
-            tableVars[table].push_back(&var);
-        } else {
-            simpleVars.push_back(&var);
+        if (!var.has_node || (var.writable && var.tag_name != "SimpleVars")) {
+            continue;
         }
-    }
-    
-    // Actualizar variables simples
-    for (const auto &var : simpleVars) {
-        try {
-            UA_NodeId nodeId = UA_NODEID_STRING(1, const_cast<char *>(var->opcua_name.c_str()));
-            UA_Variant value;
-            UA_Variant_init(&value);
-            
-            if (var->type == Variable::FLOAT) {
-                float newValue = pacClient->readSingleFloatVariableByTag(var->pac_source);
-                UA_Variant_setScalar(&value, &newValue, &UA_TYPES[UA_TYPES_FLOAT]);
-                LOG_INFO("✅ Variable float individual leída: " << var->opcua_name << " = " << newValue);
-            } else {
-                int32_t newValue = pacClient->readSingleInt32VariableByTag(var->pac_source);
-                UA_Variant_setScalar(&value, &newValue, &UA_TYPES[UA_TYPES_INT32]);
-                LOG_INFO("📊 LEYENDO VARIABLE INT32 INDIVIDUAL: " << var->opcua_name);
-                if (newValue != 0) {
-                    LOG_INFO("✅ Variable int32 individual leída: " << var->opcua_name << " = " << newValue << " (0x" << std::hex << newValue << std::dec << ")");
-                } else {
-                    LOG_INFO("🔄 Simple INT32: " << var->opcua_name << " = " << newValue);
-                }
-            }
-            
-            UA_StatusCode result = UA_Server_writeValue(server, nodeId, value);
-            if (result == UA_STATUSCODE_GOOD) {
-                variablesUpdated++;
-            }
-        } catch (const std::exception &e) {
-            LOG_ERROR("❌ Error actualizando variable simple inmediata: " << var->opcua_name);
+
+        UA_ValueCallback callback;
+        callback.onRead = readCallback;
+        callback.onWrite = nullptr;
+
+        UA_NodeId nodeId = UA_NODEID_STRING(1, const_cast<char *>(var.node_string_id.c_str()));
+        if (UA_Server_setVariableNode_valueCallback(server, nodeId, callback) == UA_STATUSCODE_GOOD) {
+            callbacksEnabled++;
         }
     }
-    
-    // Actualizar algunas tablas representativas (solo unas pocas para no demorar)
-    int tablesProcessed = 0;
-    for (const auto &[tableName, vars] : tableVars) {
-        if (tablesProcessed >= 3) break; // Solo las primeras 3 tablas
-        
-        if (vars.empty()) continue;
-        
-        try {
-            // Determinar rango de índices
-            vector<int> indices;
-            for (const auto &var : vars) {
-                size_t pos = var->pac_source.find(':');
-                if (pos != std::string::npos) {
-                    int index = stoi(var->pac_source.substr(pos + 1));
-                    indices.push_back(index);
-                }
-            }
-            
-            if (indices.empty()) continue;
-            
-            int minIndex = *min_element(indices.begin(), indices.end());
-            int maxIndex = *max_element(indices.begin(), indices.end());
-            
-            // Leer datos
-            bool isAlarmTable = tableName.find("TBL_DA_") == 0 ||
-                              tableName.find("TBL_PA_") == 0 ||
-                              tableName.find("TBL_LA_") == 0 ||
-                              tableName.find("TBL_TA_") == 0;
-            
-            if (isAlarmTable) {
-                vector<int32_t> values = pacClient->readInt32Table(tableName, minIndex, maxIndex);
-                
-                for (const auto &var : vars) {
-                    size_t pos = var->pac_source.find(':');
-                    int index = stoi(var->pac_source.substr(pos + 1));
-                    int arrayIndex = index - minIndex;
-                    
-                    if (arrayIndex >= 0 && arrayIndex < (int)values.size()) {
-                        UA_NodeId nodeId = UA_NODEID_STRING(1, const_cast<char *>(var->opcua_name.c_str()));
-                        UA_Variant value;
-                        UA_Variant_init(&value);
-                        
-                        int32_t newValue = values[arrayIndex];
-                        UA_Variant_setScalar(&value, &newValue, &UA_TYPES[UA_TYPES_INT32]);
-                        
-                        UA_StatusCode result = UA_Server_writeValue(server, nodeId, value);
-                        if (result == UA_STATUSCODE_GOOD) {
-                            variablesUpdated++;
-                        }
-                    }
-                }
-            } else {
-                vector<float> values = pacClient->readFloatTable(tableName, minIndex, maxIndex);
-                
-                for (const auto &var : vars) {
-                    size_t pos = var->pac_source.find(':');
-                    int index = stoi(var->pac_source.substr(pos + 1));
-                    int arrayIndex = index - minIndex;
-                    
-                    if (arrayIndex >= 0 && arrayIndex < (int)values.size()) {
-                        UA_NodeId nodeId = UA_NODEID_STRING(1, const_cast<char *>(var->opcua_name.c_str()));
-                        UA_Variant value;
-                        UA_Variant_init(&value);
-                        
-                        float newValue = values[arrayIndex];
-                        UA_Variant_setScalar(&value, &newValue, &UA_TYPES[UA_TYPES_FLOAT]);
-                        
-                        UA_StatusCode result = UA_Server_writeValue(server, nodeId, value);
-                        if (result == UA_STATUSCODE_GOOD) {
-                            variablesUpdated++;
-                        }
-                    }
-                }
-            }
-            
-            tablesProcessed++;
-            LOG_INFO("✓ Tabla " << tableName << " leída: " << 
-                    (isAlarmTable ? "alarmas" : to_string(vars.size()) + " valores"));
-            LOG_INFO("🔄 Tabla inmediata: " << tableName << " procesada");
-            
-        } catch (const std::exception &e) {
-            LOG_ERROR("❌ Error en actualización inmediata de tabla: " << tableName);
+
+    LOG_INFO("📖 Lectura bajo demanda: maxAge " << config.read_max_age_ms << " ms, "
+             << callbacksEnabled << " callbacks de lectura adicionales");
+}
+
+// Primera lectura completa de un controlador; devuelve las variables actualizadas
+static int immediateUpdate(Controller &ctrl)
+{
+    const string name = ctrl.cfg.name.empty() ? "PAC" : ctrl.cfg.name;
+    PACConnectionPool &pool = ensurePool(ctrl);
+
+    if (!pool.isConnected()) {
+        LOG_INFO("🔌 Conectando a " << name << " (" << ctrl.cfg.ip << ":" << ctrl.cfg.port << ") para actualización inmediata...");
+        if (!pool.connect()) {
+            LOG_ERROR("❌ No se pudo conectar a " << name << " para actualización inmediata");
+            return 0;
         }
     }
     
-    // Desactivar bandera
-    server_writing_internally.store(false);
+    // Leer todas las clases del plan de una vez (tablas en pipeline + escalares en lote)
+    auto readStart = chrono::steady_clock::now();
+    int64_t readAtNs = wallClockNs();
+    const PollBatch &batch = ctrl.plan.fullBatch();
+    PollCycleResult cycle = pool.readCycle(batch.tables, batch.scalars, ctrl.cfg.pipeline_depth);
+
+    // Se publica desde este hilo; performImmediateDataUpdate() lo vuelca en el del servidor
+    lock_guard<mutex> publishLock(ctrl.publishMutex);
+    int variablesUpdated = publishPollResults(ctrl.plan, batch, cycle, *ctrl.metrics, readAtNs);
+    markBatchFresh(ctrl.readCache, batch, cycle, readStart);
+
+    size_t tablesRead = count_if(cycle.tables.begin(), cycle.tables.end(),
+                                 [](const TableReadResult &r) { return r.ok; });
+    LOG_INFO("✓ Tablas leídas en actualización inmediata de " << name << ": " << tablesRead << "/" << batch.tables.size());
+    return variablesUpdated;
+}
+
+void performImmediateDataUpdate()
+{
+    LOG_INFO("🚀 Realizando actualización inmediata de datos para evitar valores null...");
+
+    // Todos los controladores a la vez: un PAC que no responde no retrasa el arranque de los demás
+    vector<future<int>> updates;
+    for (auto &ctrl : controllers) {
+        updates.push_back(async(launch::async, immediateUpdate, ref(*ctrl)));
+    }
+
+    int variablesUpdated = 0;
+    for (auto &update : updates) {
+        variablesUpdated += update.get();
+    }
+    applyPublishedValues();
     
     LOG_INFO("✅ Actualización inmediata completada: " << variablesUpdated << " variables actualizadas");
 }
@@ -1494,7 +2149,7 @@ void writeDefaultValuesToWritableVariables()
 {
     LOG_INFO("📝 Escribiendo valores por defecto a variables escribibles...");
     
-    server_writing_internally.store(true);
+    writingInternally = true;
     
     int defaultsWritten = 0;
     for (auto &var : config.variables) {
@@ -1521,7 +2176,7 @@ void writeDefaultValuesToWritableVariables()
         }
     }
     
-    server_writing_internally.store(false);
+    writingInternally = false;
     
     LOG_INFO("📝 Valores por defecto escritos: " << defaultsWritten << " variables escribibles");
 }
@@ -0,0 +1,314 @@
+#define LOG_MODULE LogModule::Server
+#include "pac_array_source.h"
+#include "common.h"
+#include <cstring>
+
+static const char *ARRAYS_FOLDER = "Arrays";
+
+UA_StatusCode resolveArrayRange(const UA_NumericRange *range, size_t size, int &start, int &end)
+{
+    if (size == 0)
+        return UA_STATUSCODE_BADINDEXRANGENODATA;
+
+    if (!range || range->dimensionsSize == 0)
+    {
+        start = 0;
+        end = (int)size - 1;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    // Las tablas PAC son de una dimensión
+    if (range->dimensionsSize != 1 || range->dimensions[0].min > range->dimensions[0].max)
+        return UA_STATUSCODE_BADINDEXRANGEINVALID;
+
+    if (range->dimensions[0].min >= size)
+        return UA_STATUSCODE_BADINDEXRANGENODATA;
+
+    // Un rango que se sale por arriba se recorta, como hace open62541 con arrays en memoria
+    start = (int)range->dimensions[0].min;
+    end = (int)min<size_t>(range->dimensions[0].max, size - 1);
+    return UA_STATUSCODE_GOOD;
+}
+
+PACArraySource::PACArraySource(PACConnectionPool &pool, PACWriteQueue &writes, int controller,
+                               chrono::milliseconds max_age)
+    : pool(pool), writes(writes), controller(controller), max_age(max_age)
+{
+}
+
+PACArraySource::~PACArraySource()
+{
+    for (auto &node : nodes)
+    {
+        if (node->refresh)
+            collectRefresh(*node, true);
+    }
+}
+
+size_t PACArraySource::createNodes(UA_Server *server, const vector<ArrayTag> &tags,
+                                   const UA_NodeId &parent, const string &prefix)
+{
+    // Sólo las tablas de este controlador
+    bool any = false;
+    for (const auto &tag : tags)
+        any = any || tag.controller == controller;
+    if (!any)
+        return 0;
+
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    oAttr.displayName = UA_LOCALIZEDTEXT(const_cast<char *>("en"), const_cast<char *>(ARRAYS_FOLDER));
+
+    string folderName = prefix + ARRAYS_FOLDER;
+    UA_NodeId folderId;
+    UA_StatusCode result = UA_Server_addObjectNode(
+        server,
+        UA_NODEID_STRING(1, const_cast<char *>(folderName.c_str())),
+        parent,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+        UA_QUALIFIEDNAME(1, const_cast<char *>(ARRAYS_FOLDER)),
+        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+        oAttr,
+        nullptr,
+        &folderId);
+
+    if (result != UA_STATUSCODE_GOOD)
+    {
+        LOG_ERROR("❌ Error creando carpeta " << folderName << ": " << UA_StatusCode_name(result));
+        return 0;
+    }
+
+    UA_DataSource dataSource;
+    dataSource.read = readCallback;
+    dataSource.write = writeCallback;
+
+    size_t created = 0;
+    for (const auto &tag : tags)
+    {
+        if (tag.controller != controller)
+            continue;
+
+        const UA_DataType *type = tag.is_int32 ? &UA_TYPES[UA_TYPES_INT32] : &UA_TYPES[UA_TYPES_FLOAT];
+        UA_UInt32 dimension = (UA_UInt32)tag.size;
+
+        UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+        vAttr.displayName = UA_LOCALIZEDTEXT(const_cast<char *>("en"), const_cast<char *>(tag.name.c_str()));
+        vAttr.description = UA_LOCALIZEDTEXT(const_cast<char *>("es"), const_cast<char *>(tag.description.c_str()));
+        vAttr.dataType = type->typeId;
+        vAttr.valueRank = UA_VALUERANK_ONE_DIMENSION;
+        vAttr.arrayDimensionsSize = 1;
+        vAttr.arrayDimensions = &dimension;
+        vAttr.accessLevel = UA_ACCESSLEVELMASK_READ;
+        if (tag.writable)
+            vAttr.accessLevel |= UA_ACCESSLEVELMASK_WRITE;
+        vAttr.userAccessLevel = vAttr.accessLevel;
+
+        nodes.push_back(make_unique<ArrayNode>(ArrayNode{this, &tag}));
+
+        string nodeName = prefix + tag.name;
+        result = UA_Server_addDataSourceVariableNode(
+            server,
+            UA_NODEID_STRING(1, const_cast<char *>(nodeName.c_str())),
+            folderId,
+            UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+            UA_QUALIFIEDNAME(1, const_cast<char *>(tag.name.c_str())),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+            vAttr,
+            dataSource,
+            nodes.back().get(),
+            nullptr);
+
+        if (result != UA_STATUSCODE_GOOD)
+        {
+            LOG_ERROR("❌ Error creando array " << nodeName << ": " << UA_StatusCode_name(result));
+            nodes.pop_back();
+            continue;
+        }
+
+        created++;
+        LOG_DEBUG("✅ Array: " << tag.name << " → " << tag.table << "[" << tag.size << "] "
+                  << (tag.is_int32 ? "INT32" : "FLOAT") << (tag.writable ? " (escribible)" : ""));
+    }
+
+    UA_NodeId_clear(&folderId);
+    LOG_INFO("📚 " << created << " arrays de tabla creados en " << folderName << " (lectura bajo demanda)");
+    return created;
+}
+
+UA_StatusCode PACArraySource::readCallback(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+                                           const UA_NodeId *nodeId, void *nodeContext, UA_Boolean includeSourceTimeStamp,
+                                           const UA_NumericRange *range, UA_DataValue *value)
+{
+    ArrayNode *node = static_cast<ArrayNode *>(nodeContext);
+    if (!node)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_StatusCode status = node->owner->readSlice(*node, range, value);
+    if (status == UA_STATUSCODE_GOOD && includeSourceTimeStamp)
+    {
+        // Cuándo se leyó la tabla del PAC, no cuándo se sirvió
+        value->sourceTimestamp = node->read_at_ns / 100 + UA_DATETIME_UNIX_EPOCH;
+        value->hasSourceTimestamp = true;
+    }
+    return status;
+}
+
+UA_StatusCode PACArraySource::writeCallback(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+                                            const UA_NodeId *nodeId, void *nodeContext,
+                                            const UA_NumericRange *range, const UA_DataValue *value)
+{
+    ArrayNode *node = static_cast<ArrayNode *>(nodeContext);
+    if (!node)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    if (!node->tag->writable)
+        return UA_STATUSCODE_BADNOTWRITABLE;
+
+    if (!value || !value->hasValue)
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+
+    return node->owner->writeSlice(*node, range, value->value);
+}
+
+// Hilo del servidor: nunca espera al PAC. Sirve el tramo pedido de la última lectura completa y,
+// si es más vieja que max_age, lanza otra que verán los Read siguientes
+UA_StatusCode PACArraySource::readSlice(ArrayNode &node, const UA_NumericRange *range, UA_DataValue *value)
+{
+    const ArrayTag &tag = *node.tag;
+    int start = 0, end = 0;
+    UA_StatusCode status = resolveArrayRange(range, (size_t)tag.size, start, end);
+    if (status != UA_STATUSCODE_GOOD)
+        return status;
+
+    if (node.refresh)
+        collectRefresh(node, false);
+
+    bool failed = node.failed;
+    if (!node.refresh && (!node.data.ok || chrono::steady_clock::now() - node.read_at >= max_age))
+        startRefresh(node);
+
+    if (!node.data.ok)
+    {
+        if (failed)
+            return UA_STATUSCODE_BADCOMMUNICATIONERROR;
+        return node.refresh ? UA_STATUSCODE_BADWAITINGFORINITIALDATA : UA_STATUSCODE_BADNOTCONNECTED;
+    }
+
+    size_t count = (size_t)(end - start + 1);
+    const UA_DataType *type = tag.is_int32 ? &UA_TYPES[UA_TYPES_INT32] : &UA_TYPES[UA_TYPES_FLOAT];
+    void *data = UA_Array_new(count, type);
+    if (!data)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    if (tag.is_int32)
+        memcpy(data, node.data.ints.data() + start, count * sizeof(int32_t));
+    else
+        memcpy(data, node.data.floats.data() + start, count * sizeof(float));
+
+    UA_Variant_setArray(&value->value, data, count, type);
+    value->hasValue = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+// La tabla entera en un TRange. por una sesión de sondeo ya conectada (nunca reconecta);
+// el motor la intercala con el ciclo y collectRefresh la recoge
+void PACArraySource::startRefresh(ArrayNode &node)
+{
+    PACControlClient *session = pool.reader();
+    if (!session)
+        return;
+
+    const ArrayTag &tag = *node.tag;
+    auto refresh = make_unique<ArrayRefresh>();
+    TableReadRequest request;
+    request.table_name = tag.table;
+    request.start_pos = 0;
+    request.end_pos = tag.size - 1;
+    request.is_int32 = tag.is_int32;
+    refresh->requests.push_back(std::move(request));
+    refresh->results.resize(1);
+    refresh->started = chrono::steady_clock::now();
+    refresh->read_at_ns = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+
+    refresh->done = session->readTablesAsync(refresh->requests, {0}, refresh->results, 1);
+    node.refresh = std::move(refresh);
+}
+
+// Hilo del servidor: adopta la lectura si terminó (wait = esperarla)
+void PACArraySource::collectRefresh(ArrayNode &node, bool wait)
+{
+    ArrayRefresh &refresh = *node.refresh;
+    if (!wait && refresh.done.wait_for(chrono::seconds(0)) != future_status::ready)
+        return;
+    refresh.done.wait();
+
+    const ArrayTag &tag = *node.tag;
+    TableReadResult &result = refresh.results[0];
+    if (result.ok && result.count == (size_t)tag.size)
+    {
+        node.data = std::move(result);
+        node.read_at = refresh.started;
+        node.read_at_ns = refresh.read_at_ns;
+        node.failed = false;
+        LOG_DEBUG("📚 Array " << tag.table << "[" << tag.size << "] leído bajo demanda");
+    }
+    else
+    {
+        node.failed = true;
+        LOG_ERROR("❌ Lectura de array " << tag.table << " fallida (" << result.count << "/" << tag.size << ")");
+    }
+    node.refresh.reset();
+}
+
+UA_StatusCode PACArraySource::writeSlice(ArrayNode &node, const UA_NumericRange *range, const UA_Variant &data)
+{
+    const ArrayTag &tag = *node.tag;
+    const UA_DataType *type = tag.is_int32 ? &UA_TYPES[UA_TYPES_INT32] : &UA_TYPES[UA_TYPES_FLOAT];
+    if (data.type != type)
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+
+    size_t length = UA_Variant_isScalar(&data) ? 1 : data.arrayLength;
+    if (length == 0)
+        return UA_STATUSCODE_GOOD;
+
+    int start = 0, end = 0;
+    UA_StatusCode status = resolveArrayRange(range, (size_t)tag.size, start, end);
+    if (status != UA_STATUSCODE_GOOD)
+        return status;
+
+    // Con rango el valor debe cubrirlo exactamente; sin rango se escribe desde el índice 0
+    if (range && range->dimensionsSize > 0)
+    {
+        if (range->dimensions[0].max >= (UA_UInt32)tag.size || length != (size_t)(end - start + 1))
+            return UA_STATUSCODE_BADINDEXRANGEINVALID;
+    }
+    else if (length > (size_t)tag.size)
+    {
+        return UA_STATUSCODE_BADOUTOFRANGE;
+    }
+
+    // Sin E/S en el hilo del servidor: el tramo va a la cola del controlador (TABLE! por elemento)
+    PACWriteRequest request;
+    request.var_id = WRITE_NO_VARIABLE;
+    request.target = tag.table;
+    request.index = start;
+    request.is_int32 = tag.is_int32;
+    if (tag.is_int32)
+    {
+        const int32_t *values = static_cast<const int32_t *>(data.data);
+        request.int_range.assign(values, values + length);
+    }
+    else
+    {
+        const float *values = static_cast<const float *>(data.data);
+        request.float_range.assign(values, values + length);
+    }
+    writes.push(std::move(request));
+
+    // La copia ya no refleja el PAC: el próximo Read relanza la lectura
+    node.read_at = {};
+
+    LOG_WRITE("📚 Array " << tag.table << "[" << start << ".." << (start + (int)length - 1) << "]: "
+              << length << " escrituras encoladas");
+    return UA_STATUSCODE_GOOD;
+}
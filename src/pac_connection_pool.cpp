@@ -0,0 +1,178 @@
+#define LOG_MODULE LogModule::PAC
+#include "pac_connection_pool.h"
+#include "common.h"
+#include "pac_protocol.h"
+#include <algorithm>
+
+using namespace std;
+
+PACConnectionPool::PACConnectionPool(const string &ip, int port, size_t sessions)
+    : pac_ip(ip), pac_port(port)
+{
+    if (sessions == 0)
+        sessions = 1;
+
+    for (size_t i = 0; i < sessions; i++)
+    {
+        poll_sessions.push_back(make_unique<PACControlClient>(ip, port));
+    }
+    write_session = make_unique<PACControlClient>(ip, port);
+}
+
+PACConnectionPool::~PACConnectionPool()
+{
+    disconnect();
+}
+
+bool PACConnectionPool::connect()
+{
+    size_t connected_count = 0;
+    for (auto &session : poll_sessions)
+    {
+        if (session->connect())
+            connected_count++;
+    }
+
+    if (!write_session->connect())
+    {
+        LOG_PAC("⚠️ Sesión de escritura no conectada: " << pac_ip << ":" << pac_port);
+    }
+
+    LOG_PAC("🔌 Sesiones de lectura conectadas: " << connected_count << "/" << poll_sessions.size());
+    return connected_count > 0;
+}
+
+void PACConnectionPool::disconnect()
+{
+    for (auto &session : poll_sessions)
+    {
+        session->disconnect();
+    }
+    write_session->disconnect();
+}
+
+bool PACConnectionPool::isConnected() const
+{
+    return connectedSessions() > 0;
+}
+
+size_t PACConnectionPool::connectedSessions() const
+{
+    size_t count = 0;
+    for (const auto &session : poll_sessions)
+    {
+        if (session->isConnected())
+            count++;
+    }
+    return count;
+}
+
+size_t PACConnectionPool::reconnectDeadSessions()
+{
+    size_t recovered = 0;
+    for (auto &session : poll_sessions)
+    {
+        if (!session->isConnected())
+        {
+            session->disconnect();
+            if (session->connect())
+                recovered++;
+        }
+    }
+
+    if (!write_session->isConnected())
+    {
+        write_session->disconnect();
+        write_session->connect();
+    }
+
+    if (recovered > 0)
+    {
+        LOG_PAC("🔄 Sesiones PAC recuperadas: " << recovered);
+    }
+    return recovered;
+}
+
+PollCycleResult PACConnectionPool::readCycle(const vector<TableReadRequest> &tables,
+                                             const vector<pair<string, string>> &scalars,
+                                             size_t pipeline_depth)
+{
+    PollCycleResult result;
+    result.tables.resize(tables.size());
+
+    vector<PACControlClient *> live;
+    for (auto &session : poll_sessions)
+    {
+        if (session->isConnected())
+            live.push_back(session.get());
+    }
+
+    if (live.empty())
+        return result;
+
+    // Repartir tablas por carga (bytes esperados): cada una a la sesión menos cargada
+    vector<vector<size_t>> table_share(live.size());
+    vector<size_t> load(live.size(), 0);
+    for (size_t i = 0; i < tables.size(); i++)
+    {
+        size_t target = min_element(load.begin(), load.end()) - load.begin();
+        table_share[target].push_back(i);
+        load[target] += pac_protocol::tableResponseBytes(tables[i].start_pos, tables[i].end_pos) + 2;
+    }
+
+    // Escalares en bloques contiguos, uno por sesión
+    vector<vector<pair<string, string>>> scalar_share(live.size());
+    size_t chunk = (scalars.size() + live.size() - 1) / live.size();
+    for (size_t i = 0; i < scalars.size(); i++)
+    {
+        scalar_share[i / max<size_t>(chunk, 1)].push_back(scalars[i]);
+    }
+
+    // Todas las sesiones a la vez sobre el motor de E/S; cada una escribe sólo en sus
+    // índices de result.tables (sin copiar solicitudes) y en su propio mapa de escalares
+    vector<map<string, ScalarReadResult>> partial(live.size());
+    vector<future<void>> pending;
+    for (size_t s = 0; s < live.size(); s++)
+    {
+        if (!table_share[s].empty())
+            pending.push_back(live[s]->readTablesAsync(tables, table_share[s], result.tables, pipeline_depth));
+        if (!scalar_share[s].empty())
+            pending.push_back(live[s]->readScalarsAsync(scalar_share[s], partial[s]));
+    }
+
+    for (auto &done : pending)
+        done.wait();
+
+    for (auto &scalars_read : partial)
+        result.scalars.insert(scalars_read.begin(), scalars_read.end());
+    return result;
+}
+
+void PACConnectionPool::setTableRegistry(const TableRegistry *registry)
+{
+    for (auto &session : poll_sessions)
+        session->setTableRegistry(registry);
+    write_session->setTableRegistry(registry);
+}
+
+PACControlClient &PACConnectionPool::writer()
+{
+    if (!write_session->isConnected())
+    {
+        write_session->disconnect();
+        write_session->connect();
+    }
+    return *write_session;
+}
+
+PACControlClient *PACConnectionPool::reader()
+{
+    size_t start = next_reader.fetch_add(1, memory_order_relaxed);
+    for (size_t i = 0; i < poll_sessions.size(); i++)
+    {
+        PACControlClient &session = *poll_sessions[(start + i) % poll_sessions.size()];
+        if (session.isConnected())
+            return &session;
+    }
+    return nullptr;
+}
@@ -1,3 +1,4 @@
+#define LOG_MODULE LogModule::PAC
 #include "pac_control_client.h"
 #include <iostream>
 #include <sstream>
@@ -8,14 +9,16 @@
 #include <algorithm>
 #include <cctype>
 #include <cmath>  // Para isnan, isinf
-#include <fcntl.h>  // Para fcntl y O_NONBLOCK
+#include <poll.h>   // Espera con timeout sobre el socket
 
 #include "common.h"  
+#include "pac_protocol.h"
 
 using namespace std;
 
 PACControlClient::PACControlClient(const string &ip, int port)
-    : pac_ip(ip), pac_port(port), sock(-1), connected(false), cache_enabled(false)  // DESHABILITADO PARA DEBUG
+    : pac_ip(ip), pac_port(port), connected(false), cache_enabled(false),  // DESHABILITADO PARA DEBUG
+      metrics(&gatewayMetrics().pac(ip, port))
 {
 }
 
@@ -31,50 +34,50 @@ bool PACControlClient::connect()
     if (connected)
         return true;
 
-    sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0)
-    {
-        cerr << "Error creando socket" << endl;
-        return false;
-    }
-
-    // Configurar timeout para socket
-    struct timeval timeout;
-    timeout.tv_sec = 3; // 3 segundos timeout
-    timeout.tv_usec = 0;
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char *)&timeout, sizeof(timeout));
-    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (char *)&timeout, sizeof(timeout));
+    if (!io)
+        io = PACIoEngine::shared();
 
-    struct sockaddr_in server_addr;
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(pac_port);
-
-    if (inet_pton(AF_INET, pac_ip.c_str(), &server_addr.sin_addr) <= 0)
+    // Connect no bloqueante en el motor: timeout propio en lugar del del kernel
+    io_conn = io->connect(pac_ip, pac_port, IO_TIMEOUT, [this] { connected = false; });
+    if (io_conn == PACIoEngine::NO_CONNECTION)
     {
-        cerr << "Dirección IP inválida: " << pac_ip << endl;
-        close(sock);
+        metrics->connect_failures.fetch_add(1, memory_order_relaxed);
         return false;
     }
 
-    if (::connect(sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0)
-    {
-        close(sock);
-        return false;
-    }
+    metrics->connects.fetch_add(1, memory_order_relaxed);
+    if (ever_connected)
+        metrics->reconnects.fetch_add(1, memory_order_relaxed);
+    ever_connected = true;
 
     connected = true;
     return true;
 }
 
+// Fallo de una solicitud (una vez por lote abortado: el resto hereda el mismo estado)
+void PACControlClient::countFailure(IoStatus status)
+{
+    if (status == IoStatus::TIMEOUT)
+        metrics->timeouts.fetch_add(1, memory_order_relaxed);
+    else if (status == IoStatus::DESYNCED || status == IoStatus::CLOSED)
+        metrics->desyncs.fetch_add(1, memory_order_relaxed);
+}
+
+TableMetrics *PACControlClient::tableMetricsOf(const TableReadRequest &req)
+{
+    if (req.table_id != NO_TABLE && req.table_id < table_metrics.size())
+        return table_metrics[req.table_id];
+    return &metrics->table(req.table_name);
+}
+
 void PACControlClient::disconnect()
 {
     lock_guard<mutex> lock(comm_mutex);
 
-    if (sock >= 0)
+    if (io && io_conn != PACIoEngine::NO_CONNECTION)
     {
-        close(sock);
-        sock = -1;
+        io->close(io_conn);
+        io_conn = PACIoEngine::NO_CONNECTION;
     }
     connected = false;
 }
@@ -91,12 +94,18 @@ vector<float> PACControlClient::readFloatTable(const string &table_name,
         return {};
     }
 
-    // Verificar cache solo si está habilitado
-    string cache_key = table_name + "_" + to_string(start_pos) + "_" + to_string(end_pos);
-    if (cache_enabled && isCacheValid(cache_key))
+    // Verificar cache solo si está habilitado (id internado + tramo, sin construir claves)
+    TableId table_id = cache_enabled ? tableIdOf(table_name) : NO_TABLE;
+    if (table_id != NO_TABLE && end_pos >= start_pos)
     {
-        LOG_DEBUG("📋 CACHE HIT: Usando datos cached para " << table_name);
-        return table_cache[cache_key].data;
+        vector<float> cached(end_pos - start_pos + 1);
+        lock_guard<mutex> cache_lock(cache_mutex);
+        if (table_cache.getFloats(table_id, start_pos, end_pos, cached,
+                                      chrono::steady_clock::now() - chrono::milliseconds(CACHE_TIMEOUT_MS)))
+        {
+            LOG_DEBUG("📋 CACHE HIT: Usando datos cached para " << table_name);
+            return cached;
+        }
     }
 
     stringstream cmd;
@@ -116,38 +125,20 @@ vector<float> PACControlClient::readFloatTable(const string &table_name,
 
     string command = cmd.str();
     LOG_DEBUG("📊 LEYENDO TABLA DE DATOS: " << table_name);
-    LOG_DEBUG("📋 Comando en bytes: ");
-    for (char c : command) {
-        LOG_DEBUG("0x" << hex << (int)(unsigned char)c << " ");
-    }
-    LOG_DEBUG(dec);
-    LOG_DEBUG("🔍 TIMESTAMP: " << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count() << "ms");
-
-    // 🔧 SOLUCIÓN: Limpiar buffer del socket antes de enviar comando
-    flushSocketBuffer();
-    
-    if (!sendCommand(command))
-    {
-        cerr << "Error enviando comando" << endl;
-        return {};
-    }
+    PAC_TRACE_BYTES("📋 Comando", command.data(), command.size());
 
     // 🔧 SOLUCIÓN: Las tablas responden en BINARIO con header 00 00
     // A diferencia de variables simples que responden en ASCII terminado en 0x20
     size_t expected_bytes = 4 +end_pos * 4; // 10 floats × 4 bytes = 40 bytes de datos
 
-    vector<uint8_t> raw_data = receiveData(expected_bytes);
+    vector<uint8_t> raw_data = requestTableData(command, expected_bytes);
     if (raw_data.empty())
     {
         cerr << "Error recibiendo datos binarios de tabla: " << table_name << endl;
         return {};
     }
     
-    LOG_DEBUG("📋 DATOS BINARIOS TABLA (" << raw_data.size() << " bytes): ");
-    for (size_t i = 0; i < raw_data.size(); i++) {
-        LOG_DEBUG(hex << setfill('0') << setw(2) << (int)raw_data[i] << " ");
-    }
-    LOG_DEBUG(dec);
+    PAC_TRACE_BYTES("📋 DATOS BINARIOS TABLA", raw_data.data(), raw_data.size());
     
     // Convertir bytes a floats (IEEE 754 little endian)
     vector<float> floats;
@@ -161,17 +152,16 @@ vector<float> PACControlClient::readFloatTable(const string &table_name,
         memcpy(&value, &raw_bits, 4);
         floats.push_back(value);
         
-        LOG_DEBUG("📊 [" << (i/4) << "] Raw: " << hex << setfill('0') << setw(8) << raw_bits 
-                     << dec << " -> float: " << value);
+        PAC_TRACE("📊 [" << (i/4) << "] Raw: " << hex << setfill('0') << setw(8) << raw_bits
+                  << dec << " -> float: " << value);
     }
     
     LOG_DEBUG("📊 Total valores parseados: " << floats.size());
     
     // Si el cache está habilitado, guardar los datos
-    
-    // Si el cache está habilitado, guardar los datos
-    if (cache_enabled && !floats.empty()) {
-        table_cache[cache_key] = {floats, chrono::steady_clock::now(), true};
+    if (table_id != NO_TABLE && !floats.empty()) {
+        lock_guard<mutex> cache_lock(cache_mutex);
+        table_cache.putFloats(table_id, start_pos, floats, chrono::steady_clock::now());
         LOG_DEBUG("💾 DATOS GUARDADOS EN CACHE: " << table_name << " con " << floats.size() << " valores");
     }
 
@@ -181,42 +171,6 @@ vector<float> PACControlClient::readFloatTable(const string &table_name,
         LOG_DEBUG("  [" << (start_pos + i) << "] = " << floats[i]);
     }
 
-    return floats;
-    LOG_DEBUG("📊 Total valores parseados: " << floats.size());
-
-    // Verificar consistencia de datos comparando con cache anterior
-    auto prev_cache = table_cache.find(cache_key);
-    if (prev_cache != table_cache.end() && prev_cache->second.valid) {
-        bool values_changed = false;
-        if (floats.size() == prev_cache->second.data.size()) {
-            for (size_t i = 0; i < floats.size(); i++) {
-                float diff = abs(floats[i] - prev_cache->second.data[i]);
-                if (diff > 0.001f) { // Tolerancia de 0.001 para cambios significativos
-                    values_changed = true;
-                    LOG_DEBUG("🔄 CAMBIO DETECTADO en [" << (start_pos + i) << "]: " 
-                         << prev_cache->second.data[i] << " -> " << floats[i] 
-                         << " (diff: " << diff << ")");
-                }
-            }
-            if (!values_changed) {
-                LOG_DEBUG("✅ VALORES ESTABLES: Sin cambios significativos en " << table_name);
-            }
-        }
-    }
-
-    // Guardar en cache
-    CacheEntry entry;
-    entry.data = floats;
-    entry.timestamp = chrono::steady_clock::now();
-    entry.valid = true;
-    table_cache[cache_key] = entry;
-
-    DEBUG_INFO("✓ Tabla " << table_name << " leída: " << floats.size() << " valores");
-    for (size_t i = 0; i < floats.size(); i++)
-    {
-        LOG_DEBUG("  [" << (start_pos + i) << "] = " << floats[i]);
-    }
-
     return floats;
 }
 
@@ -244,12 +198,18 @@ vector<int32_t> PACControlClient::readInt32Table(const string &table_name,
         return {};
     }
 
-    // Verificar cache
-    string cache_key = table_name + "_int32_" + to_string(start_pos) + "_" + to_string(end_pos);
-    if (isCacheValid(cache_key))
+    // Verificar cache (mismo bloque que los float: se guardan los bits)
+    TableId table_id = cache_enabled ? tableIdOf(table_name) : NO_TABLE;
+    if (table_id != NO_TABLE && end_pos >= start_pos)
     {
-        // Convertir float cache a int32 (necesitamos cache separado para int32)
-        // Por simplicidad, leer directamente por ahora
+        vector<int32_t> cached(end_pos - start_pos + 1);
+        lock_guard<mutex> cache_lock(cache_mutex);
+        if (table_cache.getInt32s(table_id, start_pos, end_pos, cached,
+                                      chrono::steady_clock::now() - chrono::milliseconds(CACHE_TIMEOUT_MS)))
+        {
+            LOG_DEBUG("📋 CACHE HIT: Usando datos cached para " << table_name);
+            return cached;
+        }
     }
 
     // Comando PAC Control CORRECTO para int32 (alarmas):
@@ -266,17 +226,11 @@ vector<int32_t> PACControlClient::readInt32Table(const string &table_name,
 
     string command = cmd.str();
 
-    if (!sendCommand(command))
-    {
-        cerr << "Error enviando comando int32" << endl;
-        return {};
-    }
-
     // CORRECCIÓN: El PAC siempre envía la tabla completa para alarmas (20 bytes datos + 2 header = 22 total)
     // Para tablas de alarmas (int32): 5 valores × 4 bytes = 20 bytes
     size_t expected_bytes = 4 + end_pos * 4; // Siempre 20 bytes de datos (5 int32 × 4 bytes)
 
-    vector<uint8_t> raw_data = receiveData(expected_bytes);
+    vector<uint8_t> raw_data = requestTableData(command, expected_bytes);
     if (raw_data.empty())
     {
         cerr << "Error recibiendo datos int32 de tabla" << endl;
@@ -286,9 +240,213 @@ vector<int32_t> PACControlClient::readInt32Table(const string &table_name,
     // Convertir bytes a int32 (little endian)
     vector<int32_t> ints = convertBytesToInt32s(raw_data);
 
+    if (table_id != NO_TABLE && !ints.empty())
+    {
+        lock_guard<mutex> cache_lock(cache_mutex);
+        table_cache.putInt32s(table_id, start_pos, ints, chrono::steady_clock::now());
+    }
+
     return ints;
 }
 
+// Lectura pipeline de varias tablas: los comandos TRange. se escriben seguidos en el
+// socket y las respuestas llegan en el mismo orden, cada una con header de 2 bytes
+// y un payload cuyo tamaño ya conocemos por el rango pedido
+vector<TableReadResult> PACControlClient::readTablesPipelined(const vector<TableReadRequest> &requests,
+                                                              size_t max_in_flight)
+{
+    vector<size_t> indices(requests.size());
+    for (size_t i = 0; i < indices.size(); i++)
+        indices[i] = i;
+
+    vector<TableReadResult> results(requests.size());
+    readTablesPipelined(requests, indices, results, max_in_flight);
+    return results;
+}
+
+void PACControlClient::readTablesPipelined(const vector<TableReadRequest> &requests, const vector<size_t> &indices,
+                                           vector<TableReadResult> &results, size_t max_in_flight)
+{
+    lock_guard<mutex> lock(comm_mutex);
+
+    if (!connected)
+    {
+        cerr << "No conectado al PAC" << endl;
+        return;
+    }
+
+    readTablesAsync(requests, indices, results, max_in_flight).wait();
+}
+
+static future<void> readyFuture()
+{
+    promise<void> ready;
+    ready.set_value();
+    return ready.get_future();
+}
+
+// Payload de tabla → destino del llamador (o vectores del resultado si no hay destino)
+static void decodeTableFrame(const TableReadRequest &req, span<const uint8_t> payload, TableReadResult &result)
+{
+    if (req.is_int32)
+    {
+        if (!req.int_dest.empty())
+            result.count = pac_protocol::decodeInt32sLE(payload, req.int_dest);
+        else
+        {
+            result.ints.resize(payload.size() / pac_protocol::TABLE_ELEMENT_BYTES);
+            result.count = pac_protocol::decodeInt32sLE(payload, span<int32_t>(result.ints));
+        }
+        return;
+    }
+
+    span<float> dest = req.float_dest;
+    if (dest.empty())
+    {
+        result.floats.resize(payload.size() / pac_protocol::TABLE_ELEMENT_BYTES);
+        dest = span<float>(result.floats);
+    }
+    pac_protocol::FloatDecodeResult decoded = pac_protocol::decodeFloatsChecked(payload, dest);
+    result.count = decoded.count;
+    result.non_finite = decoded.non_finite;
+    if (decoded.non_finite > 0)
+    {
+        LOG_DEBUG("⚠️ " << req.table_name << ": " << decoded.non_finite << " valores no finitos");
+    }
+}
+
+// Un IoRequest por tabla: el motor escribe seguidos hasta max_in_flight comandos TRange.
+// y completa cada trama (header 00 00 + payload de tamaño conocido) en orden de envío
+future<void> PACControlClient::readTablesAsync(const vector<TableReadRequest> &requests, const vector<size_t> &indices,
+                                               vector<TableReadResult> &results, size_t max_in_flight)
+{
+    if (!connected || indices.empty())
+        return readyFuture();
+
+    if (max_in_flight == 0)
+        max_in_flight = 1;
+
+    auto submitted = chrono::steady_clock::now();
+    auto aborted = make_shared<bool>(false);
+    // Fin de la trama anterior: el tiempo de servicio de cada tabla se mide desde ahí
+    auto previous = make_shared<chrono::steady_clock::time_point>(submitted);
+
+    // Contadores de cada tabla resueltos una vez por lote (los callbacks sólo hacen fetch_add)
+    vector<TableMetrics *> tables(indices.size());
+    {
+        lock_guard<mutex> cache_lock(cache_mutex);
+        for (size_t k = 0; k < indices.size(); k++)
+            tables[k] = tableMetricsOf(requests[indices[k]]);
+    }
+
+    vector<IoRequest> batch(indices.size());
+    size_t bytes_out = 0;
+    for (size_t k = 0; k < indices.size(); k++)
+    {
+        const TableReadRequest &req = requests[indices[k]];
+        TableReadResult &result = results[indices[k]];
+        IoRequest &io_req = batch[k];
+        TableMetrics *table = tables[k];
+
+        if (!req.command.empty())
+            io_req.tx = req.command;
+        else
+            pac_protocol::appendTableReadCommand(io_req.tx, req.table_name, req.start_pos, req.end_pos);
+        bytes_out += io_req.tx.size();
+        io_req.frame = IoFrame::fixed(pac_protocol::TABLE_HEADER_BYTES +
+                                      pac_protocol::tableResponseBytes(req.start_pos, req.end_pos));
+        io_req.timeout = IO_TIMEOUT;
+        io_req.max_in_flight = max_in_flight;
+        io_req.on_complete = [this, &req, &result, table, submitted, previous, aborted, remaining = indices.size() - k](
+                                 IoStatus status, span<const uint8_t> frame) {
+            if (status != IoStatus::OK)
+            {
+                table->errors.fetch_add(1, memory_order_relaxed);
+
+                // Sin trama completa el motor aborta el resto del pipeline
+                if (!*aborted)
+                {
+                    LOG_PAC("⚠️ Pipeline abortado en " << req.table_name << " (" << remaining << " tablas sin leer)");
+                    countFailure(status);
+                    *aborted = true;
+                }
+                return true;
+            }
+
+            auto now = chrono::steady_clock::now();
+            table->latency.record(chrono::duration_cast<chrono::microseconds>(now - *previous).count());
+            table->reads.fetch_add(1, memory_order_relaxed);
+            table->bytes_in.fetch_add(frame.size(), memory_order_relaxed);
+            metrics->bytes_in.fetch_add(frame.size(), memory_order_relaxed);
+            *previous = now;
+
+            decodeTableFrame(req, frame.subspan(pac_protocol::TABLE_HEADER_BYTES), result);
+            result.latency_us = static_cast<uint32_t>(chrono::duration_cast<chrono::microseconds>(
+                now - submitted).count());
+            result.ok = true;
+            cacheTableResult(req, result);
+            return true;
+        };
+    }
+    metrics->bytes_out.fetch_add(bytes_out, memory_order_relaxed);
+
+    LOG_DEBUG("📤 PIPELINE: " << batch.size() << " comandos TRange. (hasta " << max_in_flight << " en vuelo)");
+    return io->submit(io_conn, std::move(batch));
+}
+
+void PACControlClient::cacheTableResult(const TableReadRequest &req, const TableReadResult &result)
+{
+    if (!cache_enabled || req.table_id == NO_TABLE)
+        return;
+
+    auto read_at = chrono::steady_clock::now();
+    lock_guard<mutex> cache_lock(cache_mutex);
+    if (req.is_int32)
+        table_cache.putInt32s(req.table_id, req.start_pos,
+                              span<const int32_t>(req.int_dest.empty() ? result.ints.data() : req.int_dest.data(), result.count), read_at);
+    else
+        table_cache.putFloats(req.table_id, req.start_pos,
+                              span<const float>(req.float_dest.empty() ? result.floats.data() : req.float_dest.data(), result.count), read_at);
+}
+
+size_t PACControlClient::readFloatTableInto(const string &table_name, int start_pos, int end_pos, span<float> out)
+{
+    return readTableInto(table_name, start_pos, end_pos, out, {});
+}
+
+size_t PACControlClient::readInt32TableInto(const string &table_name, int start_pos, int end_pos, span<int32_t> out)
+{
+    return readTableInto(table_name, start_pos, end_pos, {}, out);
+}
+
+// Una tabla: trama decodificada en el destino desde el buffer de recepción del motor
+size_t PACControlClient::readTableInto(const string &table_name, int start_pos, int end_pos,
+                                       span<float> float_out, span<int32_t> int_out)
+{
+    lock_guard<mutex> lock(comm_mutex);
+
+    if (!connected || end_pos < start_pos)
+        return 0;
+
+    size_t decoded = 0;
+    vector<IoRequest> batch(1);
+    pac_protocol::appendTableReadCommand(batch[0].tx, table_name, start_pos, end_pos);
+    batch[0].frame = IoFrame::fixed(pac_protocol::TABLE_HEADER_BYTES + pac_protocol::tableResponseBytes(start_pos, end_pos));
+    batch[0].timeout = IO_TIMEOUT;
+    batch[0].on_complete = [&](IoStatus status, span<const uint8_t> frame) {
+        if (status == IoStatus::OK)
+        {
+            span<const uint8_t> payload = frame.subspan(pac_protocol::TABLE_HEADER_BYTES);
+            decoded = int_out.empty() ? pac_protocol::decodeFloatsLE(payload, float_out)
+                                      : pac_protocol::decodeInt32sLE(payload, int_out);
+        }
+        return true;
+    };
+
+    io->submit(io_conn, std::move(batch)).wait();
+    return decoded;
+}
+
 string PACControlClient::readStringVariable(const string &variable_name)
 {
     lock_guard<mutex> lock(comm_mutex);
@@ -304,13 +462,7 @@ string PACControlClient::readStringVariable(const string &variable_name)
 
     string command = cmd.str();
 
-    if (!sendCommand(command))
-    {
-        cerr << "Error enviando comando string" << endl;
-        return "";
-    }
-
-    string response = receiveResponse();
+    string response = requestResponse(command);
 
    return response;
 
@@ -331,11 +483,13 @@ bool PACControlClient::writeFloatVariable(const string &table_name, int index, f
     string command = cmd.str();
     //cout << "Escribiendo float: " << command << endl;
 
-    bool result = sendCommand(command);
+    // Sin confirmación conocida para TWrite: se da por escrita al enviarse
+    vector<uint8_t> no_response;
+    bool result = exchange(command, IoFrame::none(), no_response) == IoStatus::OK;
     if (result)
     {
         // Invalidar cache para esta tabla
-        clearCache();
+        clearCacheForTable(table_name);
         //cout << "✓ Variable float escrita: " << table_name << "[" << index << "] = " << value << endl;
     }
 
@@ -355,11 +509,13 @@ bool PACControlClient::writeInt32Variable(const string &table_name, int index, i
     string command = cmd.str();
     //cout << "Escribiendo int32: " << command << endl;
 
-    bool result = sendCommand(command);
+    // Sin confirmación conocida para TWrite: se da por escrita al enviarse
+    vector<uint8_t> no_response;
+    bool result = exchange(command, IoFrame::none(), no_response) == IoStatus::OK;
     if (result)
     {
         // Invalidar cache para esta tabla
-        clearCache();
+        clearCacheForTable(table_name);
         //cout << "✓ Variable int32 escrita: " << table_name << "[" << index << "] = 0x"
             // << hex << value << dec << endl;
     }
@@ -369,151 +525,153 @@ bool PACControlClient::writeInt32Variable(const string &table_name, int index, i
 
 bool PACControlClient::writeFloatTable(const string &table_name, const vector<float> &values)
 {
-    bool success = true;
+    return writeFloatTableRange(table_name, 0, values) == values.size();
+}
+
+bool PACControlClient::writeInt32Table(const string &table_name, const vector<int32_t> &values)
+{
+    return writeInt32TableRange(table_name, 0, values) == values.size();
+}
+
+// Escritura de un rango contiguo: no hay comando binario de escritura conocido en el PAC,
+// así que se envían los TABLE! por índice en pipeline con una sola pasada de confirmaciones
+size_t PACControlClient::writeFloatTableRange(const string &table_name, int start_index, const vector<float> &values,
+                                              size_t max_in_flight)
+{
+    vector<WriteCommand> commands(values.size());
     for (size_t i = 0; i < values.size(); i++)
     {
-        if (!writeFloatVariable(table_name, i, values[i]))
-        {
-            success = false;
-        }
+        commands[i].command = pac_protocol::buildTableWriteCommand(table_name, start_index + (int)i, values[i]);
     }
-    return success;
+
+    size_t confirmed = writeCommandsPipelined(commands, max_in_flight);
+    DEBUG_INFO("📝 Tabla FLOAT " << table_name << "[" << start_index << ".." << (start_index + (int)values.size() - 1)
+               << "]: " << confirmed << "/" << values.size() << " escrituras confirmadas");
+    clearCacheForTable(table_name);
+    return confirmed;
 }
 
-bool PACControlClient::writeInt32Table(const string &table_name, const vector<int32_t> &values)
+size_t PACControlClient::writeInt32TableRange(const string &table_name, int start_index, const vector<int32_t> &values,
+                                              size_t max_in_flight)
 {
-    bool success = true;
+    vector<WriteCommand> commands(values.size());
     for (size_t i = 0; i < values.size(); i++)
     {
-        if (!writeInt32Variable(table_name, i, values[i]))
-        {
-            success = false;
-        }
+        commands[i].command = pac_protocol::buildTableWriteCommand(table_name, start_index + (int)i, values[i]);
     }
-    return success;
+
+    size_t confirmed = writeCommandsPipelined(commands, max_in_flight);
+    DEBUG_INFO("📝 Tabla INT32 " << table_name << "[" << start_index << ".." << (start_index + (int)values.size() - 1)
+               << "]: " << confirmed << "/" << values.size() << " escrituras confirmadas");
+    clearCacheForTable(table_name);
+    return confirmed;
 }
 
-// Implementaciones de comunicación de bajo nivel
-bool PACControlClient::sendCommand(const string &command)
+// Implementaciones de comunicación de bajo nivel: todo pasa por el motor de E/S
+IoStatus PACControlClient::exchange(const string &command, IoFrame frame, vector<uint8_t> &response,
+                                    chrono::milliseconds timeout, bool desync_after)
 {
-    if (sock < 0) {
-        //cout << "❌ Socket inválido - Marcando como desconectado" << endl;
-        connected = false;
-        return false;
-    }
+    response.clear();
+    if (!connected)
+        return IoStatus::NOT_CONNECTED;
+
+    IoStatus result = IoStatus::NOT_CONNECTED;
+    vector<IoRequest> batch(1);
+    batch[0].tx = command;
+    batch[0].frame = frame;
+    batch[0].timeout = timeout;
+    batch[0].desync_after = desync_after;
+    batch[0].on_complete = [&](IoStatus status, span<const uint8_t> bytes) {
+        result = status;
+        response.assign(bytes.begin(), bytes.end());
+        return true;
+    };
 
-    ssize_t bytes_sent = send(sock, command.c_str(), command.length(), 0);
-    if (bytes_sent != (ssize_t)command.length()) {
-        //cout << "❌ Error enviando comando - Esperado: " << command.length() << " Enviado: " << bytes_sent << " (errno: " << errno << ")" << endl;
-        //cout << "🔌 ERROR DE ENVÍO - Marcando como desconectado" << endl;
-        connected = false;  // MARCAR COMO DESCONECTADO
-        return false;
+    io->submit(io_conn, std::move(batch)).wait();
+
+    metrics->bytes_out.fetch_add(command.size(), memory_order_relaxed);
+    metrics->bytes_in.fetch_add(response.size(), memory_order_relaxed);
+    if (result != IoStatus::OK)
+        countFailure(result);
+    if (result == IoStatus::TIMEOUT)
+    {
+        LOG_DEBUG("⏰ TIMEOUT esperando datos del PAC");
     }
-    
-    return true;
+    return result;
 }
 
-// CORRECCIÓN: Función para recibir datos con header PAC de 2 bytes
-vector<uint8_t> PACControlClient::receiveData(size_t expected_bytes)
+// CORRECCIÓN: El PAC envía 2 bytes de header + datos reales
+vector<uint8_t> PACControlClient::requestTableData(const string &command, size_t expected_bytes, bool desync_after)
 {
-    vector<uint8_t> buffer;
-    
-    // CORRECCIÓN: El PAC envía 2 bytes de header + datos reales
-    size_t total_expected = expected_bytes + 2;  // 2 bytes header + datos
-    
+    size_t total_expected = expected_bytes + pac_protocol::TABLE_HEADER_BYTES;
     LOG_DEBUG("📥 Esperando " << total_expected << " bytes total (2 header + " << expected_bytes << " datos)");
-    
-    buffer.resize(total_expected);
-    size_t bytes_received = 0;
-    
-    auto start_time = chrono::steady_clock::now();
-    
-    // 🔧 CORREGIDO: Loop principal de recepción
-    while (bytes_received < total_expected)
-    {
-        auto current_time = chrono::steady_clock::now();
-        auto elapsed = chrono::duration_cast<chrono::milliseconds>(current_time - start_time);
-        
-        // Timeout después de 3 segundos
-        if (elapsed.count() > 3000) {
-            DEBUG_INFO("⏰ TIMEOUT recibiendo datos después de " << elapsed.count() << "ms");
-            break;
-        }
-        
-        // � CORREGIDO: recv() en modo bloqueante normal
-        ssize_t result = recv(sock, buffer.data() + bytes_received, total_expected - bytes_received, 0);
-        
-        if (result > 0)
-        {
-            bytes_received += result;
-            LOG_DEBUG("📡 Recibidos " << result << " bytes, total: " << bytes_received << "/" << total_expected);
-        }
-        else if (result == 0)
-        {
-            DEBUG_INFO("❌ Conexión cerrada por el servidor");
-            break;
-        }
-        else
-        {
-            DEBUG_INFO("❌ Error recv: " << strerror(errno));
-            break;
-        }
-    }
-    
-    // 🔧 CORREGIDO: Verificar datos después del loop
-    if (bytes_received < total_expected)
+
+    vector<uint8_t> frame;
+    if (exchange(command, IoFrame::fixed(total_expected), frame, IO_TIMEOUT, desync_after) != IoStatus::OK)
     {
-        DEBUG_INFO("⚠️ Datos incompletos: recibidos " << bytes_received << ", esperados " << total_expected);
+        DEBUG_INFO("⚠️ Datos incompletos: esperados " << total_expected << " bytes");
         return {};
     }
-    
-    // CORRECCIÓN: Mostrar header (2 bytes) y datos por separado
-    LOG_DEBUG("📋 HEADER PAC (2 bytes): ");
-    for (size_t i = 0; i < 2 && i < bytes_received; i++) {
-        LOG_DEBUG(hex << setfill('0') << setw(2) << (int)buffer[i] << " ");
-    }
-    LOG_DEBUG(dec);
-    
-    LOG_DEBUG("📋 DATOS REALES (" << (bytes_received - 2) << " bytes): ");
-    for (size_t i = 2; i < min(bytes_received, size_t(22)); i++) {
-        LOG_DEBUG(hex << setfill('0') << setw(2) << (int)buffer[i] << " ");
-    }
-    LOG_DEBUG(dec);
-    
-    // CORRECCIÓN: Retornar solo los datos sin el header de 2 bytes
-    if (bytes_received >= 2) {
-        vector<uint8_t> data_only(buffer.begin() + 2, buffer.end());
-        LOG_DEBUG("✅ Tabla válida: Retornando " << data_only.size() << " bytes de datos (sin header de 2 bytes)");
-        return data_only;
-    } else {
-        DEBUG_INFO("❌ No hay suficientes datos para extraer header de 2 bytes");
+
+    PAC_TRACE_BYTES("📋 HEADER PAC", frame.data(), pac_protocol::TABLE_HEADER_BYTES);
+    frame.erase(frame.begin(), frame.begin() + pac_protocol::TABLE_HEADER_BYTES);
+    return frame;
+}
+
+// Respuesta ASCII terminada en espacio 0x20: el motor busca el terminador con memchr
+vector<uint8_t> PACControlClient::requestASCIIResponse(const string &command)
+{
+    LOG_DEBUG("📋 Esperando respuesta ASCII (terminador: espacio 0x20)...");
+
+    vector<uint8_t> raw_data;
+    if (exchange(command, IoFrame::delimited(0x20, MAX_ASCII_RESPONSE), raw_data) != IoStatus::OK)
+    {
+        LOG_DEBUG("⏰ Respuesta ASCII incompleta o demasiado larga");
         return {};
     }
+
+    LOG_DEBUG("📋 Respuesta ASCII completa recibida: " << raw_data.size() << " bytes");
+    return raw_data;
 }
-// 🔧 NUEVO: Limpiar buffer del socket para evitar datos residuales
-void PACControlClient::flushSocketBuffer() {
-    if (sock < 0 || !connected) return;
-    
-    // Configurar socket como no-bloqueante temporalmente
-    int flags = fcntl(sock, F_GETFL, 0);
-    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
-    
-    char temp_buffer[1024];
-    int flushed_bytes = 0;
-    
-    // Leer cualquier dato residual del buffer del socket
-    while (true) {
-        ssize_t bytes = recv(sock, temp_buffer, sizeof(temp_buffer), 0);
-        if (bytes <= 0) break;
-        flushed_bytes += bytes;
+
+bool PACControlClient::requestWriteConfirmation(const string &command)
+{
+    // PAC responde con 2 bytes (00 00) para confirmación exitosa de escritura
+    vector<uint8_t> response;
+    auto sent = chrono::steady_clock::now();
+    if (exchange(command, IoFrame::fixed(2), response, WRITE_CONFIRM_TIMEOUT) != IoStatus::OK)
+    {
+        metrics->writes_failed.fetch_add(1, memory_order_relaxed);
+        LOG_DEBUG("⚠️ TIMEOUT esperando confirmación de escritura");
+        return false;
     }
-    
-    // Restaurar el socket a modo bloqueante
-    fcntl(sock, F_SETFL, flags);
-    
-    if (flushed_bytes > 0) {
-        // //cout << "🧹 BUFFER LIMPIADO: Eliminados " << flushed_bytes << " bytes residuales del socket" << endl;
+
+    if (response[0] == 0x00 && response[1] == 0x00)
+    {
+        metrics->write_latency.record(chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now() - sent).count());
+        metrics->writes_ok.fetch_add(1, memory_order_relaxed);
+        LOG_DEBUG("✅ Confirmación de escritura exitosa: 00 00");
+        return true;
     }
+
+    metrics->writes_failed.fetch_add(1, memory_order_relaxed);
+    metrics->desyncs.fetch_add(1, memory_order_relaxed);
+
+    LOG_DEBUG("❌ Confirmación de escritura inválida - Esperado: 00 00, Recibido: "
+                 << hex << setfill('0') << setw(2) << (int)response[0] << " "
+                 << setw(2) << (int)response[1] << dec);
+    io->discardInput(io_conn);
+    return false;
+}
+
+// Respuesta sin trama conocida: lo que llegue primero; no sabemos si el PAC envió más,
+// así que el motor descarta el resto antes del siguiente comando
+string PACControlClient::requestResponse(const string &command)
+{
+    vector<uint8_t> response;
+    exchange(command, IoFrame::any(), response, IO_TIMEOUT, true);
+    return string(response.begin(), response.end());
 }
 
 // 🔧 NUEVO: Validar integridad de datos para detectar contaminación
@@ -573,46 +731,29 @@ vector<float> PACControlClient::convertBytesToFloats(const vector<uint8_t>& data
     
     DEBUG_INFO("🔄 convertBytesToFloats: " << data.size() << " bytes de entrada (sin header de 2 bytes)");
     
-    // Mostrar datos raw en hex por bloques de 4
-    DEBUG_INFO("🔍 RAW DATA por bloques de 4 bytes:");
-    for (size_t i = 0; i < data.size(); i += 4) {
-        if (i + 3 < data.size()) {
-            DEBUG_INFO("  Bytes[" << setw(2) << i << "-" << setw(2) << (i+3) << "]: " 
-                 << hex << setfill('0') << setw(2) << (int)data[i] << " "
-                 << setw(2) << (int)data[i+1] << " " << setw(2) << (int)data[i+2] << " "
-                 << setw(2) << (int)data[i+3] << dec);
-        }
-    }
+    PAC_TRACE_BYTES("🔍 RAW DATA", data.data(), data.size());
     
     if (data.size() % 4 != 0) {
         DEBUG_INFO("⚠️ ADVERTENCIA: Tamaño de datos no es múltiplo de 4: " << data.size());
     }
     
-    for (size_t i = 0; i + 3 < data.size(); i += 4) {
-        
-        // USAR LITTLE ENDIAN (confirmado por el test Python)
-        uint32_t little_endian_val = data[i] | (data[i+1] << 8) | (data[i+2] << 16) | (data[i+3] << 24);
-        float little_endian_float;
-        memcpy(&little_endian_float, &little_endian_val, sizeof(float));
-        
-        DEBUG_INFO("  Float[" << i/4 << "]: bytes=" << hex << setfill('0') 
-             << setw(2) << (int)data[i] << " " << setw(2) << (int)data[i+1] << " "
-             << setw(2) << (int)data[i+2] << " " << setw(2) << (int)data[i+3] << dec
-             << " -> uint32=" << little_endian_val << " -> float=" << little_endian_float);
-        
-        // Verificar si el valor es razonable
-        if (std::isfinite(little_endian_float) && !std::isnan(little_endian_float)) {
-            floats.push_back(little_endian_float);
-            DEBUG_INFO("    ✅ Valor aceptado: " << little_endian_float);
-        } else {
-            DEBUG_INFO("    ⚠️ Valor extraño, usando 0.0: " << little_endian_float);
-            floats.push_back(0.0f);
+    // Decodificación masiva (SIMD si la CPU lo soporta) marcando los valores no finitos
+    floats.resize(data.size() / 4);
+    pac_protocol::FloatDecodeResult decoded = pac_protocol::decodeFloatsChecked(data, floats);
+
+    // Caso raro: sólo entonces se recorre elemento a elemento
+    if (decoded.non_finite > 0) {
+        for (size_t i = 0; i < floats.size(); i++) {
+            if (!std::isfinite(floats[i])) {
+                DEBUG_INFO("    ⚠️ Valor extraño en [" << i << "], usando 0.0: " << floats[i]);
+                floats[i] = 0.0f;
+            }
         }
     }
     
     DEBUG_INFO("✓ Convertidos " << floats.size() << " floats");
     DEBUG_INFO("🎯 Valores finales: ");
-    for (size_t i = 0; i < floats.size(); i++) {
+    for (size_t i = 0; LOG_DEBUG_ACTIVE() && i < floats.size(); i++) {
         DEBUG_INFO("  [" << i << "] = " << floats[i]);
     }
     
@@ -632,10 +773,8 @@ vector<int32_t> PACControlClient::convertBytesToInt32s(const vector<uint8_t>& da
         int32_t signed_val;
         memcpy(&signed_val, &int_val, sizeof(int32_t));
         
-        DEBUG_INFO("  Int32[" << i/4 << "]: bytes=" << hex << setfill('0') 
-             << setw(2) << (int)data[i] << " " << setw(2) << (int)data[i+1] << " "
-             << setw(2) << (int)data[i+2] << " " << setw(2) << (int)data[i+3] << dec
-             << " -> uint32=" << int_val << " -> int32=" << signed_val);
+        PAC_TRACE("  Int32[" << i/4 << "]: bytes=" << hexBytes(&data[i], 4)
+                  << " -> uint32=" << int_val << " -> int32=" << signed_val);
         
         int32s.push_back(signed_val);
     }
@@ -679,39 +818,34 @@ vector<uint8_t> PACControlClient::convertInt32sToBytes(const vector<int32_t> &in
     return bytes;
 }
 
-bool PACControlClient::isCacheValid(const string &key)
+TableId PACControlClient::tableIdOf(const string &table_name) const
 {
-    auto it = table_cache.find(key);
-    if (it == table_cache.end() || !it->second.valid)
+    return table_registry ? table_registry->find(table_name) : NO_TABLE;
+}
+
+void PACControlClient::setTableRegistry(const TableRegistry *registry)
+{
+    // comm_mutex: las lecturas síncronas consultan el registro; cache_mutex: el bloque
+    lock_guard<mutex> lock(comm_mutex);
+    lock_guard<mutex> cache_lock(cache_mutex);
+    table_registry = registry;
+    table_metrics.clear();
+    if (registry)
     {
-        return false;
+        table_cache.layout(*registry);
+        for (TableId id = 0; id < registry->count(); id++)
+            table_metrics.push_back(&metrics->table(registry->name(id)));
     }
-
-    auto now = chrono::steady_clock::now();
-    auto elapsed = chrono::duration_cast<chrono::milliseconds>(
-                       now - it->second.timestamp)
-                       .count();
-
-    return elapsed < CACHE_TIMEOUT_MS;
+    else
+        table_cache = TableCache();
 }
 
 void PACControlClient::clearCache()
 {
+    lock_guard<mutex> lock(cache_mutex);
     table_cache.clear();
 }
 
-// Comandos básicos heredados del análisis anterior
-string PACControlClient::receiveResponse()
-{
-    char buffer[2048] = {0}; // Buffer más grande
-    ssize_t bytes = recv(sock, buffer, sizeof(buffer) - 1, 0);
-    if (bytes > 0) {
-        buffer[bytes] = '\0';
-        return string(buffer);
-    }
-    return "";
-}
-
 // Función para detectar automáticamente el tipo de datos en una tabla
 bool PACControlClient::detectDataType(const string& table_name, bool& is_integer_data) {
     lock_guard<mutex> lock(comm_mutex);
@@ -745,11 +879,8 @@ bool PACControlClient::detectDataType(const string& table_name, bool& is_integer
     
     string command = cmd.str();
     
-    if (!sendCommand(command)) {
-        return false;
-    }
-    
-    vector<uint8_t> raw_data = receiveData(8); // Solo 2 valores para análisis
+    // Solo 2 valores para análisis: el resto de la tabla queda en el socket y se descarta
+    vector<uint8_t> raw_data = requestTableData(command, 8, true);
     if (raw_data.size() < 8) {
         return false;
     }
@@ -837,43 +968,35 @@ vector<int32_t> PACControlClient::readTableAsInt32(const string& table_name,
     string command = cmd.str();
     //cout << "📊 LEYENDO TABLA INT32: " << table_name << endl;
 
-    // 🔧 SOLUCIÓN: Limpiar buffer del socket antes de enviar comando
-    flushSocketBuffer();
-    
-    if (!sendCommand(command)) {
-        cerr << "Error enviando comando int32" << endl;
-        return {};
-    }
-
     // Calcular bytes esperados (cada int32 = 4 bytes)
     int num_ints = end_pos - start_pos + 1;
     size_t expected_bytes = num_ints * 4;
 
-    vector<uint8_t> raw_data = receiveData(expected_bytes);
+    // El comando siempre pide la tabla completa (0-9): si se esperaba menos, sobran bytes
+    bool partial = expected_bytes != pac_protocol::tableResponseBytes(0, 9);
+
+    vector<uint8_t> raw_data = requestTableData(command, expected_bytes, partial);
     if (raw_data.empty()) {
         cerr << "Error recibiendo datos int32 de tabla" << endl;
         return {};
     }
-    
+
     // 🔧 SOLUCIÓN: Validar integridad de los datos recibidos
     if (!validateDataIntegrity(raw_data, table_name)) {
+        io->discardInput(io_conn);
         //cout << "⚠️  DATOS INT32 RECHAZADOS por validación de integridad: " << table_name << endl;
         
         // 🔧 RETRY: Intentar una segunda vez con delay si hay contaminación
         //cout << "🔄 REINTENTANDO lectura int32 después de 100ms..." << endl;
+        metrics->retries.fetch_add(1, memory_order_relaxed);
         this_thread::sleep_for(chrono::milliseconds(100));
         
-        flushSocketBuffer();
-        if (sendCommand(command)) {
-            vector<uint8_t> retry_data = receiveData(expected_bytes);
-            if (!retry_data.empty() && validateDataIntegrity(retry_data, table_name)) {
-                //cout << "✅ RETRY INT32 EXITOSO: Datos válidos obtenidos en segundo intento" << endl;
-                raw_data = retry_data;
-            } else {
-                //cout << "❌ RETRY INT32 FALLIDO: Datos siguen siendo inválidos" << endl;
-                return {};
-            }
+        vector<uint8_t> retry_data = requestTableData(command, expected_bytes, partial);
+        if (!retry_data.empty() && validateDataIntegrity(retry_data, table_name)) {
+            //cout << "✅ RETRY INT32 EXITOSO: Datos válidos obtenidos en segundo intento" << endl;
+            raw_data = retry_data;
         } else {
+            //cout << "❌ RETRY INT32 FALLIDO: Datos siguen siendo inválidos" << endl;
             return {};
         }
     }
@@ -918,6 +1041,9 @@ void PACControlClient::analyzeDataStability(const string& table_name, const vect
                 }
             }
             
+            TableMetrics& table = metrics->table(table_name);
+            (differences == 0 ? table.unchanged_reads : table.changed_reads).fetch_add(1, memory_order_relaxed);
+
             if (differences == 0) {
                 //cout << "  ✅ DATOS IDÉNTICOS - Sin cambios" << endl;
             } else {
@@ -960,124 +1086,27 @@ vector<string> PACControlClient::getTasks()
     return {};
 }
 
-// CORRECCIÓN: Funciones auxiliares con LOG_DEBUG
+// CORRECCIÓN: Funciones auxiliares con LOG_DEBUG (el parseo vive en pac_protocol)
 string PACControlClient::cleanASCIINumber(const string& ascii_str)
 {
-    string result;
-    bool decimal_found = false;
-    bool negative_found = false;
-    bool exponent_found = false;
-    bool exponent_sign_found = false;
-    
     LOG_DEBUG("🔍 LIMPIANDO NÚMERO ASCII: '" << ascii_str << "'");
-    
-    // Procesar cada caracter para extraer un número válido
-    for (char c : ascii_str) {
-        // Ignorar bytes nulos y caracteres de control
-        if (c == '\0' || c == '\r' || c == '\n' || c == '\t') {
-            continue;
-        }
-        
-        // Dígitos siempre son válidos
-        if (std::isdigit(c)) {
-            result += c;
-        }
-        // Signo negativo solo al principio
-        else if (c == '-' && !negative_found && result.empty()) {
-            result += c;
-            negative_found = true;
-        }
-        // Punto decimal solo una vez
-        else if (c == '.' && !decimal_found && !exponent_found) {
-            result += c;
-            decimal_found = true;
-        }
-        // Notación científica (e/E)
-        else if ((c == 'e' || c == 'E') && !exponent_found && !result.empty()) {
-            result += c;
-            exponent_found = true;
-        }
-        // Signo en exponente
-        else if ((c == '+' || c == '-') && exponent_found && !exponent_sign_found && 
-                 (result.back() == 'e' || result.back() == 'E')) {
-            result += c;
-            exponent_sign_found = true;
-        }
-        // Espacios al final terminan el número
-        else if (c == ' ' && !result.empty()) {
-            break;
-        }
-        // Otros caracteres no válidos se ignoran
-    }
-    
+    string result = pac_protocol::cleanASCIINumber(ascii_str);
     LOG_DEBUG("🔍 NÚMERO LIMPIO: '" << result << "'");
-    
-    // Validar que el resultado es un número válido
-    if (result.empty() || result == "-" || result == "." || result == "e" || result == "E") {
-        LOG_DEBUG("⚠️  NÚMERO INVÁLIDO después de limpiar: '" << result << "'");
-        return "0";
-    }
-    
     return result;
 }
 
 
 float PACControlClient::convertStringToFloat(const string& str) {
-    if (str.empty()) {
-        return 0.0f;
-    }
-    
-    try {
-        float value = std::stof(str);
-        
-        if (std::isnan(value) || std::isinf(value)) {
-            LOG_DEBUG("⚠️  VALOR FLOAT INVÁLIDO: " << str << " -> " << value);
-            return 0.0f;
-        }
-        
-        LOG_DEBUG("✅ CONVERSIÓN EXITOSA: '" << str << "' -> " << value);
-        return value;
-        
-    } catch (const std::invalid_argument& e) {
-        LOG_DEBUG("❌ ERROR: Argumento inválido para conversión: '" << str << "' - " << e.what());
-        return 0.0f;
-    } catch (const std::out_of_range& e) {
-        LOG_DEBUG("❌ ERROR: Valor fuera de rango: '" << str << "' - " << e.what());
-        return 0.0f;
-    } catch (const exception& e) {
-        LOG_DEBUG("❌ ERROR: Excepción general en conversión: '" << str << "' - " << e.what());
-        return 0.0f;
-    }
+    float value = pac_protocol::parseFloat(str);
+    LOG_DEBUG("✅ CONVERSIÓN FLOAT: '" << str << "' -> " << value);
+    return value;
 }
 
 
 int32_t PACControlClient::convertStringToInt32(const string& str) {
-    if (str.empty()) {
-        return 0;
-    }
-    
-    try {
-        double double_value = std::stod(str);
-        
-        if (double_value > INT32_MAX || double_value < INT32_MIN) {
-            LOG_DEBUG("⚠️  VALOR FUERA DE RANGO INT32: " << str << " -> " << double_value);
-            return 0;
-        }
-        
-        int32_t value = static_cast<int32_t>(double_value);
-        LOG_DEBUG("✅ CONVERSIÓN INT32 EXITOSA: '" << str << "' -> " << value);
-        return value;
-        
-    } catch (const std::invalid_argument& e) {
-        LOG_DEBUG("❌ ERROR: Argumento inválido para conversión int32: '" << str << "' - " << e.what());
-        return 0;
-    } catch (const std::out_of_range& e) {
-        LOG_DEBUG("❌ ERROR: Valor fuera de rango int32: '" << str << "' - " << e.what());
-        return 0;
-    } catch (const exception& e) {
-        LOG_DEBUG("❌ ERROR: Excepción general en conversión int32: '" << str << "' - " << e.what());
-        return 0;
-    }
+    int32_t value = pac_protocol::parseInt32(str);
+    LOG_DEBUG("✅ CONVERSIÓN INT32: '" << str << "' -> " << value);
+    return value;
 }
 
 
@@ -1098,26 +1127,15 @@ float PACControlClient::readSingleFloatVariableByTag(const string& tag_name)
     
     LOG_DEBUG("📋 Enviando comando: '" << command.substr(0, command.length()-1) << "\\r'");
 
-    flushSocketBuffer();
-    
-    if (!sendCommand(command)) {
-        cerr << "❌ Error enviando comando variable float individual" << endl;
-        return 0.0f;
-    }
-
     // Recibir respuesta ASCII terminada en espacio 0x20
-    vector<uint8_t> raw_data = receiveASCIIResponse();
+    vector<uint8_t> raw_data = requestASCIIResponse(command);
     if (raw_data.empty()) {
         cerr << "❌ Error: respuesta vacía para variable float individual" << endl;
         return 0.0f;
     }
 
     // 🔍 DIAGNÓSTICO: Mostrar datos RAW recibidos
-    LOG_DEBUG("🔍 VARIABLE FLOAT RAW DATA (" << raw_data.size() << " bytes): ");
-    for (size_t i = 0; i < raw_data.size(); i++) {
-        LOG_DEBUG(hex << setfill('0') << setw(2) << (int)raw_data[i] << " ");
-    }
-    LOG_DEBUG(dec);
+    PAC_TRACE_BYTES("🔍 VARIABLE FLOAT RAW DATA", raw_data.data(), raw_data.size());
 
     // Convertir bytes a string ASCII limpio
     string ascii_response = convertBytesToASCII(raw_data);
@@ -1163,26 +1181,15 @@ int32_t PACControlClient::readSingleInt32VariableByTag(const string& tag_name)
     
     LOG_DEBUG("📋 Enviando comando: '" << command.substr(0, command.length()-1) << "\\r'");
 
-    flushSocketBuffer();
-    
-    if (!sendCommand(command)) {
-        cerr << "❌ Error enviando comando variable int32 individual" << endl;
-        return 0;
-    }
-
     // Recibir respuesta ASCII terminada en espacio 0x20
-    vector<uint8_t> raw_data = receiveASCIIResponse();
+    vector<uint8_t> raw_data = requestASCIIResponse(command);
     if (raw_data.empty()) {
         cerr << "❌ Error: respuesta vacía para variable int32 individual" << endl;
         return 0;
     }
 
     // 🔍 DIAGNÓSTICO: Mostrar datos RAW recibidos
-    LOG_DEBUG("🔍 VARIABLE INT32 RAW DATA (" << raw_data.size() << " bytes): ");
-    for (size_t i = 0; i < raw_data.size(); i++) {
-        LOG_DEBUG(hex << setfill('0') << setw(2) << (int)raw_data[i] << " ");
-    }
-    LOG_DEBUG(dec);
+    PAC_TRACE_BYTES("🔍 VARIABLE INT32 RAW DATA", raw_data.data(), raw_data.size());
 
     // Convertir bytes a string ASCII limpio
     string ascii_response = convertBytesToASCII(raw_data);
@@ -1205,84 +1212,83 @@ int32_t PACControlClient::readSingleInt32VariableByTag(const string& tag_name)
     return value;
 }
 
-// CORRECCIÓN: Función receiveASCIIResponse con LOG_DEBUG
-vector<uint8_t> PACControlClient::receiveASCIIResponse()
+// Lectura en lote de variables individuales: todos los comandos ^NAME @@ F. / ^NAME @@ .
+// se escriben seguidos y las respuestas ASCII se consumen en el mismo orden
+map<string, ScalarReadResult> PACControlClient::readMultipleSingleVariables(const vector<pair<string, string>>& variables,
+                                                                            size_t max_in_flight)
 {
-    vector<uint8_t> raw_data;
-    char byte;
-    
-    auto start_time = chrono::steady_clock::now();
-    const int timeout_ms = 3000; // 3 segundos timeout
+    lock_guard<mutex> lock(comm_mutex);
 
-    LOG_DEBUG("📋 Esperando respuesta ASCII (terminador: espacio 0x20)...");
-    
-    while (true) {
-        auto elapsed = chrono::duration_cast<chrono::milliseconds>(
-            chrono::steady_clock::now() - start_time).count();
-        
-        if (elapsed > timeout_ms) {
-            LOG_DEBUG("⏰ TIMEOUT recibiendo respuesta ASCII después de " << elapsed << "ms");
-            break;
-        }
-        
-        ssize_t bytes = recv(sock, &byte, 1, 0); // Bloqueante para mejor estabilidad
-        
-        if (bytes == 1) {
-            // CORRECCIÓN: Detectar terminador espacio 0x20
-            if (static_cast<uint8_t>(byte) == 0x20) {
-                LOG_DEBUG("📋 Terminador espacio (0x20) detectado - Fin de respuesta");
-                break;
-            }
-            
-            // Agregar byte a la respuesta
-            raw_data.push_back(static_cast<uint8_t>(byte));
-            
-            // Debug: mostrar cada byte recibido
-            LOG_DEBUG("📡 Byte recibido: 0x" << hex << setfill('0') << setw(2) 
-                 << (int)(uint8_t)byte << dec);
-            if (byte >= 32 && byte <= 126) {
-                LOG_DEBUG(" ('" << byte << "')");
+    map<string, ScalarReadResult> results;
+
+    if (!connected) {
+        cerr << "No conectado al PAC" << endl;
+        return results;
+    }
+
+    readScalarsAsync(variables, results, max_in_flight).wait();
+    return results;
+}
+
+future<void> PACControlClient::readScalarsAsync(const vector<pair<string, string>>& variables,
+                                                map<string, ScalarReadResult>& results, size_t max_in_flight)
+{
+    if (!connected || variables.empty())
+        return readyFuture();
+
+    if (max_in_flight == 0)
+        max_in_flight = 1;
+
+    auto aborted = make_shared<bool>(false);
+
+    vector<IoRequest> batch(variables.size());
+    size_t bytes_out = 0;
+    for (size_t i = 0; i < variables.size(); i++) {
+        const auto& [tag_name, type] = variables[i];
+        IoRequest& io_req = batch[i];
+
+        io_req.tx = "^" + tag_name + (type == "INT32" ? " @@ .\r" : " @@ F.\r");
+        bytes_out += io_req.tx.size();
+        io_req.frame = IoFrame::delimited(0x20, MAX_ASCII_RESPONSE);
+        io_req.timeout = IO_TIMEOUT;
+        io_req.max_in_flight = max_in_flight;
+        io_req.on_complete = [this, &variable = variables[i], &results, aborted, remaining = variables.size() - i](
+                                 IoStatus status, span<const uint8_t> response) {
+            const auto& [tag_name, type] = variable;
+            if (status != IoStatus::OK) {
+                // Sin terminador no se sabe a qué variable pertenecen los bytes siguientes
+                if (!*aborted) {
+                    LOG_PAC("⚠️ Lote de escalares abortado en " << tag_name << " (" << remaining << " sin leer)");
+                    countFailure(status);
+                    *aborted = true;
+                }
+                return true;
             }
-            
-            // Protección contra respuestas muy largas
-            if (raw_data.size() > 50) {
-                LOG_DEBUG("⚠️  Respuesta muy larga (>50 bytes), cortando");
-                break;
+            metrics->bytes_in.fetch_add(response.size() + 1, memory_order_relaxed);  // + terminador 0x20
+
+            string clean_value = cleanASCIINumber(pac_protocol::bytesToASCII(vector<uint8_t>(response.begin(), response.end())));
+
+            ScalarReadResult& result = results[tag_name];
+            result.ok = true;
+            if (type == "INT32") {
+                result.is_int32 = true;
+                result.int_value = convertStringToInt32(clean_value);
+            } else {
+                result.float_value = convertStringToFloat(clean_value);
             }
-            
-        } else if (bytes == 0) {
-            LOG_DEBUG("🔌 Conexión cerrada por el PAC");
-            connected = false;
-            break;
-        } else if (bytes < 0) {
-            LOG_DEBUG("❌ Error en recv: errno=" << errno);
-            connected = false;
-            break;
-        }
-    }
-    
-    LOG_DEBUG("📋 Respuesta ASCII completa recibida: " << raw_data.size() << " bytes");
-    
-    // Mostrar datos completos en hex
-    LOG_DEBUG("🔍 Datos hex: ");
-    for (uint8_t b : raw_data) {
-        LOG_DEBUG(hex << setfill('0') << setw(2) << (int)b << " ");
+            return true;
+        };
     }
-    LOG_DEBUG(dec);
-    
-    return raw_data;
+
+    metrics->bytes_out.fetch_add(bytes_out, memory_order_relaxed);
+    LOG_DEBUG("📤 LOTE ESCALARES: " << batch.size() << " variables (hasta " << max_in_flight << " en vuelo)");
+    return io->submit(io_conn, std::move(batch));
 }
 
-// Función para convertir bytes a string ASCII
+// Función para convertir bytes a string ASCII (códec en pac_protocol)
 string PACControlClient::convertBytesToASCII(const vector<uint8_t>& bytes)
 {
-    string result;
-    for (uint8_t byte : bytes) {
-        if (byte >= 32 && byte <= 126) { // Solo caracteres ASCII imprimibles
-            result += static_cast<char>(byte);
-        }
-    }
-    return result;
+    return pac_protocol::bytesToASCII(bytes);
 }
 
 // NUEVA FUNCIÓN: Función auxiliar para validación de variable individual
@@ -1311,66 +1317,79 @@ bool PACControlClient::validateSingleVariableIntegrity(const vector<uint8_t>& da
     return true;
 }
 
-bool PACControlClient::receiveWriteConfirmation()
+// Escrituras en pipeline: un IoRequest por comando con ventana max_in_flight; cada
+// confirmación se valida en orden y una inválida aborta el resto (stream desincronizado)
+size_t PACControlClient::writeCommandsPipelined(vector<WriteCommand> &commands, size_t max_in_flight)
 {
-    // PAC responde con 2 bytes (FF FF) para confirmación exitosa de escritura
-    vector<uint8_t> response(2);
-    size_t bytes_received = 0;
-    
-    auto start_time = chrono::steady_clock::now();
-    
-    while (bytes_received < 2)
+    lock_guard<mutex> lock(comm_mutex);
+
+    for (auto &cmd : commands)
     {
-        auto current_time = chrono::steady_clock::now();
-        auto elapsed = chrono::duration_cast<chrono::milliseconds>(current_time - start_time);
-        
-        if (elapsed.count() > 1000) // Timeout 1 segundo
-        {
-            LOG_DEBUG("⚠️ TIMEOUT esperando confirmación de escritura después de " << elapsed.count() << "ms");
-            LOG_DEBUG("📊 Recibidos " << bytes_received << " de 2 bytes");
-            return false;
-        }
-        
-        ssize_t result = recv(sock, response.data() + bytes_received, 2 - bytes_received, MSG_DONTWAIT);
-        
-        if (result > 0)
-        {
-            bytes_received += result;
-            LOG_DEBUG("📡 Confirmación: recibidos " << result << " bytes, total: " << bytes_received << "/2");
-        }
-        else if (result == 0)
-        {
-            LOG_DEBUG("🔌 Conexión cerrada por el servidor durante confirmación");
-            connected = false;
-            return false;
-        }
-        else if (errno != EAGAIN && errno != EWOULDBLOCK)
-        {
-            LOG_DEBUG("❌ Error recibiendo confirmación: " << strerror(errno));
-            return false;
-        }
-        
-        // Pequeña pausa para evitar uso excesivo de CPU
-        this_thread::sleep_for(chrono::milliseconds(1));
+        cmd.ok = false;
+        cmd.sent = false;
     }
-    
-    // Verificar si la respuesta es la confirmación esperada (00 00)
-    if (bytes_received == 2 && response[0] == 0x00 && response[1] == 0x00)
+
+    if (!connected)
     {
-        LOG_DEBUG("✅ Confirmación de escritura exitosa: 00 00");
-        return true;
+        LOG_ERROR("❌ No conectado al PAC: " << commands.size() << " escrituras sin enviar");
+        return 0;
     }
-    else
+
+    if (max_in_flight == 0)
+        max_in_flight = 1;
+
+    size_t confirmed = 0;
+    bool aborted = false;
+    auto submitted = chrono::steady_clock::now();
+
+    vector<IoRequest> batch(commands.size());
+    size_t bytes_out = 0;
+    for (size_t i = 0; i < commands.size(); i++)
     {
-        LOG_DEBUG("❌ Confirmación de escritura inválida - Esperado: 00 00, Recibido: " 
-                     << hex << setfill('0') << setw(2) << (int)response[0] << " " 
-                     << setw(2) << (int)response[1] << dec);
-        return false;
-    }
+        batch[i].tx = commands[i].command;
+        bytes_out += batch[i].tx.size();
+        batch[i].frame = IoFrame::fixed(2);
+        batch[i].timeout = WRITE_CONFIRM_TIMEOUT;
+        batch[i].max_in_flight = max_in_flight;
+        batch[i].on_complete = [&, i](IoStatus status, span<const uint8_t> response) {
+            // El motor completa con TIMEOUT/DESYNCED/CLOSED también lo que nunca escribió: sólo
+            // una respuesta demuestra que el comando salió
+            commands[i].sent = status == IoStatus::OK;
+            bool valid = status == IoStatus::OK && response[0] == 0x00 && response[1] == 0x00;
+            if (status == IoStatus::OK)
+                metrics->bytes_in.fetch_add(response.size(), memory_order_relaxed);
+            if (!valid)
+            {
+                metrics->writes_failed.fetch_add(1, memory_order_relaxed);
+
+                // Sin confirmación no se sabe a qué comando corresponde lo que llegue después
+                if (!aborted)
+                {
+                    LOG_PAC("⚠️ Pipeline de escritura abortado (" << (commands.size() - i) << " escrituras sin confirmar)");
+                    countFailure(status == IoStatus::OK ? IoStatus::DESYNCED : status);
+                    aborted = true;
+                }
+                return false;  // Confirmación distinta de 00 00: el motor aborta el resto
+            }
+            metrics->write_latency.record(chrono::duration_cast<chrono::microseconds>(
+                chrono::steady_clock::now() - submitted).count());
+            metrics->writes_ok.fetch_add(1, memory_order_relaxed);
+            commands[i].ok = true;
+            confirmed++;
+            return true;
+        };
+    }
+
+    metrics->bytes_out.fetch_add(bytes_out, memory_order_relaxed);
+    LOG_DEBUG("📤 PIPELINE ESCRITURA: " << commands.size() << " comandos (hasta " << max_in_flight << " en vuelo)");
+    io->submit(io_conn, std::move(batch)).wait();
+    return confirmed;
 }
 
 void PACControlClient::clearCacheForTable(const std::string &table_name)
 {
+    lock_guard<mutex> cache_lock(cache_mutex);
+    table_cache.invalidate(tableIdOf(table_name));
 }
 
 string PACControlClient::sendRawCommand(const string &command)
@@ -1380,11 +1399,7 @@ string PACControlClient::sendRawCommand(const string &command)
     if (!connected)
         return "";
 
-    string full_cmd = command + "\r";
-    if (!sendCommand(full_cmd))
-        return "";
-
-    return receiveResponse();
+    return requestResponse(command + "\r");
 }
 
 // CORRECCIÓN: Actualizar writeSingleFloatVariable para usar confirmación de 2 bytes
@@ -1397,22 +1412,13 @@ bool PACControlClient::writeSingleFloatVariable(const std::string& variable_name
     }
 
     // Formato: <valor> ^<variable> @!\r
-    std::ostringstream cmd;
-    cmd << std::setprecision(7) << value << " ^" << variable_name << " @!\r";
-    std::string command = cmd.str();
+    std::string command = pac_protocol::buildScalarWriteCommand(variable_name, value);
 
     DEBUG_INFO("🔥 Escribiendo variable FLOAT individual: " << variable_name << " = " << value);
     LOG_DEBUG("📋 Comando: '" << command.substr(0, command.length()-1) << "\\r'");
 
-    flushSocketBuffer();
-
-    if (!sendCommand(command)) {
-        DEBUG_INFO("❌ Error enviando comando de escritura float");
-        return false;
-    }
-
     // CORRECCIÓN: Usar función específica para confirmación de escritura
-    bool success = receiveWriteConfirmation();
+    bool success = requestWriteConfirmation(command);
     
     if (success) {
         DEBUG_INFO("✅ Variable FLOAT escrita exitosamente: " << variable_name << " = " << value);
@@ -1433,22 +1439,13 @@ bool PACControlClient::writeSingleInt32Variable(const std::string& variable_name
     }
 
     // Formato: <valor> ^<variable> @!\r
-    std::ostringstream cmd;
-    cmd << value << " ^" << variable_name << " @!\r";
-    std::string command = cmd.str();
+    std::string command = pac_protocol::buildScalarWriteCommand(variable_name, value);
 
     DEBUG_INFO("🔥 Escribiendo variable INT32 individual: " << variable_name << " = " << value);
     LOG_DEBUG("📋 Comando: '" << command.substr(0, command.length()-1) << "\\r'");
 
-    flushSocketBuffer();
-
-    if (!sendCommand(command)) {
-        DEBUG_INFO("❌ Error enviando comando de escritura int32");
-        return false;
-    }
-
     // CORRECCIÓN: Usar función específica para confirmación de escritura
-    bool success = receiveWriteConfirmation();
+    bool success = requestWriteConfirmation(command);
     
     if (success) {
         DEBUG_INFO("✅ Variable INT32 escrita exitosamente: " << variable_name << " = " << value 
@@ -1468,22 +1465,13 @@ bool PACControlClient::writeFloatTableIndex(const std::string& table_name, int i
     }
 
     // FORMATO CORRECTO confirmado por Python: <valor> <index> }<table> TABLE!\r
-    std::ostringstream cmd;
-    cmd << std::fixed << std::setprecision(3) << value << " " << index << " }" << table_name << " TABLE!\r";
-    std::string command = cmd.str();
+    std::string command = pac_protocol::buildTableWriteCommand(table_name, index, value);
 
     DEBUG_INFO("🔥 Escribiendo tabla FLOAT (FORMATO CORRECTO): " << table_name << "[" << index << "] = " << value);
     LOG_DEBUG("📋 Comando correcto: '" << command.substr(0, command.length()-1) << "\\r'");
 
-    flushSocketBuffer();
-
-    if (!sendCommand(command)) {
-        DEBUG_INFO("❌ Error enviando comando de escritura tabla float");
-        return false;
-    }
-
     // Usar función específica para confirmación de escritura
-    bool success = receiveWriteConfirmation();
+    bool success = requestWriteConfirmation(command);
     
     if (success) {
         DEBUG_INFO("✅ Tabla FLOAT escrita exitosamente: " << table_name << "[" << index << "] = " << value);
@@ -1512,22 +1500,13 @@ bool PACControlClient::writeInt32TableIndex(const std::string& table_name, int i
     }
 
     // FORMATO CORRECTO confirmado: <valor> <index> }<table> TABLE!\r
-    std::ostringstream cmd;
-    cmd << value << " " << index << " }" << table_name << " TABLE!\r";
-    std::string command = cmd.str();
+    std::string command = pac_protocol::buildTableWriteCommand(table_name, index, value);
 
     DEBUG_INFO("🔥 Escribiendo tabla INT32 (FORMATO CORRECTO): " << table_name << "[" << index << "] = " << value);
     LOG_DEBUG("📋 Comando correcto: '" << command.substr(0, command.length()-1) << "\\r'");
 
-    flushSocketBuffer();
-
-    if (!sendCommand(command)) {
-        DEBUG_INFO("❌ Error enviando comando de escritura tabla int32");
-        return false;
-    }
-
     // Usar función específica para confirmación de escritura
-    bool success = receiveWriteConfirmation();
+    bool success = requestWriteConfirmation(command);
     
     if (success) {
         DEBUG_INFO("✅ Tabla INT32 escrita exitosamente: " << table_name << "[" << index << "] = " << value 
@@ -1552,13 +1531,8 @@ void PACControlClient::scheduleWriteVerification(const std::string& table_name,
     // es mejor confiar en la confirmación 00 00 del PAC y la próxima lectura normal
     LOG_DEBUG("📋 Programando verificación para " << table_name << "[" << index << "] = " << expected_value);
     
-    // Marcar en cache que hay un valor pendiente de verificar
-    string verify_key = table_name + "_verify_" + to_string(index);
-    CacheEntry verify_entry;
-    verify_entry.data.push_back(expected_value);
-    verify_entry.timestamp = chrono::steady_clock::now();
-    verify_entry.valid = true;
-    table_cache[verify_key] = verify_entry;
+    // El valor escrito no se guarda en cache: la escritura ya invalidó la tabla
+    // y la próxima lectura lo confirma desde el PAC
 }
 
 // CORRECCIÓN: Función debugWriteOperation mejorada SIN deadlock
@@ -0,0 +1,757 @@
+#define LOG_MODULE LogModule::PAC
+#include "pac_io_engine.h"
+#include "common.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+static const size_t RX_BUFFER_SIZE = 16384;
+static const uint64_t WAKE_TAG = 0;   // Los ids de conexión empiezan en 1: (id << 1) nunca es 0
+
+// epoll data: id de conexión y si el evento es del socket o del timerfd
+static uint64_t socketTag(PACIoEngine::ConnectionId id) { return id << 1; }
+static uint64_t timerTag(PACIoEngine::ConnectionId id) { return (id << 1) | 1; }
+
+struct PACIoEngine::Connection {
+    ConnectionId id = NO_CONNECTION;
+    int fd = -1;
+    int timer_fd = -1;
+    bool connecting = true;
+    bool broken = false;            // Error de socket: se cierra al terminar el evento en curso
+    bool desynced = false;          // Descartar el stream antes del próximo envío
+    uint32_t events = 0;            // Máscara registrada en epoll
+    string endpoint;                // "ip:puerto" (registro OPEN de la captura)
+
+    shared_ptr<promise<bool>> connect_done;
+    function<void()> on_closed;
+
+    deque<IoRequest> queued;        // Sin enviar
+    deque<IoRequest> in_flight;     // Enviadas, esperando respuesta (en orden)
+    chrono::steady_clock::time_point head_deadline;
+
+    string tx;                      // Comandos pendientes de escribir (conserva capacidad)
+    size_t tx_sent = 0;
+
+    vector<uint8_t> rx = vector<uint8_t>(RX_BUFFER_SIZE);
+    size_t rx_head = 0;             // Primer byte sin consumir
+    size_t rx_tail = 0;             // Fin de los datos válidos
+    size_t scanned = 0;             // DELIMITED: bytes ya revisados sin terminador
+};
+
+PACIoEngine::PACIoEngine()
+{
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || wake_fd < 0)
+    {
+        LOG_ERROR("❌ No se pudo crear el motor de E/S PAC: " << strerror(errno));
+        return;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = WAKE_TAG;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev);
+
+    accepting = true;
+    loop = thread(&PACIoEngine::run, this);
+}
+
+// Nunca corre en el hilo del motor: shared() lo garantiza con su deleter
+PACIoEngine::~PACIoEngine()
+{
+    // La parada es una tarea más: run() retorna tras ejecutarla (si el hilo ya terminó, post falla)
+    post([this] { stopping = true; });
+    if (loop.joinable())
+        loop.join();
+
+    if (wake_fd >= 0)
+        ::close(wake_fd);
+    if (epoll_fd >= 0)
+        ::close(epoll_fd);
+}
+
+shared_ptr<PACIoEngine> PACIoEngine::shared()
+{
+    // Vive mientras algún cliente lo use: sin problemas de orden de destrucción estática
+    static mutex instance_mutex;
+    static weak_ptr<PACIoEngine> instance;
+
+    lock_guard<mutex> lock(instance_mutex);
+    shared_ptr<PACIoEngine> engine = instance.lock();
+    if (!engine)
+    {
+        // El último dueño puede soltarlo desde un callback del propio hilo: entonces se destruye
+        // desde otro hilo, que espera a que run() retorne antes de liberar el objeto
+        engine = shared_ptr<PACIoEngine>(new PACIoEngine(), [](PACIoEngine *released) {
+            if (released->loop.get_id() == this_thread::get_id())
+                thread([released] { delete released; }).detach();
+            else
+                delete released;
+        });
+        instance = engine;
+    }
+    return engine;
+}
+
+bool PACIoEngine::post(function<void()> task)
+{
+    {
+        lock_guard<mutex> lock(posted_mutex);
+        if (!accepting)
+            return false;
+        posted.push_back(std::move(task));
+    }
+    uint64_t one = 1;
+    if (write(wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+    {
+        LOG_ERROR("❌ eventfd del motor de E/S: " << strerror(errno));
+    }
+    return true;
+}
+
+void PACIoEngine::runPosted()
+{
+    uint64_t count;
+    while (read(wake_fd, &count, sizeof(count)) > 0)
+    {
+    }
+
+    vector<function<void()>> tasks;
+    {
+        lock_guard<mutex> lock(posted_mutex);
+        tasks.swap(posted);
+    }
+    for (auto &task : tasks)
+        task();
+}
+
+void PACIoEngine::run()
+{
+    epoll_event events[64];
+
+    while (!stopping)
+    {
+        int ready = epoll_wait(epoll_fd, events, 64, -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            LOG_ERROR("❌ epoll_wait: " << strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < ready && !stopping; i++)
+        {
+            uint64_t tag = events[i].data.u64;
+            if (tag == WAKE_TAG)
+            {
+                runPosted();
+                continue;
+            }
+
+            // La conexión pudo cerrarse con un evento anterior del mismo lote
+            ConnectionId id = tag >> 1;
+            auto it = connections.find(id);
+            if (it == connections.end())
+                continue;
+
+            Connection &conn = *it->second;
+            if (tag & 1)
+                onTimer(conn);
+            else
+                onSocket(conn, events[i].events);
+
+            if (conn.broken)
+                drop(id, IoStatus::CLOSED, true);
+        }
+    }
+
+    // No aceptar más tareas; las que quedaron se ejecutan para resolver sus futures
+    vector<function<void()>> leftovers;
+    {
+        lock_guard<mutex> lock(posted_mutex);
+        accepting = false;
+        leftovers.swap(posted);
+    }
+    for (auto &task : leftovers)
+        task();
+
+    // Sin dueños no debería quedar ninguna conexión; cerrar por si acaso
+    while (!connections.empty())
+        drop(connections.begin()->first, IoStatus::CLOSED, false);
+}
+
+PACIoEngine::ConnectionId PACIoEngine::connect(const string &ip, int port, chrono::milliseconds timeout,
+                                               function<void()> on_closed)
+{
+    auto done = make_shared<promise<bool>>();
+    future<bool> connected = done->get_future();
+
+    ConnectionId id = next_id.fetch_add(1);
+    bool posted_ok = post([this, id, ip, port, timeout, on_closed = std::move(on_closed), done]() mutable {
+        startConnect(id, ip, port, timeout, std::move(on_closed), done);
+    });
+    if (!posted_ok)
+    {
+        LOG_ERROR("❌ Motor de E/S PAC detenido: no se puede conectar a " << ip << ":" << port);
+        return NO_CONNECTION;
+    }
+
+    return connected.get() ? id : NO_CONNECTION;
+}
+
+void PACIoEngine::startConnect(ConnectionId id, const string &ip, int port, chrono::milliseconds timeout,
+                               function<void()> on_closed, shared_ptr<promise<bool>> done)
+{
+    sockaddr_in server_addr{};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, ip.c_str(), &server_addr.sin_addr) <= 0)
+    {
+        LOG_ERROR("❌ Dirección IP inválida: " << ip);
+        done->set_value(false);
+        return;
+    }
+
+    auto conn = make_unique<Connection>();
+    conn->id = id;
+    conn->endpoint = ip + ":" + to_string(port);
+    conn->on_closed = std::move(on_closed);
+    conn->connect_done = done;
+    conn->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    conn->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (conn->fd < 0 || conn->timer_fd < 0)
+    {
+        LOG_ERROR("❌ Error creando socket: " << strerror(errno));
+        if (conn->fd >= 0)
+            ::close(conn->fd);
+        if (conn->timer_fd >= 0)
+            ::close(conn->timer_fd);
+        done->set_value(false);
+        return;
+    }
+
+    int result = ::connect(conn->fd, reinterpret_cast<sockaddr *>(&server_addr), sizeof(server_addr));
+    if (result < 0 && errno != EINPROGRESS)
+    {
+        LOG_DEBUG("❌ connect " << ip << ":" << port << ": " << strerror(errno));
+        ::close(conn->fd);
+        ::close(conn->timer_fd);
+        done->set_value(false);
+        return;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = timerTag(id);
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn->timer_fd, &ev);
+
+    // Conectando: EPOLLOUT avisa cuando termina (bien o mal)
+    conn->events = EPOLLIN | EPOLLOUT;
+    ev.events = conn->events;
+    ev.data.u64 = socketTag(id);
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn->fd, &ev);
+
+    Connection &ref = *conn;
+    connections.emplace(id, std::move(conn));
+    open_connections.fetch_add(1, memory_order_relaxed);
+
+    if (result == 0)
+        finishConnect(ref);
+    else
+        armTimer(ref, timeout);
+
+    if (ref.broken)
+        drop(id, IoStatus::CLOSED, false);
+}
+
+void PACIoEngine::finishConnect(Connection &conn)
+{
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (getsockopt(conn.fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0)
+    {
+        LOG_DEBUG("❌ Conexión PAC rechazada: " << strerror(error ? error : errno));
+        conn.broken = true;
+        return;
+    }
+
+    conn.connecting = false;
+    armTimer(conn, chrono::milliseconds(0));
+    updateEvents(conn, EPOLLIN);
+    capturePacket(conn, PacketRecordHeader::OPEN,
+                  span<const uint8_t>(reinterpret_cast<const uint8_t *>(conn.endpoint.data()), conn.endpoint.size()));
+
+    conn.connect_done->set_value(true);
+    conn.connect_done.reset();
+}
+
+void PACIoEngine::close(ConnectionId id)
+{
+    if (id == NO_CONNECTION)
+        return;
+
+    // Desde un callback no se puede esperar al propio hilo: cerrar después del evento en curso
+    if (this_thread::get_id() == loop.get_id())
+    {
+        post([this, id] { drop(id, IoStatus::CLOSED, false); });
+        return;
+    }
+
+    // Motor detenido: run() ya cerró todas sus conexiones
+    promise<void> done;
+    future<void> closed = done.get_future();
+    if (post([this, id, &done] {
+            drop(id, IoStatus::CLOSED, false);
+            done.set_value();
+        }))
+        closed.wait();
+}
+
+void PACIoEngine::drop(ConnectionId id, IoStatus status, bool notify)
+{
+    auto it = connections.find(id);
+    if (it == connections.end())
+        return;
+
+    unique_ptr<Connection> conn = std::move(it->second);
+    connections.erase(it);
+    open_connections.fetch_sub(1, memory_order_relaxed);
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, nullptr);
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->timer_fd, nullptr);
+    ::close(conn->fd);
+    ::close(conn->timer_fd);
+
+    if (conn->connect_done)
+    {
+        // Nunca llegó a conectarse: no hay nada que notificar
+        conn->connect_done->set_value(false);
+        return;
+    }
+
+    failPending(*conn, status);
+    capturePacket(*conn, PacketRecordHeader::CLOSE, {}, status);
+
+    if (notify && conn->on_closed)
+    {
+        DEBUG_INFO("🔌 Conexión PAC perdida");
+        conn->on_closed();
+    }
+}
+
+future<void> PACIoEngine::submit(ConnectionId id, vector<IoRequest> &&requests)
+{
+    auto done = make_shared<promise<void>>();
+    future<void> completed = done->get_future();
+
+    if (requests.empty())
+    {
+        done->set_value();
+        return completed;
+    }
+
+    // Las solicitudes se completan en orden: basta con esperar a la última
+    auto &last = requests.back().on_complete;
+    last = [inner = std::move(last), done](IoStatus status, span<const uint8_t> response) {
+        bool ok = inner ? inner(status, response) : true;
+        done->set_value();
+        return ok;
+    };
+
+    auto batch = make_shared<vector<IoRequest>>(std::move(requests));
+    if (!post([this, id, batch] { enqueue(id, *batch); }))
+    {
+        // Motor detenido (o que nunca arrancó): completar aquí en lugar de dejar el future colgado
+        for (auto &request : *batch)
+        {
+            if (request.on_complete)
+                request.on_complete(IoStatus::NOT_CONNECTED, {});
+        }
+    }
+    return completed;
+}
+
+void PACIoEngine::enqueue(ConnectionId id, vector<IoRequest> &requests)
+{
+    auto it = connections.find(id);
+    if (it == connections.end() || it->second->connecting)
+    {
+        for (auto &request : requests)
+        {
+            if (request.on_complete)
+                request.on_complete(IoStatus::NOT_CONNECTED, {});
+        }
+        return;
+    }
+
+    Connection &conn = *it->second;
+    for (auto &request : requests)
+        conn.queued.push_back(std::move(request));
+
+    pump(conn);
+    if (conn.broken)
+        drop(id, IoStatus::CLOSED, true);
+}
+
+void PACIoEngine::discardInput(ConnectionId id)
+{
+    post([this, id] {
+        auto it = connections.find(id);
+        if (it != connections.end())
+            it->second->desynced = true;
+    });
+}
+
+void PACIoEngine::onSocket(Connection &conn, uint32_t events)
+{
+    if (conn.connecting)
+    {
+        if (events & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+            finishConnect(conn);
+        return;
+    }
+
+    // Con EPOLLHUP puede quedar una respuesta por leer: onReadable detecta el cierre
+    if (events & (EPOLLIN | EPOLLHUP))
+        onReadable(conn);
+    if (!conn.broken && (events & EPOLLOUT))
+        flushTx(conn);
+    if (!conn.broken && (events & EPOLLERR))
+        conn.broken = true;
+}
+
+void PACIoEngine::onTimer(Connection &conn)
+{
+    uint64_t expirations;
+    if (read(conn.timer_fd, &expirations, sizeof(expirations)) < 0)
+        return;  // Ya rearmado por otra solicitud
+
+    if (conn.connecting)
+    {
+        LOG_DEBUG("⏰ TIMEOUT conectando al PAC");
+        conn.broken = true;
+        return;
+    }
+
+    if (conn.in_flight.empty())
+        return;
+
+    auto now = chrono::steady_clock::now();
+    if (now < conn.head_deadline)
+    {
+        armTimer(conn, chrono::duration_cast<chrono::milliseconds>(conn.head_deadline - now) + chrono::milliseconds(1));
+        return;
+    }
+
+    // Sin trama completa no se sabe dónde empieza la siguiente: abortar lo pendiente
+    LOG_DEBUG("⏰ TIMEOUT esperando datos del PAC (" << conn.in_flight.size() + conn.queued.size() << " solicitudes abortadas)");
+    conn.desynced = true;
+    failPending(conn, IoStatus::TIMEOUT);
+}
+
+void PACIoEngine::onReadable(Connection &conn)
+{
+    while (!conn.broken)
+    {
+        if (conn.rx_head == conn.rx_tail)
+        {
+            conn.rx_head = 0;
+            conn.rx_tail = 0;
+        }
+
+        // Espacio al final: compactar, y crecer sólo si una trama fija no cabe en el buffer
+        if (conn.rx_tail == conn.rx.size() && conn.rx_head > 0)
+        {
+            size_t pending = conn.rx_tail - conn.rx_head;
+            memmove(conn.rx.data(), conn.rx.data() + conn.rx_head, pending);
+            conn.rx_head = 0;
+            conn.rx_tail = pending;
+        }
+        if (conn.rx_tail == conn.rx.size())
+        {
+            size_t needed = conn.rx.size() * 2;
+            if (!conn.in_flight.empty() && conn.in_flight.front().frame.kind == IoFrame::FIXED)
+                needed = max(needed, conn.in_flight.front().frame.bytes);
+            conn.rx.resize(needed);
+        }
+
+        ssize_t received = recv(conn.fd, conn.rx.data() + conn.rx_tail, conn.rx.size() - conn.rx_tail, MSG_DONTWAIT);
+        if (received > 0)
+        {
+            conn.rx_tail += received;
+            deliver(conn);
+            continue;
+        }
+
+        if (received == 0)
+        {
+            DEBUG_INFO("❌ Conexión cerrada por el servidor");
+            conn.broken = true;
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            DEBUG_INFO("❌ Error recv: " << strerror(errno));
+            conn.broken = true;
+        }
+        return;
+    }
+}
+
+// Enmarcar y completar las respuestas disponibles, en orden de envío
+void PACIoEngine::deliver(Connection &conn)
+{
+    while (!conn.in_flight.empty())
+    {
+        const IoFrame &frame = conn.in_flight.front().frame;
+        const uint8_t *start = conn.rx.data() + conn.rx_head;
+        size_t available = conn.rx_tail - conn.rx_head;
+        size_t length = 0;
+        size_t consumed = 0;
+
+        if (frame.kind == IoFrame::FIXED)
+        {
+            if (available < frame.bytes)
+                break;
+            length = consumed = frame.bytes;
+        }
+        else if (frame.kind == IoFrame::DELIMITED)
+        {
+            const void *found = memchr(start + conn.scanned, frame.delimiter, available - conn.scanned);
+            if (!found)
+            {
+                conn.scanned = available;
+                if (available <= frame.bytes)
+                    break;
+
+                LOG_DEBUG("⚠️ Respuesta sin terminador mayor de " << frame.bytes << " bytes");
+                conn.desynced = true;
+                failPending(conn, IoStatus::DESYNCED);
+                return;
+            }
+            length = static_cast<const uint8_t *>(found) - start;
+            consumed = length + 1;  // También el terminador
+        }
+        else if (frame.kind == IoFrame::ANY)
+        {
+            if (available == 0)
+                break;
+            length = consumed = available;
+        }
+
+        IoRequest request = std::move(conn.in_flight.front());
+        conn.in_flight.pop_front();
+        conn.scanned = 0;
+        conn.rx_head += consumed;
+        capturePacket(conn, PacketRecordHeader::RX, span<const uint8_t>(start, length));
+
+        // La respuesta sigue en rx: no se recibe nada más hasta que vuelva el callback
+        bool valid = request.on_complete ? request.on_complete(IoStatus::OK, span<const uint8_t>(start, length)) : true;
+        if (!valid)
+        {
+            conn.desynced = true;
+            failPending(conn, IoStatus::DESYNCED);
+            return;
+        }
+        if (request.desync_after)
+            conn.desynced = true;
+
+        armHead(conn);
+    }
+
+    // Nada en vuelo: lo que quede no pertenece a ninguna solicitud
+    if (conn.in_flight.empty())
+    {
+        conn.rx_head = 0;
+        conn.rx_tail = 0;
+    }
+
+    pump(conn);
+}
+
+// Pasar solicitudes de la cola al socket respetando la ventana y las barreras de resincronización
+void PACIoEngine::pump(Connection &conn)
+{
+    if (conn.broken)
+        return;
+
+    if (conn.in_flight.empty() && conn.desynced)
+        drainInput(conn);
+
+    bool was_idle = conn.in_flight.empty();
+    while (!conn.queued.empty() && !conn.broken)
+    {
+        const IoRequest &next = conn.queued.front();
+        if (!conn.in_flight.empty())
+        {
+            if (conn.desynced || conn.in_flight.back().desync_after || next.desync_after)
+                break;
+            if (next.max_in_flight > 0 && conn.in_flight.size() >= next.max_in_flight)
+                break;
+        }
+
+        conn.tx += next.tx;
+        capturePacket(conn, PacketRecordHeader::TX,
+                      span<const uint8_t>(reinterpret_cast<const uint8_t *>(next.tx.data()), next.tx.size()));
+        conn.in_flight.push_back(std::move(conn.queued.front()));
+        conn.queued.pop_front();
+    }
+
+    if (was_idle && !conn.in_flight.empty())
+        armHead(conn);
+
+    flushTx(conn);
+
+    // Comandos sin respuesta en cabeza: completarlos ya escritos (o en el buffer de envío)
+    if (!conn.broken && !conn.in_flight.empty() && conn.in_flight.front().frame.kind == IoFrame::NONE)
+        deliver(conn);
+}
+
+void PACIoEngine::flushTx(Connection &conn)
+{
+    while (conn.tx_sent < conn.tx.size())
+    {
+        ssize_t sent = send(conn.fd, conn.tx.data() + conn.tx_sent, conn.tx.size() - conn.tx_sent,
+                            MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent > 0)
+        {
+            conn.tx_sent += sent;
+            continue;
+        }
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            // Socket lleno: seguir cuando epoll avise
+            updateEvents(conn, EPOLLIN | EPOLLOUT);
+            return;
+        }
+
+        DEBUG_INFO("❌ Error enviando al PAC: " << strerror(errno));
+        conn.broken = true;
+        return;
+    }
+
+    conn.tx.clear();
+    conn.tx_sent = 0;
+    updateEvents(conn, EPOLLIN);
+}
+
+// Descartar bytes residuales (en el buffer y en el kernel) tras un timeout o trama inválida
+void PACIoEngine::drainInput(Connection &conn)
+{
+    size_t flushed = conn.rx_tail - conn.rx_head;
+    if (flushed > 0)
+        capturePacket(conn, PacketRecordHeader::DISCARD, span<const uint8_t>(conn.rx.data() + conn.rx_head, flushed));
+    conn.rx_head = 0;
+    conn.rx_tail = 0;
+    conn.scanned = 0;
+
+    while (true)
+    {
+        ssize_t received = recv(conn.fd, conn.rx.data(), conn.rx.size(), MSG_DONTWAIT);
+        if (received > 0)
+        {
+            capturePacket(conn, PacketRecordHeader::DISCARD, span<const uint8_t>(conn.rx.data(), (size_t)received));
+            flushed += received;
+            continue;
+        }
+        if (received == 0)
+            conn.broken = true;
+        break;
+    }
+
+    conn.desynced = false;
+    if (flushed > 0)
+    {
+        LOG_DEBUG("🧹 BUFFER LIMPIADO: Eliminados " << flushed << " bytes residuales del socket");
+    }
+}
+
+// Completar en orden todo lo pendiente (en vuelo y en cola) con status
+void PACIoEngine::failPending(Connection &conn, IoStatus status)
+{
+    deque<IoRequest> failed = std::move(conn.in_flight);
+    for (auto &request : conn.queued)
+        failed.push_back(std::move(request));
+    conn.in_flight.clear();
+    conn.queued.clear();
+
+    // Lo que no llegó a escribirse ya no tiene respuesta que esperar
+    if (conn.tx_sent == 0 || conn.tx_sent == conn.tx.size())
+    {
+        conn.tx.clear();
+        conn.tx_sent = 0;
+    }
+    conn.scanned = 0;
+    armTimer(conn, chrono::milliseconds(0));
+    if (!failed.empty())
+        capturePacket(conn, PacketRecordHeader::FAIL, {}, status, (uint32_t)failed.size());
+
+    for (auto &request : failed)
+    {
+        if (request.on_complete)
+            request.on_complete(status, {});
+    }
+}
+
+void PACIoEngine::armHead(Connection &conn)
+{
+    if (conn.in_flight.empty())
+    {
+        armTimer(conn, chrono::milliseconds(0));
+        return;
+    }
+
+    chrono::milliseconds timeout = conn.in_flight.front().timeout;
+    conn.head_deadline = chrono::steady_clock::now() + timeout;
+    armTimer(conn, timeout);
+}
+
+// Timeout relativo (0 = desarmar)
+void PACIoEngine::armTimer(Connection &conn, chrono::milliseconds timeout)
+{
+    itimerspec spec{};
+    if (timeout.count() > 0)
+    {
+        spec.it_value.tv_sec = timeout.count() / 1000;
+        spec.it_value.tv_nsec = (timeout.count() % 1000) * 1000000;
+    }
+    timerfd_settime(conn.timer_fd, 0, &spec, nullptr);
+}
+
+void PACIoEngine::updateEvents(Connection &conn, uint32_t events)
+{
+    if (conn.events == events)
+        return;
+
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.u64 = socketTag(conn.id);
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn.fd, &ev);
+    conn.events = events;
+}
+
+void PACIoEngine::setCapture(shared_ptr<PacketCapture> capture)
+{
+    post([this, capture = std::move(capture)]() mutable { packet_capture = std::move(capture); });
+}
+
+void PACIoEngine::capturePacket(const Connection &conn, PacketRecordHeader::Kind kind, span<const uint8_t> frame,
+                                IoStatus status, uint32_t count)
+{
+    if (packet_capture)
+        packet_capture->record(kind, conn.id, frame, static_cast<uint8_t>(status), count);
+}
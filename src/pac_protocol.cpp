@@ -0,0 +1,371 @@
+#include "pac_protocol.h"
+#include <cstring>
+#include <cstdio>
+#include <cctype>
+#include <cmath>
+#include <climits>
+#include <stdexcept>
+#include <algorithm>
+#include <charconv>
+#include <bit>
+#include <array>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace pac_protocol {
+
+std::string buildTableReadCommand(const std::string& table_name, int start_pos, int end_pos)
+{
+    std::string command;
+    command.reserve(table_name.size() + 32);
+    appendTableReadCommand(command, table_name, start_pos, end_pos);
+    return command;
+}
+
+void appendTableReadCommand(std::string& out, const std::string& table_name, int start_pos, int end_pos)
+{
+    // Ejemplo: "9 0 }TBL_TT_11006 TRange.\r"
+    char number[16];
+    auto res = std::to_chars(number, number + sizeof(number), end_pos);
+    out.append(number, res.ptr);
+    out += ' ';
+    res = std::to_chars(number, number + sizeof(number), start_pos);
+    out.append(number, res.ptr);
+    out += " }";
+    out += table_name;
+    out += " TRange.\r";
+}
+
+std::string buildTableWriteCommand(const std::string& table_name, int index, float value)
+{
+    // Ejemplo: "25.500 3 }TBL_TT_11001 TABLE!\r" (snprintf: sin stringstream por elemento)
+    char number[64];
+    int len = snprintf(number, sizeof(number), "%.3f %d }", value, index);
+
+    std::string command;
+    command.reserve(len + table_name.size() + 8);
+    command.append(number, len);
+    command += table_name;
+    command += " TABLE!\r";
+    return command;
+}
+
+std::string buildTableWriteCommand(const std::string& table_name, int index, int32_t value)
+{
+    return std::to_string(value) + " " + std::to_string(index) + " }" + table_name + " TABLE!\r";
+}
+
+std::string buildScalarWriteCommand(const std::string& variable_name, float value)
+{
+    // Ejemplo: "12.5 ^F_Corrent_Vol_Batch @!\r" (%.7g = 7 cifras significativas)
+    char number[48];
+    int len = snprintf(number, sizeof(number), "%.7g ^", value);
+
+    std::string command;
+    command.reserve(len + variable_name.size() + 4);
+    command.append(number, len);
+    command += variable_name;
+    command += " @!\r";
+    return command;
+}
+
+std::string buildScalarWriteCommand(const std::string& variable_name, int32_t value)
+{
+    return std::to_string(value) + " ^" + variable_name + " @!\r";
+}
+
+size_t tableResponseBytes(int start_pos, int end_pos)
+{
+    if (end_pos < start_pos) {
+        return 0;
+    }
+    return static_cast<size_t>(end_pos - start_pos + 1) * TABLE_ELEMENT_BYTES;
+}
+
+static inline uint32_t loadLE32(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// En hosts little endian la trama ya tiene el formato nativo: convertir = copiar
+static constexpr bool HOST_IS_LE = std::endian::native == std::endian::little;
+
+// Exponente todo en 1 = Inf/NaN
+static constexpr uint32_t FLOAT_EXP_MASK = 0x7F800000u;
+
+// ============== KERNELS DE DECODIFICACIÓN MASIVA ==============
+
+static FloatDecodeResult decodeFloatsScalar(const uint8_t* src, float* dst, uint8_t* flags, size_t count)
+{
+    FloatDecodeResult result{count, 0};
+    for (size_t i = 0; i < count; i++) {
+        uint32_t raw_bits = loadLE32(src + i * TABLE_ELEMENT_BYTES);
+        memcpy(&dst[i], &raw_bits, 4);
+        bool non_finite = (raw_bits & FLOAT_EXP_MASK) == FLOAT_EXP_MASK;
+        result.non_finite += non_finite;
+        if (flags)
+            flags[i] = non_finite;
+    }
+    return result;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// x86 siempre es little endian: carga sin alinear, máscara de exponente y movemask por bloque
+// Máscara de movemask (1 bit por lane) → 1 byte por lane, vía tabla de 256 entradas
+static constexpr auto FLAG_SPREAD = [] {
+    std::array<uint64_t, 256> table{};
+    for (unsigned mask = 0; mask < 256; mask++)
+        for (unsigned lane = 0; lane < 8; lane++)
+            if (mask & (1u << lane))
+                table[mask] |= 1ull << (8 * lane);
+    return table;
+}();
+
+static inline void storeFlags(uint8_t* flags, unsigned mask, size_t lanes)
+{
+    memcpy(flags, &FLAG_SPREAD[mask], lanes);
+}
+
+__attribute__((target("sse2")))
+static FloatDecodeResult decodeFloatsSSE2(const uint8_t* src, float* dst, uint8_t* flags, size_t count)
+{
+    const __m128i exp_mask = _mm_set1_epi32(static_cast<int>(FLOAT_EXP_MASK));
+    __m128i special_count = _mm_setzero_si128();   // cmpeq da -1 por lane: restar acumula
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * TABLE_ELEMENT_BYTES));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), raw);
+        __m128i special = _mm_cmpeq_epi32(_mm_and_si128(raw, exp_mask), exp_mask);
+        special_count = _mm_sub_epi32(special_count, special);
+        if (flags)
+            storeFlags(flags + i, static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(special))), 4);
+    }
+
+    uint32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), special_count);
+    size_t non_finite = size_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+
+    FloatDecodeResult tail = decodeFloatsScalar(src + i * TABLE_ELEMENT_BYTES, dst + i, flags ? flags + i : nullptr, count - i);
+    return {count, non_finite + tail.non_finite};
+}
+
+__attribute__((target("avx2")))
+static FloatDecodeResult decodeFloatsAVX2(const uint8_t* src, float* dst, uint8_t* flags, size_t count)
+{
+    const __m256i exp_mask = _mm256_set1_epi32(static_cast<int>(FLOAT_EXP_MASK));
+    __m256i special_count = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * TABLE_ELEMENT_BYTES));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), raw);
+        __m256i special = _mm256_cmpeq_epi32(_mm256_and_si256(raw, exp_mask), exp_mask);
+        special_count = _mm256_sub_epi32(special_count, special);
+        if (flags)
+            storeFlags(flags + i, static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(special))), 8);
+    }
+
+    uint32_t lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), special_count);
+    size_t non_finite = 0;
+    for (uint32_t lane : lanes)
+        non_finite += lane;
+
+    FloatDecodeResult tail = decodeFloatsScalar(src + i * TABLE_ELEMENT_BYTES, dst + i, flags ? flags + i : nullptr, count - i);
+    return {count, non_finite + tail.non_finite};
+}
+#endif
+
+static DecodeKernel detectDecodeKernel()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return DecodeKernel::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return DecodeKernel::SSE2;
+#endif
+    return DecodeKernel::SCALAR;
+}
+
+DecodeKernel activeDecodeKernel()
+{
+    static const DecodeKernel kernel = detectDecodeKernel();
+    return kernel;
+}
+
+const char* decodeKernelName(DecodeKernel kernel)
+{
+    switch (kernel) {
+    case DecodeKernel::AVX2: return "avx2";
+    case DecodeKernel::SSE2: return "sse2";
+    default: return "scalar";
+    }
+}
+
+FloatDecodeResult decodeFloatsChecked(std::span<const uint8_t> data, std::span<float> out,
+                                      std::span<uint8_t> non_finite_flags, DecodeKernel kernel)
+{
+    size_t count = std::min(data.size() / TABLE_ELEMENT_BYTES, out.size());
+    uint8_t* flags = nullptr;
+    if (!non_finite_flags.empty()) {
+        count = std::min(count, non_finite_flags.size());
+        flags = non_finite_flags.data();
+    }
+
+    // Un kernel no soportado por la CPU nunca se ejecuta: se degrada al detectado
+    if (kernel > activeDecodeKernel())
+        kernel = activeDecodeKernel();
+
+    switch (kernel) {
+#if defined(__x86_64__) || defined(__i386__)
+    case DecodeKernel::AVX2: return decodeFloatsAVX2(data.data(), out.data(), flags, count);
+    case DecodeKernel::SSE2: return decodeFloatsSSE2(data.data(), out.data(), flags, count);
+#endif
+    default: return decodeFloatsScalar(data.data(), out.data(), flags, count);
+    }
+}
+
+size_t decodeFloatsLE(std::span<const uint8_t> data, std::span<float> out)
+{
+    size_t count = std::min(data.size() / TABLE_ELEMENT_BYTES, out.size());
+    if constexpr (HOST_IS_LE) {
+        if (count > 0)
+            memcpy(out.data(), data.data(), count * TABLE_ELEMENT_BYTES);
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            uint32_t raw_bits = loadLE32(data.data() + i * TABLE_ELEMENT_BYTES);
+            memcpy(&out[i], &raw_bits, 4);
+        }
+    }
+    return count;
+}
+
+size_t decodeInt32sLE(std::span<const uint8_t> data, std::span<int32_t> out)
+{
+    size_t count = std::min(data.size() / TABLE_ELEMENT_BYTES, out.size());
+    if constexpr (HOST_IS_LE) {
+        if (count > 0)
+            memcpy(out.data(), data.data(), count * TABLE_ELEMENT_BYTES);
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            uint32_t raw_bits = loadLE32(data.data() + i * TABLE_ELEMENT_BYTES);
+            memcpy(&out[i], &raw_bits, 4);
+        }
+    }
+    return count;
+}
+
+std::vector<float> decodeFloatsLE(const std::vector<uint8_t>& data)
+{
+    std::vector<float> floats(data.size() / TABLE_ELEMENT_BYTES);
+    decodeFloatsLE(std::span<const uint8_t>(data), std::span<float>(floats));
+    return floats;
+}
+
+std::vector<int32_t> decodeInt32sLE(const std::vector<uint8_t>& data)
+{
+    std::vector<int32_t> ints(data.size() / TABLE_ELEMENT_BYTES);
+    decodeInt32sLE(std::span<const uint8_t>(data), std::span<int32_t>(ints));
+    return ints;
+}
+
+std::string bytesToASCII(const std::vector<uint8_t>& bytes)
+{
+    std::string result;
+    result.reserve(bytes.size());
+    for (uint8_t byte : bytes) {
+        if (byte >= 32 && byte <= 126) { // Solo caracteres ASCII imprimibles
+            result += static_cast<char>(byte);
+        }
+    }
+    return result;
+}
+
+std::string cleanASCIINumber(const std::string& ascii_str)
+{
+    std::string result;
+    bool decimal_found = false;
+    bool negative_found = false;
+    bool exponent_found = false;
+    bool exponent_sign_found = false;
+
+    // Procesar cada caracter para extraer un número válido
+    for (char c : ascii_str) {
+        // Ignorar bytes nulos y caracteres de control
+        if (c == '\0' || c == '\r' || c == '\n' || c == '\t') {
+            continue;
+        }
+
+        // Dígitos siempre son válidos
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            result += c;
+        }
+        // Signo negativo solo al principio
+        else if (c == '-' && !negative_found && result.empty()) {
+            result += c;
+            negative_found = true;
+        }
+        // Punto decimal solo una vez
+        else if (c == '.' && !decimal_found && !exponent_found) {
+            result += c;
+            decimal_found = true;
+        }
+        // Notación científica (e/E)
+        else if ((c == 'e' || c == 'E') && !exponent_found && !result.empty()) {
+            result += c;
+            exponent_found = true;
+        }
+        // Signo en exponente
+        else if ((c == '+' || c == '-') && exponent_found && !exponent_sign_found &&
+                 (result.back() == 'e' || result.back() == 'E')) {
+            result += c;
+            exponent_sign_found = true;
+        }
+        // Espacios al final terminan el número
+        else if (c == ' ' && !result.empty()) {
+            break;
+        }
+        // Otros caracteres no válidos se ignoran
+    }
+
+    // Validar que el resultado es un número válido
+    if (result.empty() || result == "-" || result == "." || result == "e" || result == "E") {
+        return "0";
+    }
+    return result;
+}
+
+float parseFloat(const std::string& str)
+{
+    if (str.empty()) {
+        return 0.0f;
+    }
+    try {
+        float value = std::stof(str);
+        if (std::isnan(value) || std::isinf(value)) {
+            return 0.0f;
+        }
+        return value;
+    } catch (const std::exception&) {
+        return 0.0f;
+    }
+}
+
+int32_t parseInt32(const std::string& str)
+{
+    if (str.empty()) {
+        return 0;
+    }
+    try {
+        double double_value = std::stod(str);
+        if (double_value > INT32_MAX || double_value < INT32_MIN) {
+            return 0;
+        }
+        return static_cast<int32_t>(double_value);
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+} // namespace pac_protocol
@@ -0,0 +1,536 @@
+#define LOG_MODULE LogModule::PAC
+#include "pac_simulator.h"
+#include "common.h"
+#include "pac_protocol.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <sstream>
+#include <chrono>
+
+using namespace std;
+
+// Tablas de alarmas (INT32): TBL_DA_, TBL_PA_, TBL_LA_, TBL_TA_
+static bool isAlarmTableName(const string &name)
+{
+    return name.find("TBL_DA_") == 0 || name.find("TBL_PA_") == 0 ||
+           name.find("TBL_LA_") == 0 || name.find("TBL_TA_") == 0;
+}
+
+static uint32_t floatBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bitsFloat(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+PACSimulator::PACSimulator(const PACSimulatorOptions &options)
+    : opts(options), churn_rng(options.seed)
+{
+}
+
+PACSimulator::~PACSimulator()
+{
+    stop();
+}
+
+uint32_t PACSimulator::initialFloatBits(const string &name, size_t index) const
+{
+    // Valor estable y reproducible por (tabla, índice): 0..100 con dos decimales
+    size_t h = hash<string>()(name) ^ (index * 2654435761u) ^ opts.seed;
+    return floatBits((float)(h % 10000) / 100.0f);
+}
+
+void PACSimulator::addTable(const string &name, size_t size, bool is_int32)
+{
+    lock_guard<mutex> lock(data_mutex);
+
+    auto it = tables.find(name);
+    if (it == tables.end())
+    {
+        it = tables.emplace(name, SimTable()).first;
+        it->second.is_int32 = is_int32;
+        table_names.push_back(name);
+    }
+
+    SimTable &table = it->second;
+    while (table.bits.size() < size)
+    {
+        size_t i = table.bits.size();
+        table.bits.push_back(table.is_int32 ? 0u : initialFloatBits(name, i));
+    }
+}
+
+void PACSimulator::addScalar(const string &name, bool is_int32)
+{
+    lock_guard<mutex> lock(data_mutex);
+    if (scalars.count(name))
+        return;
+
+    SimScalar scalar;
+    scalar.is_int32 = is_int32;
+    scalar.bits = is_int32 ? 0u : initialFloatBits(name, 0);
+    scalars[name] = scalar;
+}
+
+size_t PACSimulator::loadTags(const nlohmann::json &tags)
+{
+    size_t before = tableCount() + scalarCount();
+    const size_t size = opts.default_table_size;
+
+    // Tablas de valores (y de alarmas en tbL_tags)
+    for (const char *section : {"tbL_tags", "tbl_api", "tbl_batch", "tbl_pid"})
+    {
+        if (!tags.contains(section))
+            continue;
+
+        for (const auto &tag : tags[section])
+        {
+            string value_table = tag.value("value_table", "");
+            string alarm_table = tag.value("alarm_table", "");
+            size_t vars = tag.contains("variables") ? tag["variables"].size() : 0;
+
+            if (!value_table.empty())
+                addTable(value_table, max(size, vars), isAlarmTableName(value_table));
+            if (!alarm_table.empty())
+                addTable(alarm_table, size, true);
+        }
+    }
+
+    // Variables individuales (F_xxx / I_xxx)
+    if (tags.contains("simple_variables"))
+    {
+        for (const auto &var : tags["simple_variables"])
+        {
+            string name = var.value("pac_source", var.value("name", ""));
+            if (name.empty())
+                continue;
+            string type = var.value("type", "");
+            addScalar(name, type == "INT32" || (type.empty() && name.find("I_") == 0));
+        }
+    }
+
+    return tableCount() + scalarCount() - before;
+}
+
+size_t PACSimulator::tableCount()
+{
+    lock_guard<mutex> lock(data_mutex);
+    return tables.size();
+}
+
+size_t PACSimulator::scalarCount()
+{
+    lock_guard<mutex> lock(data_mutex);
+    return scalars.size();
+}
+
+bool PACSimulator::getTableBits(const string &name, size_t index, uint32_t &bits)
+{
+    lock_guard<mutex> lock(data_mutex);
+    auto it = tables.find(name);
+    if (it == tables.end() || index >= it->second.bits.size())
+        return false;
+    bits = it->second.bits[index];
+    return true;
+}
+
+bool PACSimulator::getScalarBits(const string &name, uint32_t &bits)
+{
+    lock_guard<mutex> lock(data_mutex);
+    auto it = scalars.find(name);
+    if (it == scalars.end())
+        return false;
+    bits = it->second.bits;
+    return true;
+}
+
+// ============== SERVIDOR TCP ==============
+
+bool PACSimulator::start()
+{
+    if (running)
+        return true;
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+    {
+        LOG_ERROR("Simulador: no se pudo crear el socket");
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(opts.port);
+    if (inet_pton(AF_INET, opts.bind_address.c_str(), &addr.sin_addr) <= 0)
+    {
+        LOG_ERROR("Simulador: dirección inválida " << opts.bind_address);
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+
+    if (::bind(listen_fd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listen_fd, 16) < 0)
+    {
+        LOG_ERROR("Simulador: no se pudo escuchar en " << opts.bind_address << ":" << opts.port << " - " << strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+
+    socklen_t len = sizeof(addr);
+    getsockname(listen_fd, (sockaddr *)&addr, &len);
+    bound_port = ntohs(addr.sin_port);
+
+    running = true;
+    accept_thread = thread(&PACSimulator::acceptLoop, this);
+    if (opts.churn > 0.0)
+        churn_thread = thread(&PACSimulator::churnLoop, this);
+
+    LOG_INFO("🧪 Simulador PAC escuchando en " << opts.bind_address << ":" << bound_port
+             << " (" << tableCount() << " tablas, " << scalarCount() << " variables)");
+    return true;
+}
+
+void PACSimulator::stop()
+{
+    if (!running.exchange(false))
+        return;
+
+    if (accept_thread.joinable())
+        accept_thread.join();
+    if (churn_thread.joinable())
+        churn_thread.join();
+
+    {
+        lock_guard<mutex> lock(clients_mutex);
+        for (int fd : client_fds)
+            shutdown(fd, SHUT_RDWR);
+    }
+    for (auto &t : client_threads)
+    {
+        if (t.joinable())
+            t.join();
+    }
+    client_threads.clear();
+    client_fds.clear();
+
+    close(listen_fd);
+    listen_fd = -1;
+}
+
+void PACSimulator::acceptLoop()
+{
+    while (running)
+    {
+        pollfd pfd{listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0)
+            continue;
+
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0)
+            continue;
+
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        stats.connections++;
+        lock_guard<mutex> lock(clients_mutex);
+        client_fds.push_back(fd);
+        client_threads.emplace_back(&PACSimulator::clientLoop, this, fd);
+    }
+}
+
+void PACSimulator::clientLoop(int fd)
+{
+    mt19937 rng(opts.seed ^ (unsigned)fd);
+    string pending;
+    char buffer[8192];
+
+    while (running)
+    {
+        pollfd pfd{fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, 100);
+        if (ready == 0)
+            continue;
+        if (ready < 0)
+            break;
+
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0)
+            break;
+        pending.append(buffer, n);
+
+        // Retardo de red: una vez por ráfaga recibida
+        sleepJittered(opts.latency_us, rng);
+
+        size_t pos;
+        while ((pos = pending.find('\r')) != string::npos)
+        {
+            string command = pending.substr(0, pos);
+            pending.erase(0, pos + 1);
+
+            string reply;
+            if (!handleCommand(command, reply))
+            {
+                stats.unknown_commands++;
+                LOG_DEBUG("🧪 Comando no reconocido: '" << command << "'");
+                continue;
+            }
+
+            sleepJittered(opts.service_us, rng);
+            if (!sendReply(fd, reply))
+            {
+                pending.clear();
+                break;
+            }
+        }
+    }
+
+    close(fd);
+}
+
+void PACSimulator::sleepJittered(int base_us, mt19937 &rng)
+{
+    if (base_us <= 0 && opts.jitter_us <= 0)
+        return;
+
+    int delay = base_us;
+    if (opts.jitter_us > 0)
+    {
+        uniform_int_distribution<int> jitter(-opts.jitter_us, opts.jitter_us);
+        delay += jitter(rng);
+    }
+    if (delay > 0)
+        this_thread::sleep_for(chrono::microseconds(delay));
+}
+
+bool PACSimulator::sendReply(int fd, const string &reply)
+{
+    size_t chunk = opts.fragment_bytes > 0 ? opts.fragment_bytes : reply.size();
+    size_t offset = 0;
+
+    while (offset < reply.size())
+    {
+        size_t len = min(chunk, reply.size() - offset);
+        ssize_t sent = send(fd, reply.data() + offset, len, MSG_NOSIGNAL);
+        if (sent <= 0)
+            return false;
+        offset += sent;
+        stats.bytes_sent += sent;
+
+        if (opts.fragment_bytes > 0 && opts.fragment_delay_us > 0 && offset < reply.size())
+            this_thread::sleep_for(chrono::microseconds(opts.fragment_delay_us));
+    }
+    return true;
+}
+
+// ============== PROTOCOLO ==============
+
+PACSimulator::SimTable &PACSimulator::tableFor(const string &name, bool is_int32_hint)
+{
+    auto it = tables.find(name);
+    if (it == tables.end())
+    {
+        // Tabla desconocida: crearla bajo demanda (permite tags sintéticos sin tags.json)
+        it = tables.emplace(name, SimTable()).first;
+        it->second.is_int32 = is_int32_hint;
+        table_names.push_back(name);
+    }
+    return it->second;
+}
+
+bool PACSimulator::handleCommand(const string &command, string &reply)
+{
+    istringstream in(command);
+    vector<string> tokens;
+    string token;
+    while (in >> token)
+        tokens.push_back(token);
+
+    if (tokens.empty())
+        return false;
+
+    const string &verb = tokens.back();
+    static const char header[2] = {0, 0};
+
+    // "<end> <start> }TABLA TRange."
+    if (verb == "TRange." && tokens.size() == 4 && tokens[2].size() > 1 && tokens[2][0] == '}')
+    {
+        int end_pos = atoi(tokens[0].c_str());
+        int start_pos = atoi(tokens[1].c_str());
+        string name = tokens[2].substr(1);
+        if (start_pos < 0 || end_pos < start_pos)
+            return false;
+
+        lock_guard<mutex> lock(data_mutex);
+        SimTable &table = tableFor(name, isAlarmTableName(name));
+        while (table.bits.size() <= (size_t)end_pos)
+        {
+            size_t i = table.bits.size();
+            table.bits.push_back(table.is_int32 ? 0u : initialFloatBits(name, i));
+        }
+
+        int stamp = opts.timestamp_index;
+        if (!table.is_int32 && stamp >= start_pos && stamp <= end_pos)
+        {
+            // Marca de muestreo en ms (CLOCK_MONOTONIC: comparable entre procesos)
+            table.bits[stamp] = floatBits(chrono::duration<float, milli>(
+                chrono::steady_clock::now() - opts.timestamp_epoch).count());
+        }
+
+        reply.assign(header, 2);
+        reply.reserve(2 + pac_protocol::tableResponseBytes(start_pos, end_pos));
+        for (int i = start_pos; i <= end_pos; i++)
+        {
+            uint32_t bits = table.bits[i];
+            char le[4] = {(char)(bits & 0xFF), (char)((bits >> 8) & 0xFF),
+                          (char)((bits >> 16) & 0xFF), (char)((bits >> 24) & 0xFF)};
+            reply.append(le, 4);
+        }
+        stats.table_reads++;
+        return true;
+    }
+
+    // "^VAR @@ F." (float) / "^VAR @@ ." (int32)
+    if ((verb == "F." || verb == ".") && tokens.size() >= 2 && tokens[0].size() > 1 && tokens[0][0] == '^')
+    {
+        string name = tokens[0].substr(1);
+        bool want_int = (verb == ".");
+
+        lock_guard<mutex> lock(data_mutex);
+        auto it = scalars.find(name);
+        if (it == scalars.end())
+        {
+            SimScalar scalar;
+            scalar.is_int32 = want_int;
+            scalar.bits = want_int ? 0u : initialFloatBits(name, 0);
+            it = scalars.emplace(name, scalar).first;
+        }
+
+        char text[48];
+        if (want_int)
+        {
+            int32_t value = it->second.is_int32 ? (int32_t)it->second.bits : (int32_t)bitsFloat(it->second.bits);
+            snprintf(text, sizeof(text), "%d ", value);
+        }
+        else
+        {
+            float value = it->second.is_int32 ? (float)(int32_t)it->second.bits : bitsFloat(it->second.bits);
+            snprintf(text, sizeof(text), "%.7g ", value);
+        }
+        reply = text;
+        stats.scalar_reads++;
+        return true;
+    }
+
+    // "<valor> ^VAR @!"
+    if (verb == "@!" && tokens.size() == 3 && tokens[1].size() > 1 && tokens[1][0] == '^')
+    {
+        string name = tokens[1].substr(1);
+
+        lock_guard<mutex> lock(data_mutex);
+        SimScalar &scalar = scalars[name];
+        scalar.bits = scalar.is_int32 ? (uint32_t)(int32_t)strtol(tokens[0].c_str(), nullptr, 10)
+                                      : floatBits(strtof(tokens[0].c_str(), nullptr));
+        reply.assign(header, 2);
+        stats.writes++;
+        return true;
+    }
+
+    // "<valor> <índice> }TABLA TABLE!"
+    if (verb == "TABLE!" && tokens.size() == 4 && tokens[2].size() > 1 && tokens[2][0] == '}')
+    {
+        int index = atoi(tokens[1].c_str());
+        string name = tokens[2].substr(1);
+        if (index < 0)
+            return false;
+
+        lock_guard<mutex> lock(data_mutex);
+        SimTable &table = tableFor(name, isAlarmTableName(name));
+        while (table.bits.size() <= (size_t)index)
+        {
+            size_t i = table.bits.size();
+            table.bits.push_back(table.is_int32 ? 0u : initialFloatBits(name, i));
+        }
+        table.bits[index] = table.is_int32 ? (uint32_t)(int32_t)strtol(tokens[0].c_str(), nullptr, 10)
+                                           : floatBits(strtof(tokens[0].c_str(), nullptr));
+        reply.assign(header, 2);
+        stats.writes++;
+        return true;
+    }
+
+    return false;
+}
+
+// ============== CAMBIO DE VALORES ==============
+
+void PACSimulator::churnLoop()
+{
+    const auto tick = chrono::milliseconds(100);
+    uniform_real_distribution<float> step(-0.01f, 0.01f);
+    uniform_real_distribution<double> coin(0.0, 1.0);
+
+    while (running)
+    {
+        this_thread::sleep_for(tick);
+
+        lock_guard<mutex> lock(data_mutex);
+        if (table_names.empty())
+            continue;
+
+        // Cada tick cambia churn/10 de los valores (churn = fracción por segundo)
+        size_t total = 0;
+        for (const auto &[name, table] : tables)
+            total += table.bits.size();
+
+        double expected = total * opts.churn / 10.0;
+        size_t changes = (size_t)expected + (coin(churn_rng) < expected - floor(expected) ? 1 : 0);
+
+        for (size_t c = 0; c < changes; c++)
+        {
+            const string &name = table_names[churn_rng() % table_names.size()];
+            SimTable &table = tables[name];
+            if (table.bits.empty())
+                continue;
+
+            size_t index = churn_rng() % table.bits.size();
+            if (table.is_int32)
+            {
+                table.bits[index] ^= 1u;   // Alarmas: conmutar un bit
+            }
+            else
+            {
+                float value = bitsFloat(table.bits[index]);
+                value += (fabs(value) > 1.0f ? value : 1.0f) * step(churn_rng);
+                table.bits[index] = floatBits(value);
+            }
+        }
+
+        for (auto &[name, scalar] : scalars)
+        {
+            if (coin(churn_rng) >= opts.churn / 10.0)
+                continue;
+            if (scalar.is_int32)
+                scalar.bits++;
+            else
+                scalar.bits = floatBits(bitsFloat(scalar.bits) * (1.0f + step(churn_rng)));
+        }
+    }
+}
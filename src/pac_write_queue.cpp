@@ -0,0 +1,202 @@
+#define LOG_MODULE LogModule::Write
+#include "pac_write_queue.h"
+#include "common.h"
+#include "pac_protocol.h"
+#include <unordered_map>
+#include <algorithm>
+
+using namespace std;
+
+PACWriteQueue::PACWriteQueue(PACConnectionPool &pool, CompletionHandler on_complete, size_t max_batch)
+    : head(&stub), tail(&stub), pool(pool), on_complete(std::move(on_complete)), max_batch(max(max_batch, (size_t)1))
+{
+    writer_thread = thread(&PACWriteQueue::writerLoop, this);
+}
+
+PACWriteQueue::~PACWriteQueue()
+{
+    {
+        lock_guard<mutex> lock(wake_mutex);
+        stopping = true;
+    }
+    wake_cv.notify_all();
+    if (writer_thread.joinable())
+        writer_thread.join();
+
+    // Liberar lo que no se llegó a enviar
+    while (Node *node = popNode())
+        delete node;
+}
+
+void PACWriteQueue::pushNode(Node *node)
+{
+    node->next.store(nullptr, memory_order_relaxed);
+    Node *prev = head.exchange(node, memory_order_acq_rel);
+    prev->next.store(node, memory_order_release);
+}
+
+PACWriteQueue::Node *PACWriteQueue::popNode()
+{
+    Node *t = tail;
+    Node *next = t->next.load(memory_order_acquire);
+
+    if (t == &stub)
+    {
+        if (!next)
+            return nullptr;
+        tail = next;
+        t = next;
+        next = next->next.load(memory_order_acquire);
+    }
+
+    if (next)
+    {
+        tail = next;
+        return t;
+    }
+
+    // t es el último nodo: si un productor está a mitad de push, reintentar más tarde
+    if (t != head.load(memory_order_acquire))
+        return nullptr;
+
+    pushNode(&stub);
+    next = t->next.load(memory_order_acquire);
+    if (next)
+    {
+        tail = next;
+        return t;
+    }
+    return nullptr;
+}
+
+void PACWriteQueue::push(PACWriteRequest request)
+{
+    request.enqueued = chrono::steady_clock::now();
+
+    Node *node = new Node;
+    node->request = std::move(request);
+    pushNode(node);
+
+    stats.enqueued.fetch_add(1, memory_order_relaxed);
+    stats.pending.fetch_add(1, memory_order_relaxed);
+
+    // Bajo wake_mutex: el escritor no puede estar entre comprobar pending y dormirse
+    lock_guard<mutex> lock(wake_mutex);
+    wake_cv.notify_one();
+}
+
+void PACWriteQueue::writerLoop()
+{
+    while (!stopping)
+    {
+        {
+            unique_lock<mutex> lock(wake_mutex);
+            wake_cv.wait(lock, [this] {
+                return stopping.load() || stats.pending.load(memory_order_relaxed) > 0;
+            });
+        }
+
+        // Un productor a mitad de push(): su nodo aparece en cuanto enlaza el siguiente
+        if (drainAndSubmit() == 0)
+            this_thread::yield();
+    }
+
+    // Último intento con lo que quedó en cola al detener
+    drainAndSubmit();
+}
+
+size_t PACWriteQueue::drainAndSubmit()
+{
+    // 1. Vaciar la cola coalesciendo por variable: se conserva la posición
+    //    de la primera escritura y el valor de la última
+    vector<PACWriteRequest> batch;
+    unordered_map<uint32_t, size_t> position;
+    size_t drained = 0;
+
+    while (Node *node = popNode())
+    {
+        stats.pending.fetch_sub(1, memory_order_relaxed);
+        drained++;
+
+        auto it = position.find(node->request.var_id);
+        if (node->request.isRange())
+        {
+            // Un tramo no se funde con nada y corta la coalescencia: lo posterior va detrás de él
+            position.clear();
+            batch.push_back(std::move(node->request));
+        }
+        else if (it != position.end())
+        {
+            batch[it->second] = std::move(node->request);
+            stats.coalesced.fetch_add(1, memory_order_relaxed);
+        }
+        else
+        {
+            position.emplace(node->request.var_id, batch.size());
+            batch.push_back(std::move(node->request));
+        }
+        delete node;
+    }
+
+    if (batch.empty())
+        return 0;
+
+    // 2. Formatear comandos TABLE! / @! y enviarlos en pipeline por la sesión de escritura;
+    //    los de la solicitud i quedan en [first[i], first[i + 1])
+    vector<WriteCommand> commands;
+    vector<size_t> first(batch.size() + 1);
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        const PACWriteRequest &req = batch[i];
+        first[i] = commands.size();
+        if (req.isRange())
+        {
+            for (size_t k = 0; k < req.rangeLength(); k++)
+            {
+                int index = req.index + (int)k;
+                commands.push_back({req.is_int32 ? pac_protocol::buildTableWriteCommand(req.target, index, req.int_range[k])
+                                                 : pac_protocol::buildTableWriteCommand(req.target, index, req.float_range[k])});
+            }
+        }
+        else if (req.index >= 0)
+        {
+            commands.push_back({req.is_int32 ? pac_protocol::buildTableWriteCommand(req.target, req.index, req.int_value)
+                                             : pac_protocol::buildTableWriteCommand(req.target, req.index, req.float_value)});
+        }
+        else
+        {
+            commands.push_back({req.is_int32 ? pac_protocol::buildScalarWriteCommand(req.target, req.int_value)
+                                             : pac_protocol::buildScalarWriteCommand(req.target, req.float_value)});
+        }
+    }
+    first[batch.size()] = commands.size();
+
+    PACControlClient &writer = pool.writer();
+    if (writer.isConnected())
+    {
+        size_t confirmed = writer.writeCommandsPipelined(commands, max_batch);
+        if (any_of(commands.begin(), commands.end(), [](const WriteCommand &cmd) { return cmd.sent; }))
+            stats.batches.fetch_add(1, memory_order_relaxed);
+        LOG_WRITE("📤 Lote de escritura: " << confirmed << "/" << commands.size() << " confirmadas");
+    }
+    else
+    {
+        LOG_ERROR("PAC no conectado para escritura: " << batch.size() << " escrituras descartadas");
+    }
+
+    // 3. Notificar resultados: un tramo sólo es correcto si se confirmaron todos sus elementos
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        bool ok = all_of(commands.begin() + first[i], commands.begin() + first[i + 1],
+                         [](const WriteCommand &cmd) { return cmd.ok; });
+        if (ok)
+            stats.completed.fetch_add(1, memory_order_relaxed);
+        else
+            stats.failed.fetch_add(1, memory_order_relaxed);
+
+        if (on_complete)
+            on_complete(batch[i], ok);
+    }
+
+    return drained;
+}
@@ -0,0 +1,216 @@
+#define LOG_MODULE LogModule::PAC
+#include "packet_capture.h"
+#include "common.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+static const size_t MIN_CAPACITY = 64 * 1024;
+
+static uint64_t recordSize(uint64_t length)
+{
+    return (sizeof(PacketRecordHeader) + length + 7) & ~uint64_t(7);
+}
+
+unique_ptr<PacketCapture> PacketCapture::create(const string &path, size_t capacity)
+{
+    capacity = max(capacity, MIN_CAPACITY) & ~size_t(7);
+
+    unique_ptr<PacketCapture> capture(new PacketCapture());
+    capture->file_path = path;
+    capture->fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (capture->fd < 0)
+    {
+        LOG_ERROR("❌ No se pudo abrir la captura " << path << ": " << strerror(errno));
+        return nullptr;
+    }
+
+    capture->mapping_size = sizeof(PacketCaptureHeader) + capacity;
+    if (ftruncate(capture->fd, (off_t)capture->mapping_size) < 0)
+    {
+        LOG_ERROR("❌ No se pudo dimensionar la captura " << path << ": " << strerror(errno));
+        return nullptr;
+    }
+
+    void *mapping = mmap(nullptr, capture->mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, capture->fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        LOG_ERROR("❌ No se pudo mapear la captura " << path << ": " << strerror(errno));
+        return nullptr;
+    }
+
+    capture->mapping = static_cast<uint8_t *>(mapping);
+    capture->header = reinterpret_cast<PacketCaptureHeader *>(capture->mapping);
+    capture->area = capture->mapping + sizeof(PacketCaptureHeader);
+
+    PacketCaptureHeader &header = *capture->header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PACKET_CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = PACKET_CAPTURE_VERSION;
+    header.header_size = sizeof(PacketCaptureHeader);
+    header.capacity = capacity;
+
+    LOG_INFO("📼 Captura de tramas PAC activa: " << path << " (" << capacity / 1024 << " KB en anillo)");
+    return capture;
+}
+
+PacketCapture::~PacketCapture()
+{
+    if (mapping)
+    {
+        msync(mapping, mapping_size, MS_ASYNC);
+        munmap(mapping, mapping_size);
+    }
+    if (fd >= 0)
+        close(fd);
+}
+
+// Dejar libres size bytes contiguos en head, pisando los registros más antiguos si hace falta
+void PacketCapture::reserve(uint64_t size)
+{
+    PacketCaptureHeader &h = *header;
+    while (true)
+    {
+        if (!h.wrapped)
+        {
+            // Registros en [tail, head): libre hasta el final del área
+            if (h.head + size <= h.capacity)
+                return;
+
+            h.wrap_end = h.head;
+            h.head = 0;
+            h.wrapped = 1;
+            if (h.tail == h.wrap_end)
+            {
+                // Estaba vacío
+                h.tail = 0;
+                h.wrapped = 0;
+                continue;
+            }
+        }
+
+        // Registros en [tail, wrap_end) + [0, head): libre en [head, tail)
+        if (h.head + size <= h.tail)
+            return;
+
+        const PacketRecordHeader *oldest = reinterpret_cast<const PacketRecordHeader *>(area + h.tail);
+        h.tail += recordSize(oldest->length);
+        h.overwritten++;
+        if (h.tail >= h.wrap_end)
+        {
+            h.tail = 0;
+            h.wrapped = 0;
+        }
+    }
+}
+
+void PacketCapture::record(PacketRecordHeader::Kind kind, uint64_t connection, span<const uint8_t> frame,
+                           uint8_t status, uint32_t count)
+{
+    uint64_t size = recordSize(frame.size());
+    if (size > header->capacity)
+        return;
+
+    PacketRecordHeader record{};
+    record.magic = PACKET_RECORD_MAGIC;
+    record.length = (uint32_t)frame.size();
+    record.wall_ns = chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    record.mono_ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    record.connection = connection;
+    record.kind = kind;
+    record.status = status;
+    record.count = count;
+
+    lock_guard<mutex> lock(write_mutex);
+    reserve(size);
+
+    uint8_t *target = area + header->head;
+    memcpy(target, &record, sizeof(record));
+    if (!frame.empty())
+        memcpy(target + sizeof(record), frame.data(), frame.size());
+
+    header->head += size;
+    header->records++;
+}
+
+// ============== LECTURA ==============
+
+bool PacketCapture::read(const string &path, const Visitor &visit, PacketCaptureHeader &header, string &error)
+{
+    int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+    {
+        error = strerror(errno);
+        return false;
+    }
+
+    struct stat info{};
+    vector<uint8_t> contents;
+    if (fstat(file, &info) == 0)
+    {
+        contents.resize((size_t)info.st_size);
+        size_t offset = 0;
+        while (offset < contents.size())
+        {
+            ssize_t got = ::read(file, contents.data() + offset, contents.size() - offset);
+            if (got <= 0)
+                break;
+            offset += (size_t)got;
+        }
+        contents.resize(offset);
+    }
+    close(file);
+
+    if (contents.size() < sizeof(PacketCaptureHeader))
+    {
+        error = "archivo demasiado corto";
+        return false;
+    }
+
+    memcpy(&header, contents.data(), sizeof(header));
+    if (memcmp(header.magic, PACKET_CAPTURE_MAGIC, sizeof(header.magic)) != 0)
+    {
+        error = "no es una captura PAC";
+        return false;
+    }
+    if (header.version != PACKET_CAPTURE_VERSION)
+    {
+        error = "versión " + to_string(header.version) + " no soportada";
+        return false;
+    }
+    if (header.header_size < sizeof(PacketCaptureHeader) || contents.size() < header.header_size + header.capacity ||
+        header.head > header.capacity || header.tail > header.capacity ||
+        (header.wrapped && header.wrap_end > header.capacity))
+    {
+        error = "header inconsistente (¿archivo truncado?)";
+        return false;
+    }
+
+    const uint8_t *area = contents.data() + header.header_size;
+    auto walk = [&](uint64_t from, uint64_t to) {
+        while (from + sizeof(PacketRecordHeader) <= to)
+        {
+            PacketRecordHeader record;
+            memcpy(&record, area + from, sizeof(record));
+            if (record.magic != PACKET_RECORD_MAGIC || from + recordSize(record.length) > to)
+            {
+                error = "registro corrupto en el desplazamiento " + to_string(from);
+                return false;
+            }
+            visit(record, span<const uint8_t>(area + from + sizeof(record), record.length));
+            from += recordSize(record.length);
+        }
+        return true;
+    };
+
+    if (header.wrapped)
+        return walk(header.tail, header.wrap_end) && walk(0, header.head);
+    return walk(header.tail, header.head);
+}
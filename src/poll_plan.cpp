@@ -0,0 +1,288 @@
+#define LOG_MODULE LogModule::Poll
+#include "poll_plan.h"
+#include "pac_protocol.h"
+#include <algorithm>
+
+using namespace std;
+
+// Tablas de alarmas (INT32): TBL_DA_, TBL_PA_, TBL_LA_, TBL_TA_
+static bool isAlarmTableName(const string &tableName)
+{
+    return tableName.find("TBL_DA_") == 0 ||
+           tableName.find("TBL_PA_") == 0 ||
+           tableName.find("TBL_LA_") == 0 ||
+           tableName.find("TBL_TA_") == 0;
+}
+
+void PollPlan::build(vector<Variable> &variables, int default_scan_ms, int background_ms, TableRegistry *registry,
+                     int controller)
+{
+    lock_guard<mutex> lock(cache_mutex);
+
+    class_periods.clear();
+    tables.clear();
+    scalars.clear();
+    slots.clear();
+    var_source.assign(variables.size(), NO_SOURCE);
+    batch_cache.clear();
+
+    // 🕒 Una clase por periodo distinto (scan_ms 0 → update_interval_ms)
+    map<int, size_t> class_by_period;
+    auto classOf = [&](const Variable &var) {
+        int period = var.scan_ms > 0 ? var.scan_ms : default_scan_ms;
+        auto it = class_by_period.find(period);
+        if (it == class_by_period.end())
+        {
+            it = class_by_period.emplace(period, class_periods.size()).first;
+            class_periods.push_back(period);
+        }
+        return it->second;
+    };
+
+    // 📊 Agrupar por (tabla, clase) en orden de aparición; el parseo de pac_source se hace sólo aquí
+    map<pair<string, size_t>, size_t> table_ids;
+    vector<vector<PollSlot>> table_slots;
+
+    for (size_t var_id = 0; var_id < variables.size(); var_id++)
+    {
+        Variable &var = variables[var_id];
+        if (controller >= 0 && var.controller != controller)
+            continue;
+        size_t cls = classOf(var);
+
+        size_t pos = var.pac_source.find(':');
+        if (pos == string::npos)
+        {
+            scalars.push_back({&var, (uint32_t)var_id, cls, 0});
+            continue;
+        }
+
+        string table = var.pac_source.substr(0, pos);
+        int index = -1;
+        try
+        {
+            index = stoi(var.pac_source.substr(pos + 1));
+        }
+        catch (const exception &)
+        {
+            index = -1;
+        }
+
+        if (index < 0)
+        {
+            LOG_WARNING("⚠️ pac_source inválido, variable fuera del plan: " << var.opcua_name << " (" << var.pac_source << ")");
+            continue;
+        }
+
+        auto key = make_pair(table, cls);
+        auto it = table_ids.find(key);
+        if (it == table_ids.end())
+        {
+            TableReadDescriptor desc;
+            desc.request.table_name = table;
+            desc.request.start_pos = 0;   // Siempre desde 0: tamaño de trama conocido
+            desc.request.end_pos = index;
+            desc.request.is_int32 = isAlarmTableName(table);
+            desc.scan_class = cls;
+
+            it = table_ids.emplace(key, tables.size()).first;
+            tables.push_back(desc);
+            table_slots.emplace_back();
+        }
+
+        TableReadDescriptor &desc = tables[it->second];
+        desc.request.end_pos = max(desc.request.end_pos, index);
+        table_slots[it->second].push_back({&var, (uint32_t)var_id, index});
+    }
+
+    // 📦 Aplanar destinos en un único array contiguo y precompilar comandos
+    size_t total_slots = 0;
+    for (const auto &ts : table_slots)
+        total_slots += ts.size();
+    slots.reserve(total_slots);
+
+    size_t float_total = 0;
+    size_t int_total = 0;
+    for (size_t t = 0; t < tables.size(); t++)
+    {
+        TableReadDescriptor &desc = tables[t];
+        desc.request.command = pac_protocol::buildTableReadCommand(desc.request.table_name,
+                                                                   desc.request.start_pos,
+                                                                   desc.request.end_pos);
+        desc.expected_bytes = pac_protocol::tableResponseBytes(desc.request.start_pos, desc.request.end_pos);
+        desc.first_slot = slots.size();
+        desc.slot_count = table_slots[t].size();
+        slots.insert(slots.end(), table_slots[t].begin(), table_slots[t].end());
+
+        desc.source_id = t;
+        if (registry)
+            desc.request.table_id = registry->intern(desc.request.table_name, (uint32_t)desc.request.end_pos + 1);
+        for (const PollSlot &slot : table_slots[t])
+            var_source[slot.var_id] = t;
+
+        desc.value_count = desc.expected_bytes / pac_protocol::TABLE_ELEMENT_BYTES;
+        size_t &total = desc.request.is_int32 ? int_total : float_total;
+        desc.value_offset = total;
+        total += desc.value_count;
+    }
+
+    for (size_t i = 0; i < scalars.size(); i++)
+    {
+        scalars[i].source_id = tables.size() + i;
+        var_source[scalars[i].var_id] = scalars[i].source_id;
+    }
+
+    // 🧮 Almacén de valores: las lecturas decodifican directo aquí (sin vectores por tabla)
+    float_values.assign(float_total, 0.0f);
+    int_values.assign(int_total, 0);
+    for (auto &desc : tables)
+    {
+        if (desc.request.is_int32)
+            desc.request.int_dest = span<int32_t>(int_values).subspan(desc.value_offset, desc.value_count);
+        else
+            desc.request.float_dest = span<float>(float_values).subspan(desc.value_offset, desc.value_count);
+    }
+
+    if (class_periods.empty())
+        class_periods.push_back(default_scan_ms);
+
+    // 🌙 Clase de fondo: siempre propia, aunque coincida en periodo con otra
+    background_class = NO_CLASS;
+    if (background_ms > 0)
+    {
+        background_class = class_periods.size();
+        class_periods.push_back(background_ms);
+    }
+
+    // Hasta el primer applyDemand() todo tiene demanda (mismo comportamiento que sin fondo)
+    table_demand.assign(tables.size(), 1);
+    scalar_demand.assign(scalars.size(), 1);
+
+    build_generation++;
+
+    LOG_INFO("🗺️ Plan de sondeo compilado: " << tables.size() << " lecturas de tabla, "
+             << scalars.size() << " escalares, " << slots.size() << " destinos, "
+             << class_periods.size() << " clases de escaneo");
+}
+
+const PollBatch &PollPlan::batchFor(vector<size_t> due_classes)
+{
+    sort(due_classes.begin(), due_classes.end());
+
+    lock_guard<mutex> lock(cache_mutex);
+
+    auto it = batch_cache.find(due_classes);
+    if (it != batch_cache.end())
+        return it->second;
+
+    // Primera vez que vence esta combinación: construir y guardar el lote
+    vector<bool> is_due(class_periods.size(), false);
+    for (size_t cls : due_classes)
+    {
+        if (cls < is_due.size())
+            is_due[cls] = true;
+    }
+
+    // Con demanda: en su clase. Sin demanda: sólo cuando vence la clase de fondo
+    bool background_due = background_class != NO_CLASS && is_due[background_class];
+    auto isRead = [&](size_t cls, uint8_t demand) {
+        return demand ? is_due[cls] : background_due;
+    };
+
+    PollBatch batch;
+    for (size_t t = 0; t < tables.size(); t++)
+    {
+        const auto &desc = tables[t];
+        if (!isRead(desc.scan_class, table_demand[t]))
+            continue;
+        batch.tables.push_back(desc.request);
+        batch.table_desc.push_back(&desc);
+    }
+
+    for (size_t s = 0; s < scalars.size(); s++)
+    {
+        const auto &desc = scalars[s];
+        if (!isRead(desc.scan_class, scalar_demand[s]))
+            continue;
+        batch.scalars.emplace_back(desc.var->pac_source, desc.var->type == Variable::INT32 ? "INT32" : "FLOAT");
+        batch.scalar_desc.push_back(&desc);
+    }
+
+    return batch_cache.emplace(std::move(due_classes), std::move(batch)).first->second;
+}
+
+void PollPlan::applyDemand(const vector<uint8_t> &monitored_vars)
+{
+    lock_guard<mutex> lock(cache_mutex);
+
+    if (background_class == NO_CLASS)
+        return;
+
+    auto isMonitored = [&](uint32_t var_id) {
+        return var_id < monitored_vars.size() && monitored_vars[var_id];
+    };
+
+    for (size_t t = 0; t < tables.size(); t++)
+    {
+        const TableReadDescriptor &desc = tables[t];
+        uint8_t demand = 0;
+        for (size_t s = desc.first_slot; s < desc.first_slot + desc.slot_count && !demand; s++)
+            demand = isMonitored(slots[s].var_id) ? 1 : 0;
+        table_demand[t] = demand;
+    }
+
+    for (size_t s = 0; s < scalars.size(); s++)
+        scalar_demand[s] = isMonitored(scalars[s].var_id) ? 1 : 0;
+
+    // Los lotes cacheados reflejan la demanda anterior
+    batch_cache.clear();
+}
+
+size_t PollPlan::sourceOf(uint32_t var_id) const
+{
+    return var_id < var_source.size() ? var_source[var_id] : NO_SOURCE;
+}
+
+const TableReadDescriptor *PollPlan::tableSource(size_t source) const
+{
+    return source < tables.size() ? &tables[source] : nullptr;
+}
+
+const ScalarReadDescriptor *PollPlan::scalarSource(size_t source) const
+{
+    if (source < tables.size() || source >= sourceCount())
+        return nullptr;
+    return &scalars[source - tables.size()];
+}
+
+size_t PollPlan::demandedTables() const
+{
+    return count(table_demand.begin(), table_demand.end(), 1);
+}
+
+size_t PollPlan::demandedScalars() const
+{
+    return count(scalar_demand.begin(), scalar_demand.end(), 1);
+}
+
+span<const float> PollPlan::floatValues(const TableReadDescriptor &desc) const
+{
+    if (desc.request.is_int32)
+        return {};
+    return span<const float>(float_values).subspan(desc.value_offset, desc.value_count);
+}
+
+span<const int32_t> PollPlan::int32Values(const TableReadDescriptor &desc) const
+{
+    if (!desc.request.is_int32)
+        return {};
+    return span<const int32_t>(int_values).subspan(desc.value_offset, desc.value_count);
+}
+
+const PollBatch &PollPlan::fullBatch()
+{
+    vector<size_t> all(class_periods.size());
+    for (size_t i = 0; i < all.size(); i++)
+        all[i] = i;
+    return batchFor(std::move(all));
+}
@@ -0,0 +1,81 @@
+#define LOG_MODULE LogModule::Poll
+#include "poll_scheduler.h"
+#include "common.h"
+#include <thread>
+#include <algorithm>
+
+using namespace std;
+
+PollScheduler::PollScheduler(const vector<int> &periods_ms, int merge_window_ms)
+    : merge_window(merge_window_ms)
+{
+    auto now = clock::now();
+    for (size_t i = 0; i < periods_ms.size(); i++)
+    {
+        ScanClass sc;
+        sc.period_ms = max(1, periods_ms[i]);
+        sc.next_deadline = now;  // Primera lectura inmediata
+        classes.push_back(sc);
+        due_queue.push({sc.next_deadline, i});
+    }
+}
+
+vector<size_t> PollScheduler::waitForDue(const atomic<bool> &keep_running)
+{
+    vector<size_t> due;
+    if (due_queue.empty())
+        return due;
+
+    // Dormir hasta el deadline más próximo en tramos cortos para poder detenerse
+    while (keep_running)
+    {
+        auto now = clock::now();
+        auto deadline = due_queue.top().first;
+        if (deadline <= now)
+            break;
+
+        this_thread::sleep_until(min(deadline, now + chrono::milliseconds(100)));
+    }
+
+    if (!keep_running)
+        return due;
+
+    // Fusionar todo lo que vence dentro de la ventana en un solo lote
+    auto horizon = clock::now() + merge_window;
+    while (!due_queue.empty() && due_queue.top().first <= horizon)
+    {
+        due.push_back(due_queue.top().second);
+        due_queue.pop();
+    }
+    return due;
+}
+
+void PollScheduler::complete(const vector<size_t> &due, clock::time_point started, clock::time_point finished)
+{
+    double duration_ms = chrono::duration<double, milli>(finished - started).count();
+
+    for (size_t idx : due)
+    {
+        ScanClass &sc = classes[idx];
+        auto period = chrono::milliseconds(sc.period_ms);
+
+        sc.cycles++;
+        sc.last_duration_ms = duration_ms;
+
+        auto next = sc.next_deadline + period;
+        if (next <= finished)
+        {
+            // Overrun: saltar los slots perdidos manteniendo la fase original
+            auto late = finished - sc.next_deadline;
+            auto missed = late / period;
+            sc.overruns += missed;
+            next = sc.next_deadline + period * (missed + 1);
+
+            LOG_WARNING("⏱️ Overrun en clase " << sc.period_ms << " ms: ciclo de "
+                        << duration_ms << " ms, " << missed << " deadline(s) perdido(s)");
+        }
+
+        sc.next_deadline = next;
+        due_queue.push({next, idx});
+    }
+}
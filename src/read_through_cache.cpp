@@ -0,0 +1,81 @@
+#define LOG_MODULE LogModule::Poll
+#include "read_through_cache.h"
+
+using namespace std;
+
+void ReadThroughCache::reset(size_t source_count)
+{
+    count = source_count;
+    read_at_ns.reset(new atomic<int64_t>[source_count]);
+    refreshing.reset(new uint8_t[source_count]());
+    for (size_t i = 0; i < source_count; i++)
+        read_at_ns[i].store(0, memory_order_relaxed);
+}
+
+void ReadThroughCache::markFresh(size_t source, clock::time_point read_at)
+{
+    if (source >= count)
+        return;
+
+    int64_t stamp = chrono::duration_cast<chrono::nanoseconds>(read_at.time_since_epoch()).count();
+
+    // Nunca retroceder: una lectura bajo demanda puede terminar antes que un ciclo más antiguo
+    int64_t current = read_at_ns[source].load(memory_order_relaxed);
+    while (stamp > current && !read_at_ns[source].compare_exchange_weak(current, stamp, memory_order_release))
+    {
+    }
+}
+
+bool ReadThroughCache::isFresh(size_t source, chrono::milliseconds max_age)
+{
+    if (source >= count)
+        return true;  // Sin fuente en el plan: nada que refrescar
+
+    int64_t stamp = read_at_ns[source].load(memory_order_acquire);
+    if (stamp == 0)
+        return false;
+
+    int64_t now = chrono::duration_cast<chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+    if (now - stamp > chrono::duration_cast<chrono::nanoseconds>(max_age).count())
+        return false;
+
+    stats.hits.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+bool ReadThroughCache::readAfter(size_t source, clock::time_point since) const
+{
+    if (source >= count)
+        return false;
+
+    int64_t stamp = chrono::duration_cast<chrono::nanoseconds>(since.time_since_epoch()).count();
+    return read_at_ns[source].load(memory_order_acquire) > stamp;
+}
+
+bool ReadThroughCache::beginRefresh(size_t source)
+{
+    if (source >= count)
+        return false;
+
+    if (refreshing[source])
+    {
+        stats.coalesced.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    refreshing[source] = 1;
+    stats.fetches.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+void ReadThroughCache::endRefresh(size_t source, bool ok, clock::time_point started)
+{
+    if (source >= count)
+        return;
+
+    refreshing[source] = 0;
+    if (ok)
+        markFresh(source, started);
+    else
+        stats.failures.fetch_add(1, memory_order_relaxed);
+}
@@ -0,0 +1,55 @@
+#include "subscription_tracker.h"
+
+using namespace std;
+
+void SubscriptionTracker::reset(size_t variable_count)
+{
+    count = variable_count;
+    items.reset(new atomic<uint32_t>[variable_count]);
+    for (size_t i = 0; i < variable_count; i++)
+        items[i].store(0, memory_order_relaxed);
+    monitored.store(0, memory_order_relaxed);
+    changes.fetch_add(1, memory_order_release);
+}
+
+void SubscriptionTracker::onRegister(uint32_t id, bool removed)
+{
+    if (id >= count)
+        return;
+
+    if (!removed)
+    {
+        // Primer MonitoredItem: la variable pasa a sondearse a su ritmo
+        if (items[id].fetch_add(1, memory_order_acq_rel) == 0)
+        {
+            monitored.fetch_add(1, memory_order_relaxed);
+            changes.fetch_add(1, memory_order_release);
+        }
+        return;
+    }
+
+    // Baja sin alta previa (p.ej. tras reset()): no bajar de cero
+    uint32_t current = items[id].load(memory_order_acquire);
+    while (current > 0 && !items[id].compare_exchange_weak(current, current - 1, memory_order_acq_rel))
+    {
+    }
+
+    if (current == 1)
+    {
+        monitored.fetch_sub(1, memory_order_relaxed);
+        changes.fetch_add(1, memory_order_release);
+    }
+}
+
+bool SubscriptionTracker::isMonitored(uint32_t id) const
+{
+    return id < count && items[id].load(memory_order_acquire) > 0;
+}
+
+vector<uint8_t> SubscriptionTracker::snapshot() const
+{
+    vector<uint8_t> flags(count, 0);
+    for (size_t i = 0; i < count; i++)
+        flags[i] = items[i].load(memory_order_acquire) > 0 ? 1 : 0;
+    return flags;
+}
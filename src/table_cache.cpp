@@ -0,0 +1,113 @@
+#include "table_cache.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+static int64_t toNs(chrono::steady_clock::time_point t)
+{
+    return chrono::duration_cast<chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+void TableCache::layout(const TableRegistry &registry)
+{
+    table_offset.resize(registry.count());
+    table_size.resize(registry.count());
+
+    uint32_t total = 0;
+    for (TableId id = 0; id < registry.count(); id++)
+    {
+        table_offset[id] = total;
+        table_size[id] = registry.size(id);
+        total += registry.size(id);
+    }
+
+    values.assign(total, 0);
+    read_ns.assign(total, 0);
+    valid.assign(total, 0);
+}
+
+bool TableCache::locate(TableId id, int start, size_t count, size_t &offset) const
+{
+    if (id >= table_offset.size() || start < 0 || count == 0 || (size_t)start + count > table_size[id])
+        return false;
+
+    offset = table_offset[id] + (size_t)start;
+    return true;
+}
+
+bool TableCache::get(TableId id, int start, int end, void *out, size_t out_count, clock::time_point not_before) const
+{
+    if (end < start)
+        return false;
+
+    size_t count = (size_t)(end - start + 1);
+    size_t offset;
+    if (count > out_count || !locate(id, start, count, offset))
+        return false;
+
+    // Todo el tramo debe ser válido y suficientemente reciente
+    int64_t oldest = toNs(not_before);
+    for (size_t i = offset; i < offset + count; i++)
+    {
+        if (!valid[i] || read_ns[i] < oldest)
+            return false;
+    }
+
+    memcpy(out, &values[offset], count * sizeof(uint32_t));
+    return true;
+}
+
+void TableCache::put(TableId id, int start, const void *bits, size_t count, clock::time_point read_at)
+{
+    if (id >= table_offset.size() || start < 0 || (size_t)start >= table_size[id])
+        return;
+
+    count = min(count, (size_t)table_size[id] - (size_t)start);
+    size_t offset = table_offset[id] + (size_t)start;
+    if (count == 0)
+        return;
+
+    memcpy(&values[offset], bits, count * sizeof(uint32_t));
+    fill_n(read_ns.begin() + offset, count, toNs(read_at));
+    fill_n(valid.begin() + offset, count, 1);
+}
+
+bool TableCache::getFloats(TableId id, int start, int end, span<float> out, clock::time_point not_before) const
+{
+    return get(id, start, end, out.data(), out.size(), not_before);
+}
+
+bool TableCache::getInt32s(TableId id, int start, int end, span<int32_t> out, clock::time_point not_before) const
+{
+    return get(id, start, end, out.data(), out.size(), not_before);
+}
+
+void TableCache::putFloats(TableId id, int start, span<const float> values, clock::time_point read_at)
+{
+    put(id, start, values.data(), values.size(), read_at);
+}
+
+void TableCache::putInt32s(TableId id, int start, span<const int32_t> values, clock::time_point read_at)
+{
+    put(id, start, values.data(), values.size(), read_at);
+}
+
+void TableCache::invalidate(TableId id)
+{
+    if (id >= table_offset.size())
+        return;
+    fill_n(valid.begin() + table_offset[id], table_size[id], 0);
+}
+
+void TableCache::invalidate(TableId id, int index)
+{
+    size_t offset;
+    if (locate(id, index, 1, offset))
+        valid[offset] = 0;
+}
+
+void TableCache::clear()
+{
+    fill(valid.begin(), valid.end(), 0);
+}
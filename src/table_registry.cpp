@@ -0,0 +1,33 @@
+#include "table_registry.h"
+#include <algorithm>
+
+using namespace std;
+
+TableId TableRegistry::intern(string_view name, uint32_t min_size)
+{
+    auto it = ids.find(name);
+    if (it != ids.end())
+    {
+        sizes[it->second] = max(sizes[it->second], min_size);
+        return it->second;
+    }
+
+    TableId id = static_cast<TableId>(names.size());
+    names.emplace_back(name);
+    sizes.push_back(min_size);
+    ids.emplace(names.back(), id);
+    return id;
+}
+
+TableId TableRegistry::find(string_view name) const
+{
+    auto it = ids.find(name);
+    return it != ids.end() ? it->second : NO_TABLE;
+}
+
+void TableRegistry::clear()
+{
+    names.clear();
+    sizes.clear();
+    ids.clear();
+}
@@ -0,0 +1,82 @@
+#include "value_store.h"
+#include <thread>
+
+using namespace std;
+
+void ValueStore::reset(size_t variable_count)
+{
+    count = variable_count;
+    words = (variable_count + 63) / 64;
+    slots.reset(new Slot[variable_count]);
+    pending.reset(new atomic<uint64_t>[words]);
+    for (size_t w = 0; w < words; w++)
+        pending[w].store(0, memory_order_relaxed);
+}
+
+void ValueStore::publishFloat(uint32_t id, float value, int64_t read_at_ns)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    publish(id, bits, false, read_at_ns);
+}
+
+void ValueStore::publishInt32(uint32_t id, int32_t value, int64_t read_at_ns)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    publish(id, bits, true, read_at_ns);
+}
+
+void ValueStore::publish(uint32_t id, uint32_t bits, bool is_int32, int64_t read_at_ns)
+{
+    if (id >= count)
+        return;
+
+    Slot &slot = slots[id];
+
+    // Tomar el slot (pasa a impar): sondeo y lectura bajo demanda pueden publicar la misma variable
+    uint32_t sequence = slot.sequence.load(memory_order_relaxed);
+    while ((sequence & 1) || !slot.sequence.compare_exchange_weak(sequence, sequence + 1, memory_order_relaxed))
+    {
+        if (sequence & 1)
+        {
+            this_thread::yield();
+            sequence = slot.sequence.load(memory_order_relaxed);
+        }
+    }
+    atomic_thread_fence(memory_order_release);
+
+    slot.bits.store(bits, memory_order_relaxed);
+    slot.is_int32.store(is_int32, memory_order_relaxed);
+    slot.read_at_ns.store(read_at_ns, memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, memory_order_release);
+
+    // Después del valor: quien vea el bit ve (al menos) esta versión
+    pending[id / 64].fetch_or(uint64_t(1) << (id % 64), memory_order_release);
+}
+
+PublishedValue ValueStore::load(uint32_t id) const
+{
+    const Slot &slot = slots[id];
+    PublishedValue value{};
+    value.id = id;
+
+    while (true)
+    {
+        uint32_t before = slot.sequence.load(memory_order_acquire);
+        if (before & 1)
+        {
+            this_thread::yield();
+            continue;
+        }
+
+        value.bits = slot.bits.load(memory_order_relaxed);
+        value.is_int32 = slot.is_int32.load(memory_order_relaxed);
+        value.read_at_ns = slot.read_at_ns.load(memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+        if (slot.sequence.load(memory_order_relaxed) == before)
+            return value;
+    }
+}
@@ -0,0 +1,371 @@
+#include "pac_protocol.h"
+#include "pac_control_client.h"
+#include "common.h"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <new>
+#include <sstream>
+
+using namespace std;
+using json = nlohmann::json;
+
+/**
+ * Microbenchmarks de los primitivos del códec PAC (lo que corre en cada ciclo de sondeo)
+ * - ns/op con calibración automática del número de iteraciones
+ * - allocs/op y bytes/op contando operator new de todo el proceso
+ * Se compila con SILENT_MODE: el costo de los DEBUG_INFO/LOG_DEBUG queda fuera de la medición
+ */
+
+// ============== CONTADOR DE ASIGNACIONES ==============
+
+static atomic<uint64_t> alloc_count{0};
+static atomic<uint64_t> alloc_bytes{0};
+
+void *operator new(size_t size)
+{
+    alloc_count.fetch_add(1, memory_order_relaxed);
+    alloc_bytes.fetch_add(size, memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+// Evita que el compilador elimine el resultado de la operación medida
+template <typename T>
+static inline void doNotOptimize(const T &value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// ============== PAYLOADS REALISTAS ==============
+
+// Trama de tabla sin cabecera: n floats little endian
+static vector<uint8_t> makeFloatPayload(size_t count)
+{
+    vector<uint8_t> payload;
+    for (size_t i = 0; i < count; i++)
+    {
+        float value = 20.0f + 1.25f * i;
+        uint32_t bits;
+        memcpy(&bits, &value, 4);
+        for (int b = 0; b < 4; b++)
+            payload.push_back((bits >> (8 * b)) & 0xFF);
+    }
+    return payload;
+}
+
+static vector<uint8_t> makeInt32Payload(size_t count)
+{
+    vector<uint8_t> payload;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t bits = (i % 2) ? 0x0201u : 0x1000u;   // Bits de alarma típicos
+        for (int b = 0; b < 4; b++)
+            payload.push_back((bits >> (8 * b)) & 0xFF);
+    }
+    return payload;
+}
+
+// Respuestas ASCII de "^VAR @@ F." tal como llegan del PAC (terminadas en 0x20)
+static const vector<string> ASCII_REPLIES = {
+    "1.234568e+03 ", "-4.500000E-02 ", "25.5 ", "0 ", "3.402823e+38 ", "-1.000000e-07 "};
+
+// ============== EJECUCIÓN ==============
+
+struct BenchResult {
+    string name;
+    uint64_t iterations = 0;
+    double ns_per_op = 0.0;
+    double allocs_per_op = 0.0;
+    double bytes_per_op = 0.0;
+};
+
+static BenchResult runBenchmark(const string &name, const function<void(uint64_t)> &body, double min_time_ms)
+{
+    using clock = chrono::steady_clock;
+
+    // Calibrar: duplicar iteraciones hasta superar el 10% del tiempo objetivo
+    uint64_t iterations = 1000;
+    double elapsed_ms = 0.0;
+    while (true)
+    {
+        auto start = clock::now();
+        body(iterations);
+        elapsed_ms = chrono::duration<double, milli>(clock::now() - start).count();
+        if (elapsed_ms >= min_time_ms / 10.0 || iterations >= (1ull << 32))
+            break;
+        iterations *= 2;
+    }
+    if (elapsed_ms > 0.0)
+        iterations = max<uint64_t>(iterations, (uint64_t)(iterations * (min_time_ms / elapsed_ms)));
+
+    uint64_t allocs_before = alloc_count.load();
+    uint64_t bytes_before = alloc_bytes.load();
+    auto start = clock::now();
+    body(iterations);
+    double elapsed_ns = chrono::duration<double, nano>(clock::now() - start).count();
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.ns_per_op = elapsed_ns / iterations;
+    result.allocs_per_op = (double)(alloc_count.load() - allocs_before) / iterations;
+    result.bytes_per_op = (double)(alloc_bytes.load() - bytes_before) / iterations;
+    return result;
+}
+
+static void printUsage(const char *prog)
+{
+    cout << "Uso: " << prog << " [opciones]\n"
+         << "  --filter TEXTO      Sólo los benchmarks cuyo nombre contiene TEXTO\n"
+         << "  --min-time-ms N     Tiempo mínimo de medición por benchmark (por defecto: 200)\n"
+         << "  --json FILE         Guardar resultados en JSON\n";
+}
+
+int main(int argc, char *argv[])
+{
+    string filter;
+    string json_file;
+    double min_time_ms = 200.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        auto next = [&]() -> const char * {
+            if (i + 1 >= argc)
+            {
+                printUsage(argv[0]);
+                exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--filter") filter = next();
+        else if (arg == "--min-time-ms") min_time_ms = atof(next());
+        else if (arg == "--json") json_file = next();
+        else
+        {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    const vector<uint8_t> table10 = makeFloatPayload(10);    // TBL_TT_/PT_/LT_/DT_ e API
+    const vector<uint8_t> table14 = makeFloatPayload(14);    // TBL_BATCH_
+    const vector<uint8_t> alarms10 = makeInt32Payload(10);   // TBL_TA_/DA_/PA_/LA_
+    const vector<uint8_t> table512 = makeFloatPayload(512);  // Históricos / recetas
+    vector<float> out512(512);
+    vector<uint8_t> flags512(512);
+    vector<vector<uint8_t>> replies;
+    for (const auto &reply : ASCII_REPLIES)
+        replies.emplace_back(reply.begin(), reply.end());
+
+    PACControlClient client("127.0.0.1");   // Sólo para los métodos de conversión (sin conectar)
+    const string table_name = "TBL_TT_11001";
+    const string scalar_name = "F_Corrent_Vol_Batch";
+
+    // Caché de tablas: 1000 tablas de 10 elementos, esquema anterior (map<string>) vs ids + bloque
+    struct LegacyCacheEntry {
+        vector<float> data;
+        chrono::steady_clock::time_point timestamp;
+        bool valid;
+    };
+    map<string, LegacyCacheEntry> legacy_cache;
+    TableRegistry registry;
+    vector<string> cached_names;
+    for (int t = 0; t < 1000; t++)
+    {
+        cached_names.push_back("TBL_TT_" + to_string(11000 + t));
+        registry.intern(cached_names.back(), 10);
+    }
+    TableCache slab;
+    slab.layout(registry);
+    vector<float> cached_values(10, 25.5f);
+    for (TableId id = 0; id < registry.count(); id++)
+    {
+        slab.putFloats(id, 0, cached_values, chrono::steady_clock::now());
+        legacy_cache[cached_names[id] + "_0_9"] = {cached_values, chrono::steady_clock::now(), true};
+    }
+
+    vector<pair<string, function<void(uint64_t)>>> benchmarks = {
+        // 📦 Decodificación binaria de tablas
+        {"decodeFloatsLE/10", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::decodeFloatsLE(table10));
+         }},
+        {"decodeFloatsLE/14", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::decodeFloatsLE(table14));
+         }},
+        {"decodeFloatsLE->span/10", [&](uint64_t n) {
+             float out[10];
+             for (uint64_t i = 0; i < n; i++) { pac_protocol::decodeFloatsLE(span<const uint8_t>(table10), span<float>(out)); doNotOptimize(out); }
+         }},
+        {"decodeFloatsLE->span/14", [&](uint64_t n) {
+             float out[14];
+             for (uint64_t i = 0; i < n; i++) { pac_protocol::decodeFloatsLE(span<const uint8_t>(table14), span<float>(out)); doNotOptimize(out); }
+         }},
+        {"convertBytesToFloats/10", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(client.convertBytesToFloats(table10));
+         }},
+        {"convertBytesToFloats/14", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(client.convertBytesToFloats(table14));
+         }},
+        {"decodeFloatsChecked/scalar/512", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::decodeFloatsChecked(table512, out512, {}, pac_protocol::DecodeKernel::SCALAR));
+         }},
+        {"decodeFloatsChecked/sse2/512", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::decodeFloatsChecked(table512, out512, {}, pac_protocol::DecodeKernel::SSE2));
+         }},
+        {"decodeFloatsChecked/avx2/512", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::decodeFloatsChecked(table512, out512, {}, pac_protocol::DecodeKernel::AVX2));
+         }},
+        {"decodeFloatsChecked/flags/512", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::decodeFloatsChecked(table512, out512, flags512));
+         }},
+        {"decodeFloatsLE->span/512", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) { pac_protocol::decodeFloatsLE(span<const uint8_t>(table512), span<float>(out512)); doNotOptimize(out512); }
+         }},
+        {"decodeInt32sLE/10", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::decodeInt32sLE(alarms10));
+         }},
+
+        // 🔤 Respuestas ASCII de variables individuales
+        {"bytesToASCII", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::bytesToASCII(replies[i % replies.size()]));
+         }},
+        {"cleanASCIINumber", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::cleanASCIINumber(ASCII_REPLIES[i % ASCII_REPLIES.size()]));
+         }},
+        {"parseFloat/scientific", [&](uint64_t n) {
+             static const string value = "1.234568e+03";
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::parseFloat(value));
+         }},
+        {"parseInt32", [&](uint64_t n) {
+             static const string value = "4609";
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::parseInt32(value));
+         }},
+        {"asciiReply->float", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++)
+             {
+                 string clean = pac_protocol::cleanASCIINumber(pac_protocol::bytesToASCII(replies[i % replies.size()]));
+                 doNotOptimize(pac_protocol::parseFloat(clean));
+             }
+         }},
+
+        // 📤 Construcción de comandos
+        {"buildTableReadCommand", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::buildTableReadCommand(table_name, 0, 9));
+         }},
+        {"appendTableReadCommand (buffer reutilizado)", [&](uint64_t n) {
+             string buffer;
+             for (uint64_t i = 0; i < n; i++) { buffer.clear(); pac_protocol::appendTableReadCommand(buffer, table_name, 0, 9); doNotOptimize(buffer); }
+         }},
+        {"stringstream TRange. (readFloatTable)", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++)
+             {
+                 stringstream cmd;
+                 cmd << 9 << " " << 0 << " }" << table_name << " TRange.\r";
+                 doNotOptimize(cmd.str());
+             }
+         }},
+        {"buildTableWriteCommand/float", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::buildTableWriteCommand(table_name, 3, 25.5f));
+         }},
+        {"buildTableWriteCommand/int32", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::buildTableWriteCommand(table_name, 3, (int32_t)4609));
+         }},
+        {"ostringstream TABLE! (writeFloatTableIndex v1)", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++)
+             {
+                 ostringstream cmd;
+                 cmd << fixed << setprecision(3) << 25.5f << " " << 3 << " }" << table_name << " TABLE!\r";
+                 doNotOptimize(cmd.str());
+             }
+         }},
+        {"buildScalarWriteCommand/float", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++) doNotOptimize(pac_protocol::buildScalarWriteCommand(scalar_name, 12.5f));
+         }},
+
+        // 💾 Caché de tablas (1000 tablas)
+        {"tableCache/map<string> (clave + copia)", [&](uint64_t n) {
+             for (uint64_t i = 0; i < n; i++)
+             {
+                 const string &table = cached_names[i % cached_names.size()];
+                 string key = table + "_" + to_string(0) + "_" + to_string(9);
+                 auto it = legacy_cache.find(key);
+                 if (it != legacy_cache.end() && it->second.valid)
+                     doNotOptimize(it->second.data);
+             }
+         }},
+        {"tableCache/find+getFloats", [&](uint64_t n) {
+             float out[10];
+             auto not_before = chrono::steady_clock::now() - chrono::milliseconds(5000);
+             for (uint64_t i = 0; i < n; i++)
+             {
+                 TableId id = registry.find(cached_names[i % cached_names.size()]);
+                 doNotOptimize(slab.getFloats(id, 0, 9, out, not_before));
+                 doNotOptimize(out);
+             }
+         }},
+        {"tableCache/getFloats (id)", [&](uint64_t n) {
+             float out[10];
+             auto not_before = chrono::steady_clock::now() - chrono::milliseconds(5000);
+             for (uint64_t i = 0; i < n; i++)
+             {
+                 doNotOptimize(slab.getFloats((TableId)(i % registry.count()), 0, 9, out, not_before));
+                 doNotOptimize(out);
+             }
+         }},
+    };
+
+    vector<BenchResult> results;
+    cout << "Kernel de decodificación activo: " << pac_protocol::decodeKernelName(pac_protocol::activeDecodeKernel()) << endl;
+    cout << left << setw(48) << "benchmark" << right << setw(14) << "iterations" << setw(12) << "ns/op"
+         << setw(12) << "allocs/op" << setw(12) << "bytes/op" << endl;
+
+    for (const auto &[name, body] : benchmarks)
+    {
+        if (!filter.empty() && name.find(filter) == string::npos)
+            continue;
+
+        BenchResult r = runBenchmark(name, body, min_time_ms);
+        cout << left << setw(48) << r.name << right << setw(14) << r.iterations
+             << fixed << setprecision(1) << setw(12) << r.ns_per_op
+             << setprecision(2) << setw(12) << r.allocs_per_op
+             << setprecision(1) << setw(12) << r.bytes_per_op << endl;
+        results.push_back(r);
+    }
+
+    if (!json_file.empty())
+    {
+        json out = json::array();
+        for (const auto &r : results)
+        {
+            out.push_back({{"name", r.name},
+                           {"iterations", r.iterations},
+                           {"ns_per_op", r.ns_per_op},
+                           {"allocs_per_op", r.allocs_per_op},
+                           {"bytes_per_op", r.bytes_per_op}});
+        }
+        ofstream file(json_file);
+        file << json({{"benchmark", "codec"}, {"min_time_ms", min_time_ms}, {"results", out}}).dump(2) << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,653 @@
+#include "opcua_server.h"
+#include "pac_connection_pool.h"
+#include "pac_simulator.h"
+#include "common.h"
+#include <open62541/client.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <open62541/client_subscriptions.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+using json = nlohmann::json;
+
+/**
+ * Benchmark de extremo a extremo: simulador PAC → gateway → cliente OPC-UA
+ * - Una escala por proceso hijo (globales del servidor limpios en cada corrida)
+ * - El simulador corre en su propio proceso (su CPU no se mezcla con la del gateway)
+ * - El cliente corre en el hilo principal: su CPU (RUSAGE_THREAD) se descuenta de la del
+ *   proceso, así gateway_cpu cuenta sólo los hilos del gateway
+ * - El cliente se suscribe a todos los nodos y mide la edad de los valores "Input",
+ *   que el simulador marca con los ms de CLOCK_MONOTONIC en el momento del TRange.
+ */
+
+struct BenchmarkOptions {
+    string tags_file = "tags.json";
+    vector<size_t> scales = {21, 1000, 10000};
+    int warmup_s = 3;
+    int duration_s = 10;
+    int update_ms = 0;              // 0 = el de tags.json
+    int sessions = 0;               // 0 = el de tags.json
+    int pipeline_depth = 0;         // 0 = el de tags.json
+    int opcua_port = 48400;         // Base: cada escala usa opcua_port + i
+    double publishing_ms = 100.0;
+    double sampling_ms = 100.0;
+    int write_interval_ms = 200;    // 0 = sin medir escrituras
+    PACSimulatorOptions simulator;
+    string output = "gateway_benchmark.json";
+};
+
+static chrono::steady_clock::time_point bench_epoch;
+
+static double sinceEpochMs()
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - bench_epoch).count();
+}
+
+// ============== RESUMEN DE MUESTRAS ==============
+
+static json summarize(vector<double> &samples)
+{
+    json out = {{"count", samples.size()}};
+    if (samples.empty())
+        return out;
+
+    sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) {
+        size_t idx = (size_t)(p * (samples.size() - 1) + 0.5);
+        return samples[min(idx, samples.size() - 1)];
+    };
+
+    out["mean"] = accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    out["min"] = samples.front();
+    out["p50"] = percentile(0.50);
+    out["p90"] = percentile(0.90);
+    out["p99"] = percentile(0.99);
+    out["max"] = samples.back();
+    return out;
+}
+
+static long readStatusKb(const char *field)
+{
+    ifstream status("/proc/self/status");
+    string line;
+    size_t len = strlen(field);
+    while (getline(status, line))
+    {
+        if (line.compare(0, len, field) == 0)
+            return strtol(line.c_str() + len + 1, nullptr, 10);
+    }
+    return -1;
+}
+
+// ============== TAGS SINTÉTICOS ==============
+
+// Replica tbL_tags hasta tag_count entradas con tablas propias ("_S<n>"); el resto se conserva
+static json makeSyntheticTags(const json &base, size_t tag_count)
+{
+    json tags = base;
+    const json &source = base.at("tbL_tags");
+    json synthetic = json::array();
+
+    for (size_t i = 0; i < tag_count && !source.empty(); i++)
+    {
+        json tag = source[i % source.size()];
+        size_t copy = i / source.size();
+        if (copy > 0)
+        {
+            string suffix = "_S" + to_string(copy);
+            tag["name"] = tag["name"].get<string>() + suffix;
+            tag["value_table"] = tag["value_table"].get<string>() + suffix;
+            if (tag.contains("alarm_table"))
+                tag["alarm_table"] = tag["alarm_table"].get<string>() + suffix;
+        }
+        synthetic.push_back(tag);
+    }
+
+    tags["tbL_tags"] = synthetic;
+    return tags;
+}
+
+// ============== ESTADO DE UNA CORRIDA ==============
+
+enum class ItemKind { VALUE, STAMP, WRITES_COMPLETED };
+
+struct ItemContext {
+    ItemKind kind = ItemKind::VALUE;
+};
+
+struct ScaleState {
+    atomic<bool> measuring{false};
+
+    // Hilo de actualización (observador de ciclo)
+    mutex cycle_mutex;
+    vector<double> cycle_ms;
+    vector<double> table_read_us;
+    uint64_t table_failures = 0;
+    size_t tables_per_cycle = 0;
+
+    // Hilo del cliente
+    vector<double> value_age_ms;
+    vector<double> write_rtt_ms;
+    uint64_t notifications = 0;
+    uint64_t writes_completed_seen = 0;
+    bool write_pending = false;
+    uint64_t write_expected = 0;
+    chrono::steady_clock::time_point write_sent;
+    uint64_t write_timeouts = 0;
+    uint64_t write_errors = 0;
+};
+
+static ScaleState *state = nullptr;
+
+static void onDataChange(UA_Client *client, UA_UInt32 subId, void *subContext,
+                         UA_UInt32 monId, void *monContext, UA_DataValue *value)
+{
+    if (!state || !monContext || !value || !value->hasValue)
+        return;
+
+    const ItemContext *item = static_cast<const ItemContext *>(monContext);
+
+    if (item->kind == ItemKind::WRITES_COMPLETED)
+    {
+        if (!UA_Variant_hasScalarType(&value->value, &UA_TYPES[UA_TYPES_UINT64]))
+            return;
+        state->writes_completed_seen = *(UA_UInt64 *)value->value.data;
+        if (state->write_pending && state->writes_completed_seen >= state->write_expected)
+        {
+            state->write_pending = false;
+            if (state->measuring)
+                state->write_rtt_ms.push_back(
+                    chrono::duration<double, milli>(chrono::steady_clock::now() - state->write_sent).count());
+        }
+        return;
+    }
+
+    if (!state->measuring)
+        return;
+
+    state->notifications++;
+
+    if (item->kind == ItemKind::STAMP && UA_Variant_hasScalarType(&value->value, &UA_TYPES[UA_TYPES_FLOAT]))
+    {
+        float stamp = *(UA_Float *)value->value.data;
+        state->value_age_ms.push_back(sinceEpochMs() - stamp);
+    }
+}
+
+// Crea los monitored items en bloques (una petición enorme supera los límites de mensaje)
+static size_t subscribeAll(UA_Client *client, UA_UInt32 subId, const vector<string> &nodeIds,
+                           vector<ItemContext> &contexts, double sampling_ms)
+{
+    const size_t CHUNK = 1000;
+    size_t created = 0;
+
+    for (size_t start = 0; start < nodeIds.size(); start += CHUNK)
+    {
+        size_t end = min(nodeIds.size(), start + CHUNK);
+        size_t count = end - start;
+
+        vector<UA_MonitoredItemCreateRequest> items(count);
+        vector<void *> itemContexts(count);
+        vector<UA_Client_DataChangeNotificationCallback> callbacks(count, onDataChange);
+        vector<UA_Client_DeleteMonitoredItemCallback> deleteCallbacks(count, nullptr);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            items[i] = UA_MonitoredItemCreateRequest_default(
+                UA_NODEID_STRING(1, const_cast<char *>(nodeIds[start + i].c_str())));
+            items[i].requestedParameters.samplingInterval = sampling_ms;
+            itemContexts[i] = &contexts[start + i];
+        }
+
+        UA_CreateMonitoredItemsRequest request;
+        memset(&request, 0, sizeof(request));
+        request.subscriptionId = subId;
+        request.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+        request.itemsToCreate = items.data();
+        request.itemsToCreateSize = count;
+
+        UA_CreateMonitoredItemsResponse response = UA_Client_MonitoredItems_createDataChanges(
+            client, request, itemContexts.data(), callbacks.data(), deleteCallbacks.data());
+
+        for (size_t i = 0; i < response.resultsSize; i++)
+        {
+            if (response.results[i].statusCode == UA_STATUSCODE_GOOD)
+                created++;
+        }
+        UA_CreateMonitoredItemsResponse_clear(&response);
+    }
+    return created;
+}
+
+// ============== SIMULADOR EN PROCESO PROPIO ==============
+
+// Devuelve el pid del simulador y su puerto (0 si no arrancó)
+static pid_t startSimulatorProcess(const PACSimulatorOptions &options, const json &tags, int &port)
+{
+    int fds[2];
+    port = 0;
+    if (pipe(fds) != 0)
+        return -1;
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fds[0]);
+        signal(SIGTERM, SIG_DFL);
+
+        PACSimulator simulator(options);
+        simulator.loadTags(tags);
+        int bound = simulator.start() ? simulator.port() : 0;
+        if (write(fds[1], &bound, sizeof(bound)) != sizeof(bound) || bound == 0)
+            _exit(1);
+        close(fds[1]);
+
+        // Hasta que el benchmark lo termine con SIGTERM
+        while (true)
+            pause();
+    }
+
+    close(fds[1]);
+    if (pid > 0 && read(fds[0], &port, sizeof(port)) != sizeof(port))
+        port = 0;
+    close(fds[0]);
+    return pid;
+}
+
+// ============== UNA ESCALA ==============
+
+static int runScale(const BenchmarkOptions &opts, const json &baseTags, size_t tagCount,
+                    int opcuaPort, const string &resultFile)
+{
+    bench_epoch = chrono::steady_clock::now();
+
+    json tags = makeSyntheticTags(baseTags, tagCount);
+
+    PACSimulatorOptions simOptions = opts.simulator;
+    simOptions.port = 0;
+    simOptions.timestamp_index = 0;           // "Input" de cada tabla de valores
+    simOptions.timestamp_epoch = bench_epoch;
+
+    int simPort = 0;
+    pid_t simPid = startSimulatorProcess(simOptions, tags, simPort);
+    if (simPid <= 0 || simPort == 0)
+    {
+        cerr << "❌ No se pudo iniciar el simulador PAC" << endl;
+        return 1;
+    }
+
+    // Configuración del gateway apuntando al simulador
+    tags["pac_config"]["ip"] = "127.0.0.1";
+    tags["pac_config"]["port"] = simPort;
+    if (opts.sessions > 0)
+        tags["pac_config"]["sessions"] = opts.sessions;
+    if (opts.pipeline_depth > 0)
+        tags["pac_config"]["pipeline_depth"] = opts.pipeline_depth;
+    tags["server_config"]["opcua_port"] = opcuaPort;
+    if (opts.update_ms > 0)
+        tags["server_config"]["update_interval_ms"] = opts.update_ms;
+
+    string configFile = resultFile + ".tags.json";
+    {
+        ofstream out(configFile);
+        out << tags.dump(2);
+    }
+
+    ScaleState scaleState;
+    state = &scaleState;
+
+    setPollCycleObserver([](const PollCycleResult &cycle, double cycle_ms) {
+        if (!state->measuring)
+            return;
+        lock_guard<mutex> lock(state->cycle_mutex);
+        state->cycle_ms.push_back(cycle_ms);
+        state->tables_per_cycle = max(state->tables_per_cycle, cycle.tables.size());
+        for (const auto &table : cycle.tables)
+        {
+            if (table.ok)
+                state->table_read_us.push_back(table.latency_us);
+            else
+                state->table_failures++;
+        }
+    });
+
+    json result = {{"tags", tagCount}};
+    int rc = 0;
+
+    if (!ServerInit(configFile))
+    {
+        cerr << "❌ ServerInit falló con " << tagCount << " tags" << endl;
+        kill(simPid, SIGTERM);
+        waitpid(simPid, nullptr, 0);
+        remove(configFile.c_str());
+        return 1;
+    }
+
+    thread serverThread(runServer);
+
+    // Nodos a monitorear: todas las variables del gateway + el contador de escrituras
+    vector<string> nodeIds;
+    vector<ItemContext> contexts;
+    const Variable *writeTarget = nullptr;
+    for (const auto &var : config.variables)
+    {
+        if (!var.has_node)
+            continue;
+        nodeIds.push_back(var.opcua_name);
+        ItemContext ctx;
+        if (var.var_name == "Input" && var.type == Variable::FLOAT && var.table_index == 0)
+            ctx.kind = ItemKind::STAMP;
+        contexts.push_back(ctx);
+
+        if (!writeTarget && var.writable && var.type == Variable::FLOAT && var.tag_name != "SimpleVars")
+            writeTarget = &var;
+    }
+    nodeIds.push_back("Gateway.WritesCompleted");
+    contexts.push_back(ItemContext{ItemKind::WRITES_COMPLETED});
+
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+
+    string endpoint = "opc.tcp://127.0.0.1:" + to_string(opcuaPort);
+    UA_StatusCode status = UA_STATUSCODE_BADINTERNALERROR;
+    for (int attempt = 0; attempt < 50 && status != UA_STATUSCODE_GOOD; attempt++)
+    {
+        status = UA_Client_connect(client, endpoint.c_str());
+        if (status != UA_STATUSCODE_GOOD)
+            this_thread::sleep_for(chrono::milliseconds(100));
+    }
+
+    size_t monitored = 0;
+    if (status == UA_STATUSCODE_GOOD)
+    {
+        UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
+        request.requestedPublishingInterval = opts.publishing_ms;
+        request.maxNotificationsPerPublish = 0;   // Sin límite
+        UA_CreateSubscriptionResponse response =
+            UA_Client_Subscriptions_create(client, request, nullptr, nullptr, nullptr);
+
+        if (response.responseHeader.serviceResult == UA_STATUSCODE_GOOD)
+            monitored = subscribeAll(client, response.subscriptionId, nodeIds, contexts, opts.sampling_ms);
+        else
+            status = response.responseHeader.serviceResult;
+    }
+
+    if (status != UA_STATUSCODE_GOOD || monitored == 0)
+    {
+        cerr << "❌ Cliente OPC-UA sin suscripción: " << UA_StatusCode_name(status) << endl;
+        result["error"] = string("client: ") + UA_StatusCode_name(status);
+        rc = 1;
+    }
+    else
+    {
+        cout << "📊 " << tagCount << " tags: " << config.variables.size() << " variables, "
+             << monitored << " monitored items, calentando " << opts.warmup_s << " s..." << endl;
+
+        auto phaseEnd = chrono::steady_clock::now() + chrono::seconds(opts.warmup_s);
+        while (chrono::steady_clock::now() < phaseEnd)
+            UA_Client_run_iterate(client, 20);
+
+        // 📏 VENTANA DE MEDICIÓN
+        struct rusage usageStart, usageEnd, clientStart, clientEnd;
+        getrusage(RUSAGE_SELF, &usageStart);
+        getrusage(RUSAGE_THREAD, &clientStart);
+        auto measureStart = chrono::steady_clock::now();
+        auto lastWrite = measureStart - chrono::milliseconds(opts.write_interval_ms);
+        uint64_t writesSent = 0;
+        scaleState.measuring = true;
+
+        phaseEnd = measureStart + chrono::seconds(opts.duration_s);
+        while (chrono::steady_clock::now() < phaseEnd)
+        {
+            UA_Client_run_iterate(client, 5);
+
+            auto now = chrono::steady_clock::now();
+            if (scaleState.write_pending && now - scaleState.write_sent > chrono::seconds(2))
+            {
+                scaleState.write_pending = false;
+                scaleState.write_timeouts++;
+            }
+
+            // ✍️ IDA Y VUELTA DE ESCRITURA: cliente → cola → PAC → Gateway.WritesCompleted
+            if (writeTarget && opts.write_interval_ms > 0 && !scaleState.write_pending &&
+                now - lastWrite >= chrono::milliseconds(opts.write_interval_ms))
+            {
+                UA_Float value = 100.0f + (float)(writesSent++ % 50);
+                UA_Variant variant;
+                UA_Variant_init(&variant);
+                UA_Variant_setScalar(&variant, &value, &UA_TYPES[UA_TYPES_FLOAT]);
+
+                scaleState.write_expected = scaleState.writes_completed_seen + 1;
+                scaleState.write_sent = chrono::steady_clock::now();
+                UA_StatusCode writeStatus = UA_Client_writeValueAttribute(
+                    client, UA_NODEID_STRING(1, const_cast<char *>(writeTarget->opcua_name.c_str())), &variant);
+                if (writeStatus == UA_STATUSCODE_GOOD)
+                    scaleState.write_pending = true;
+                else
+                    scaleState.write_errors++;
+                lastWrite = now;
+            }
+        }
+
+        scaleState.measuring = false;
+        double wall_s = chrono::duration<double>(chrono::steady_clock::now() - measureStart).count();
+        getrusage(RUSAGE_THREAD, &clientEnd);
+        getrusage(RUSAGE_SELF, &usageEnd);
+
+        // Proceso menos el hilo del cliente (decodificación y notificaciones de la suscripción)
+        auto seconds = [](const timeval &tv) { return tv.tv_sec + tv.tv_usec / 1e6; };
+        double client_user_s = seconds(clientEnd.ru_utime) - seconds(clientStart.ru_utime);
+        double client_sys_s = seconds(clientEnd.ru_stime) - seconds(clientStart.ru_stime);
+        double user_s = seconds(usageEnd.ru_utime) - seconds(usageStart.ru_utime) - client_user_s;
+        double sys_s = seconds(usageEnd.ru_stime) - seconds(usageStart.ru_stime) - client_sys_s;
+
+        lock_guard<mutex> lock(scaleState.cycle_mutex);
+        result["variables"] = config.variables.size();
+        result["monitored_items"] = monitored;
+        result["tables_per_cycle"] = scaleState.tables_per_cycle;
+        result["duration_s"] = wall_s;
+        result["poll_cycle_ms"] = summarize(scaleState.cycle_ms);
+        result["table_read_us"] = summarize(scaleState.table_read_us);
+        result["table_read_failures"] = scaleState.table_failures;
+        result["value_age_ms"] = summarize(scaleState.value_age_ms);
+        result["write_rtt_ms"] = summarize(scaleState.write_rtt_ms);
+        result["write_target"] = writeTarget ? writeTarget->opcua_name : "";
+        result["write_sent"] = writesSent;
+        result["write_timeouts"] = scaleState.write_timeouts;
+        result["write_errors"] = scaleState.write_errors;
+        result["notifications"] = scaleState.notifications;
+        result["notifications_per_s"] = scaleState.notifications / wall_s;
+        result["gateway_cpu"] = {{"user_s", user_s}, {"sys_s", sys_s},
+                                 {"percent", 100.0 * (user_s + sys_s) / wall_s}};
+        result["client_cpu"] = {{"user_s", client_user_s}, {"sys_s", client_sys_s},
+                                {"percent", 100.0 * (client_user_s + client_sys_s) / wall_s}};
+        result["gateway_rss_kb"] = readStatusKb("VmRSS:");
+        result["gateway_peak_rss_kb"] = readStatusKb("VmHWM:");
+    }
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+
+    requestServerStop();
+    if (serverThread.joinable())
+        serverThread.join();
+    shutdownServer();
+
+    // CPU del simulador: proceso completo (incluye arranque y calentamiento)
+    struct rusage simUsage;
+    memset(&simUsage, 0, sizeof(simUsage));
+    kill(simPid, SIGTERM);
+    wait4(simPid, nullptr, 0, &simUsage);
+    result["simulator_cpu_s"] = simUsage.ru_utime.tv_sec + simUsage.ru_utime.tv_usec / 1e6 +
+                                simUsage.ru_stime.tv_sec + simUsage.ru_stime.tv_usec / 1e6;
+
+    remove(configFile.c_str());
+    state = nullptr;
+
+    ofstream out(resultFile);
+    out << result.dump();
+    return rc;
+}
+
+// ============== CLI ==============
+
+static void printUsage(const char *prog)
+{
+    cout << "Uso: " << prog << " [opciones]\n"
+         << "  --tags FILE             tags.json base (por defecto: tags.json)\n"
+         << "  --scales A,B,C          Número de tags por corrida (por defecto: 21,1000,10000)\n"
+         << "  --warmup S              Segundos de calentamiento (por defecto: 3)\n"
+         << "  --duration S            Segundos de medición (por defecto: 10)\n"
+         << "  --update-ms N           update_interval_ms del gateway\n"
+         << "  --sessions N            Sesiones de lectura PAC\n"
+         << "  --pipeline N            Profundidad del pipeline TRange.\n"
+         << "  --opcua-port N          Puerto OPC-UA base (por defecto: 48400)\n"
+         << "  --publishing-ms X       Intervalo de publicación de la suscripción (por defecto: 100)\n"
+         << "  --sampling-ms X         Intervalo de muestreo de los items (por defecto: 100)\n"
+         << "  --write-interval-ms N   Pausa entre escrituras medidas (0 = sin escrituras)\n"
+         << "  --latency-us N          Simulador: retardo de red por ráfaga\n"
+         << "  --service-us N          Simulador: tiempo de proceso por comando\n"
+         << "  --jitter-us N           Simulador: ± aleatorio sobre los retardos\n"
+         << "  --churn X               Simulador: fracción de valores que cambia por segundo\n"
+         << "  --out FILE              Resultado JSON (por defecto: gateway_benchmark.json)\n";
+}
+
+static vector<size_t> parseScales(const string &text)
+{
+    vector<size_t> scales;
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ','))
+    {
+        size_t value = strtoul(item.c_str(), nullptr, 10);
+        if (value > 0)
+            scales.push_back(value);
+    }
+    return scales;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchmarkOptions opts;
+    opts.simulator.churn = 0.5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        auto next = [&]() -> const char * {
+            if (i + 1 >= argc)
+            {
+                printUsage(argv[0]);
+                exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--tags") opts.tags_file = next();
+        else if (arg == "--scales") opts.scales = parseScales(next());
+        else if (arg == "--warmup") opts.warmup_s = atoi(next());
+        else if (arg == "--duration") opts.duration_s = atoi(next());
+        else if (arg == "--update-ms") opts.update_ms = atoi(next());
+        else if (arg == "--sessions") opts.sessions = atoi(next());
+        else if (arg == "--pipeline") opts.pipeline_depth = atoi(next());
+        else if (arg == "--opcua-port") opts.opcua_port = atoi(next());
+        else if (arg == "--publishing-ms") opts.publishing_ms = atof(next());
+        else if (arg == "--sampling-ms") opts.sampling_ms = atof(next());
+        else if (arg == "--write-interval-ms") opts.write_interval_ms = atoi(next());
+        else if (arg == "--latency-us") opts.simulator.latency_us = atoi(next());
+        else if (arg == "--service-us") opts.simulator.service_us = atoi(next());
+        else if (arg == "--jitter-us") opts.simulator.jitter_us = atoi(next());
+        else if (arg == "--churn") opts.simulator.churn = atof(next());
+        else if (arg == "--out") opts.output = next();
+        else
+        {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    json baseTags;
+    try
+    {
+        ifstream file(opts.tags_file);
+        file >> baseTags;
+    }
+    catch (const exception &e)
+    {
+        cerr << "❌ Error leyendo " << opts.tags_file << ": " << e.what() << endl;
+        return 1;
+    }
+
+    json results = json::array();
+    for (size_t i = 0; i < opts.scales.size(); i++)
+    {
+        size_t tagCount = opts.scales[i];
+        string resultFile = "/tmp/gateway_benchmark_" + to_string(getpid()) + "_" + to_string(tagCount) + ".json";
+
+        cout.flush();
+        pid_t pid = fork();
+        if (pid == 0)
+            _exit(runScale(opts, baseTags, tagCount, opts.opcua_port + (int)i, resultFile));
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+
+        json result = {{"tags", tagCount}};
+        ifstream in(resultFile);
+        if (in.is_open())
+        {
+            try { in >> result; } catch (const exception &) {}
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            result["exit_status"] = status;
+        remove(resultFile.c_str());
+
+        if (result.contains("poll_cycle_ms") && result["poll_cycle_ms"].contains("p50"))
+        {
+            cout << "   ciclo p50/p99 " << result["poll_cycle_ms"]["p50"].get<double>() << "/"
+                 << result["poll_cycle_ms"]["p99"].get<double>() << " ms";
+            if (result["value_age_ms"].contains("p50"))
+                cout << ", edad p50/p99 " << result["value_age_ms"]["p50"].get<double>() << "/"
+                     << result["value_age_ms"]["p99"].get<double>() << " ms";
+            cout << ", CPU " << result["gateway_cpu"]["percent"].get<double>() << "%"
+                 << ", RSS " << result["gateway_rss_kb"].get<long>() << " kB" << endl;
+        }
+        results.push_back(result);
+    }
+
+    json report = {
+        {"benchmark", "gateway_e2e"},
+        {"options", {{"tags_file", opts.tags_file},
+                     {"warmup_s", opts.warmup_s},
+                     {"duration_s", opts.duration_s},
+                     {"update_ms", opts.update_ms},
+                     {"sessions", opts.sessions},
+                     {"pipeline_depth", opts.pipeline_depth},
+                     {"publishing_ms", opts.publishing_ms},
+                     {"sampling_ms", opts.sampling_ms},
+                     {"write_interval_ms", opts.write_interval_ms},
+                     {"simulator", {{"latency_us", opts.simulator.latency_us},
+                                    {"service_us", opts.simulator.service_us},
+                                    {"jitter_us", opts.simulator.jitter_us},
+                                    {"churn", opts.simulator.churn}}}}},
+        {"results", results}};
+
+    ofstream out(opts.output);
+    out << report.dump(2) << endl;
+    cout << "📄 Resultados en " << opts.output << endl;
+    return 0;
+}
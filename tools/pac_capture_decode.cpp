@@ -0,0 +1,231 @@
+#include "packet_capture.h"
+#include "pac_io_engine.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <ctime>
+#include <cstdlib>
+
+using namespace std;
+
+struct DecodeOptions {
+    uint64_t connection = 0;     // 0 = todas
+    size_t max_bytes = 256;      // Bytes mostrados por trama (0 = todos)
+    bool hex = false;            // Volcado hex también para tramas ASCII
+    bool summary = false;        // Sólo totales
+};
+
+static void printUsage(const char *prog)
+{
+    cout << "Uso: " << prog << " [opciones] CAPTURA\n"
+         << "  --conn N         Sólo la conexión N\n"
+         << "  --max-bytes N    Bytes mostrados por trama (por defecto: 256, 0 = todos)\n"
+         << "  --hex            Volcado hex también de los comandos ASCII\n"
+         << "  --summary        Sólo totales por conexión\n";
+}
+
+static const char *kindName(uint8_t kind)
+{
+    switch (kind)
+    {
+    case PacketRecordHeader::OPEN: return "OPEN";
+    case PacketRecordHeader::TX: return "TX";
+    case PacketRecordHeader::RX: return "RX";
+    case PacketRecordHeader::DISCARD: return "DISCARD";
+    case PacketRecordHeader::FAIL: return "FAIL";
+    case PacketRecordHeader::CLOSE: return "CLOSE";
+    default: return "?";
+    }
+}
+
+static const char *statusName(uint8_t status)
+{
+    switch (static_cast<IoStatus>(status))
+    {
+    case IoStatus::OK: return "OK";
+    case IoStatus::TIMEOUT: return "TIMEOUT";
+    case IoStatus::CLOSED: return "CLOSED";
+    case IoStatus::DESYNCED: return "DESYNCED";
+    case IoStatus::NOT_CONNECTED: return "NOT_CONNECTED";
+    }
+    return "?";
+}
+
+// "2026-01-31 12:34:56.123456" en hora local
+static string wallTime(int64_t wall_ns)
+{
+    time_t seconds = (time_t)(wall_ns / 1000000000);
+    tm local{};
+    localtime_r(&seconds, &local);
+
+    char text[32];
+    strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &local);
+    ostringstream out;
+    out << text << "." << setw(6) << setfill('0') << (wall_ns % 1000000000) / 1000;
+    return out.str();
+}
+
+static bool isText(span<const uint8_t> frame)
+{
+    for (uint8_t c : frame)
+    {
+        if ((c < 0x20 || c > 0x7e) && c != '\r' && c != '\n' && c != '\t')
+            return false;
+    }
+    return true;
+}
+
+static void printText(span<const uint8_t> frame)
+{
+    cout << "    \"";
+    for (uint8_t c : frame)
+    {
+        if (c == '\r') cout << "\\r";
+        else if (c == '\n') cout << "\\n";
+        else if (c == '\t') cout << "\\t";
+        else if (c == '"' || c == '\\') cout << '\\' << (char)c;
+        else cout << (char)c;
+    }
+    cout << "\"\n";
+}
+
+// 16 bytes por línea: desplazamiento, hex y ASCII
+static void printHex(span<const uint8_t> frame)
+{
+    for (size_t line = 0; line < frame.size(); line += 16)
+    {
+        cout << "    " << hex << setw(4) << setfill('0') << line << "  ";
+        for (size_t i = line; i < line + 16; i++)
+        {
+            if (i < frame.size())
+                cout << setw(2) << (int)frame[i] << ' ';
+            else
+                cout << "   ";
+            if (i == line + 7)
+                cout << ' ';
+        }
+        cout << dec << setfill(' ') << " |";
+        for (size_t i = line; i < line + 16 && i < frame.size(); i++)
+            cout << (frame[i] >= 0x20 && frame[i] <= 0x7e ? (char)frame[i] : '.');
+        cout << "|\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    DecodeOptions opts;
+    string path;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        auto next = [&]() -> const char * {
+            if (i + 1 >= argc)
+            {
+                printUsage(argv[0]);
+                exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--conn") opts.connection = strtoull(next(), nullptr, 10);
+        else if (arg == "--max-bytes") opts.max_bytes = strtoul(next(), nullptr, 10);
+        else if (arg == "--hex") opts.hex = true;
+        else if (arg == "--summary") opts.summary = true;
+        else if (arg == "--help" || arg == "-h" || !path.empty() || arg.starts_with("--"))
+        {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+        else path = arg;
+    }
+
+    if (path.empty())
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    struct ConnectionTotals {
+        string endpoint;
+        uint64_t tx_frames = 0, rx_frames = 0, tx_bytes = 0, rx_bytes = 0;
+        uint64_t discarded = 0, failed = 0;
+        int64_t last_mono_ns = 0;
+    };
+    unordered_map<uint64_t, ConnectionTotals> totals;
+    vector<uint64_t> order;
+    uint64_t shown = 0;
+
+    auto visit = [&](const PacketRecordHeader &record, span<const uint8_t> frame) {
+        if (opts.connection != 0 && record.connection != opts.connection)
+            return;
+
+        auto [it, inserted] = totals.try_emplace(record.connection);
+        ConnectionTotals &conn = it->second;
+        if (inserted)
+            order.push_back(record.connection);
+
+        switch (record.kind)
+        {
+        case PacketRecordHeader::OPEN: conn.endpoint.assign(frame.begin(), frame.end()); break;
+        case PacketRecordHeader::TX: conn.tx_frames++; conn.tx_bytes += frame.size(); break;
+        case PacketRecordHeader::RX: conn.rx_frames++; conn.rx_bytes += frame.size(); break;
+        case PacketRecordHeader::DISCARD: conn.discarded += frame.size(); break;
+        case PacketRecordHeader::FAIL: conn.failed += record.count; break;
+        default: break;
+        }
+
+        // Tiempo desde el registro anterior de la misma conexión (TX → RX = latencia del PAC)
+        double delta_ms = conn.last_mono_ns ? (record.mono_ns - conn.last_mono_ns) / 1e6 : 0.0;
+        conn.last_mono_ns = record.mono_ns;
+        shown++;
+        if (opts.summary)
+            return;
+
+        cout << wallTime(record.wall_ns) << "  +" << fixed << setprecision(3) << setw(9) << delta_ms << " ms  #"
+             << record.connection << " " << left << setw(7) << kindName(record.kind) << right;
+        if (record.kind == PacketRecordHeader::OPEN)
+            cout << " " << conn.endpoint << "\n";
+        else if (record.kind == PacketRecordHeader::FAIL)
+            cout << " " << statusName(record.status) << " (" << record.count << " solicitudes)\n";
+        else if (record.kind == PacketRecordHeader::CLOSE)
+            cout << " " << statusName(record.status) << "\n";
+        else
+            cout << " " << frame.size() << " B\n";
+
+        if (record.kind == PacketRecordHeader::OPEN || frame.empty())
+            return;
+
+        span<const uint8_t> visible = opts.max_bytes ? frame.first(min(frame.size(), opts.max_bytes)) : frame;
+        if (!opts.hex && isText(visible))
+            printText(visible);
+        else
+            printHex(visible);
+        if (visible.size() < frame.size())
+            cout << "    ... " << frame.size() - visible.size() << " bytes más\n";
+    };
+
+    PacketCaptureHeader header{};
+    string error;
+    bool ok = PacketCapture::read(path, visit, header, error);
+
+    cout << "\n📼 " << path << ": " << shown << " registros mostrados, " << header.records << " escritos, "
+         << header.overwritten << " pisados (anillo de " << header.capacity / 1024 << " KB)\n";
+    for (uint64_t id : order)
+    {
+        const ConnectionTotals &conn = totals[id];
+        cout << "  #" << id << " " << (conn.endpoint.empty() ? "(apertura fuera del anillo)" : conn.endpoint)
+             << ": TX " << conn.tx_frames << " (" << conn.tx_bytes << " B), RX " << conn.rx_frames << " ("
+             << conn.rx_bytes << " B), descartados " << conn.discarded << " B, abortadas " << conn.failed << "\n";
+    }
+
+    if (!ok)
+    {
+        cerr << "❌ " << path << ": " << error << endl;
+        return 1;
+    }
+    return 0;
+}
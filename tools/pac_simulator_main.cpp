@@ -0,0 +1,107 @@
+#include "pac_simulator.h"
+#include "common.h"
+#include <fstream>
+#include <csignal>
+#include <cstdlib>
+#include <thread>
+#include <chrono>
+
+using namespace std;
+
+static atomic<bool> stop_requested{false};
+
+static void signalHandler(int)
+{
+    stop_requested = true;
+}
+
+static void printUsage(const char *prog)
+{
+    cout << "Uso: " << prog << " [opciones]\n"
+         << "  --tags FILE             tags.json a servir (por defecto: tags.json)\n"
+         << "  --bind ADDR             Dirección de escucha (por defecto: 127.0.0.1)\n"
+         << "  --port N                Puerto (por defecto: 22001)\n"
+         << "  --latency-us N          Retardo de red por ráfaga\n"
+         << "  --service-us N          Tiempo de proceso por comando\n"
+         << "  --jitter-us N           ± aleatorio sobre los retardos\n"
+         << "  --fragment N            Enviar respuestas en trozos de N bytes\n"
+         << "  --fragment-delay-us N   Pausa entre trozos\n"
+         << "  --churn X               Fracción de valores que cambia por segundo (0..1)\n"
+         << "  --table-size N          Elementos por tabla (por defecto: 16)\n"
+         << "  --seed N                Semilla de valores y jitter\n";
+}
+
+int main(int argc, char *argv[])
+{
+    PACSimulatorOptions opts;
+    string tags_file = "tags.json";
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        auto next = [&]() -> const char * {
+            if (i + 1 >= argc)
+            {
+                printUsage(argv[0]);
+                exit(1);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--tags") tags_file = next();
+        else if (arg == "--bind") opts.bind_address = next();
+        else if (arg == "--port") opts.port = atoi(next());
+        else if (arg == "--latency-us") opts.latency_us = atoi(next());
+        else if (arg == "--service-us") opts.service_us = atoi(next());
+        else if (arg == "--jitter-us") opts.jitter_us = atoi(next());
+        else if (arg == "--fragment") opts.fragment_bytes = strtoul(next(), nullptr, 10);
+        else if (arg == "--fragment-delay-us") opts.fragment_delay_us = atoi(next());
+        else if (arg == "--churn") opts.churn = atof(next());
+        else if (arg == "--table-size") opts.default_table_size = strtoul(next(), nullptr, 10);
+        else if (arg == "--seed") opts.seed = strtoul(next(), nullptr, 10);
+        else
+        {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    PACSimulator simulator(opts);
+
+    ifstream file(tags_file);
+    if (file.is_open())
+    {
+        try
+        {
+            nlohmann::json tags;
+            file >> tags;
+            simulator.loadTags(tags);
+        }
+        catch (const exception &e)
+        {
+            LOG_ERROR("Error leyendo " << tags_file << ": " << e.what());
+            return 1;
+        }
+    }
+    else
+    {
+        LOG_WARNING("No se encontró " << tags_file << ": las tablas se crearán bajo demanda");
+    }
+
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+
+    if (!simulator.start())
+        return 1;
+
+    while (!stop_requested)
+        this_thread::sleep_for(chrono::milliseconds(200));
+
+    simulator.stop();
+
+    const PACSimulatorStats &stats = simulator.getStats();
+    LOG_INFO("🧪 Conexiones: " << stats.connections << ", lecturas de tabla: " << stats.table_reads
+             << ", lecturas escalares: " << stats.scalar_reads << ", escrituras: " << stats.writes
+             << ", comandos desconocidos: " << stats.unknown_commands);
+    return 0;
+}